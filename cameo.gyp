@@ -56,31 +56,83 @@
       'sources': [
         'src/runtime/app/cameo_main_delegate.cc',
         'src/runtime/app/cameo_main_delegate.h',
+        'src/runtime/browser/app_protocol_handler.cc',
+        'src/runtime/browser/app_protocol_handler.h',
+        'src/runtime/browser/background_throttler.cc',
+        'src/runtime/browser/background_throttler.h',
         'src/runtime/browser/cameo_browser_main_parts.cc',
         'src/runtime/browser/cameo_browser_main_parts.h',
         'src/runtime/browser/cameo_content_browser_client.cc',
         'src/runtime/browser/cameo_content_browser_client.h',
+        'src/runtime/browser/frame_capturer.cc',
+        'src/runtime/browser/frame_capturer.h',
+        'src/runtime/browser/http_cache_snapshot.cc',
+        'src/runtime/browser/http_cache_snapshot.h',
+        'src/runtime/browser/load_predictor.cc',
+        'src/runtime/browser/load_predictor.h',
+        'src/runtime/browser/media_url_request_context_getter.cc',
+        'src/runtime/browser/media_url_request_context_getter.h',
+        'src/runtime/browser/memory_pressure_coordinator.cc',
+        'src/runtime/browser/memory_pressure_coordinator.h',
+        'src/runtime/browser/network_archive.cc',
+        'src/runtime/browser/network_archive.h',
+        'src/runtime/browser/network_emulator.cc',
+        'src/runtime/browser/network_emulator.h',
+        'src/runtime/browser/network_recorder.cc',
+        'src/runtime/browser/network_recorder.h',
+        'src/runtime/browser/network_state_store.cc',
+        'src/runtime/browser/network_state_store.h',
+        'src/runtime/browser/network_timing_recorder.cc',
+        'src/runtime/browser/network_timing_recorder.h',
+        'src/runtime/browser/persistent_server_bound_cert_store.cc',
+        'src/runtime/browser/persistent_server_bound_cert_store.h',
+        'src/runtime/browser/process_singleton.h',
+        'src/runtime/browser/process_singleton_linux.cc',
+        'src/runtime/browser/replay_protocol_handler.cc',
+        'src/runtime/browser/replay_protocol_handler.h',
+        'src/runtime/browser/request_scheduler.cc',
+        'src/runtime/browser/request_scheduler.h',
         'src/runtime/browser/runtime_context.cc',
         'src/runtime/browser/runtime_context.h',
+        'src/runtime/browser/runtime_index.cc',
+        'src/runtime/browser/runtime_index.h',
         'src/runtime/browser/runtime_registry.cc',
         'src/runtime/browser/runtime_registry.h',
+        'src/runtime/browser/runtime_resource_monitor.cc',
+        'src/runtime/browser/runtime_resource_monitor.h',
         'src/runtime/browser/ui/native_app_window.h',
         'src/runtime/browser/ui/native_app_window_win.cc',
         'src/runtime/browser/ui/native_app_window_win.h',
         'src/runtime/browser/ui/native_app_window_gtk.cc',
         'src/runtime/browser/ui/native_app_window_gtk.h',
+        'src/runtime/browser/ui/native_app_window_headless.cc',
+        'src/runtime/browser/ui/native_app_window_headless.h',
         'src/runtime/browser/runtime.cc',
         'src/runtime/browser/runtime.h',
         'src/runtime/browser/runtime_network_delegate.cc',
         'src/runtime/browser/runtime_network_delegate.h',
         'src/runtime/browser/runtime_url_request_context_getter.cc',
         'src/runtime/browser/runtime_url_request_context_getter.h',
+        'src/runtime/browser/sdch_dictionary_fetcher.cc',
+        'src/runtime/browser/sdch_dictionary_fetcher.h',
+        'src/runtime/browser/startup_predictor.cc',
+        'src/runtime/browser/startup_predictor.h',
+        'src/runtime/browser/startup_tracer.cc',
+        'src/runtime/browser/startup_tracer.h',
+        'src/runtime/browser/tiered_http_cache.cc',
+        'src/runtime/browser/tiered_http_cache.h',
+        'src/runtime/common/app_package.cc',
+        'src/runtime/common/app_package.h',
+        'src/runtime/common/cameo_constants.cc',
+        'src/runtime/common/cameo_constants.h',
         'src/runtime/common/cameo_content_client.cc',
         'src/runtime/common/cameo_content_client.h',
         'src/runtime/common/cameo_paths.cc',
         'src/runtime/common/cameo_paths.h',
         'src/runtime/common/cameo_switches.cc',
         'src/runtime/common/cameo_switches.h',
+        'src/runtime/common/frame_ring.cc',
+        'src/runtime/common/frame_ring.h',
         'src/runtime/renderer/cameo_content_renderer_client.cc',
         'src/runtime/renderer/cameo_content_renderer_client.h',
       ],
@@ -262,12 +314,66 @@
         }],  # toolkit_uses_gtk==1
       ],
     },
+    {
+      # Builds the snapshots of --http-cache-snapshot.
+      'target_name': 'cameo_cache_snapshot_builder',
+      'type': 'executable',
+      'defines!': ['CONTENT_IMPLEMENTATION'],
+      'dependencies': [
+        'cameo_runtime',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'src/tools/cameo_cache_snapshot_builder.cc',
+      ],
+    },
+    {
+      # Reference consumer of --frame-capture-ring.
+      'target_name': 'cameo_frame_consumer',
+      'type': 'executable',
+      'dependencies': [
+        '../base/base.gyp:base',
+        '../skia/skia.gyp:skia',
+        '../ui/ui.gyp:ui',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'src/runtime/common/frame_ring.cc',
+        'src/runtime/common/frame_ring.h',
+        'src/tools/cameo_frame_consumer.cc',
+      ],
+    },
+    {
+      'target_name': 'cameo_package_builder',
+      'type': 'executable',
+      'dependencies': [
+        '../base/base.gyp:base',
+        '../net/net.gyp:net',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'src/runtime/common/app_package.cc',
+        'src/runtime/common/app_package.h',
+        'src/runtime/common/cameo_constants.cc',
+        'src/runtime/common/cameo_constants.h',
+        'src/tools/cameo_package_builder.cc',
+      ],
+    },
     {
       'target_name': 'cameo_builder',
       'type': 'none',
       'dependencies': [
         'cameo',
         'cameo_browsertest',
+        'cameo_cache_snapshot_builder',
+        'cameo_frame_consumer',
+        'cameo_package_builder',
         'cameo_unittest',
       ],
     },
@@ -4,13 +4,17 @@
 
 #include "cameo/src/runtime/app/cameo_main_delegate.h"
 
+#include "base/command_line.h"
+#include "base/debug/trace_event.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/path_service.h"
 #include "cameo/src/runtime/browser/cameo_content_browser_client.h"
+#include "cameo/src/runtime/browser/startup_tracer.h"
 #include "cameo/src/runtime/common/cameo_paths.h"
 #include "cameo/src/runtime/renderer/cameo_content_renderer_client.h"
 #include "content/public/browser/browser_main_runner.h"
+#include "content/public/common/content_switches.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/base/ui_base_paths.h"
 
@@ -21,17 +25,25 @@ CameoMainDelegate::CameoMainDelegate()
 }
 
 CameoMainDelegate::~CameoMainDelegate() {
+  startup_tracer_.reset();
   browser_client_.reset();
   renderer_client_.reset();
   content_client_.reset();
 }
 
 bool CameoMainDelegate::BasicStartupComplete(int* exit_code) {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  // Only the browser process records the startup timeline.
+  if (!command_line.HasSwitch(switches::kProcessType))
+    startup_tracer_ = StartupTracer::CreateIfEnabled(command_line);
+
+  TRACE_EVENT0("cameo.startup", "CameoMainDelegate::BasicStartupComplete");
   SetContentClient(content_client_.get());
   return false;
 }
 
 void CameoMainDelegate::PreSandboxStartup() {
+  TRACE_EVENT0("cameo.startup", "CameoMainDelegate::PreSandboxStartup");
   RegisterPathProvider();
   InitializeResourceBundle();
 }
@@ -44,6 +56,7 @@ int CameoMainDelegate::RunProcess(const std::string& process_type,
 
 // static
 void CameoMainDelegate::InitializeResourceBundle() {
+  TRACE_EVENT0("cameo.startup", "CameoMainDelegate::InitializeResourceBundle");
   base::FilePath pak_file, pak_dir;
   PathService::Get(base::DIR_MODULE, &pak_dir);
   DCHECK(!pak_dir.empty());
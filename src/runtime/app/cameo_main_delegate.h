@@ -20,6 +20,8 @@ class ContentClient;
 
 namespace cameo {
 
+class StartupTracer;
+
 class CameoMainDelegate : public content::ContentMainDelegate {
  public:
   CameoMainDelegate();
@@ -40,6 +42,7 @@ class CameoMainDelegate : public content::ContentMainDelegate {
   scoped_ptr<content::ContentBrowserClient> browser_client_;
   scoped_ptr<content::ContentRendererClient> renderer_client_;
   scoped_ptr<content::ContentClient> content_client_;
+  scoped_ptr<StartupTracer> startup_tracer_;
 
   DISALLOW_COPY_AND_ASSIGN(CameoMainDelegate);
 };
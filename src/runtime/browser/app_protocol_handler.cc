@@ -0,0 +1,124 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/app_protocol_handler.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop.h"
+#include "cameo/src/runtime/common/app_package.h"
+#include "cameo/src/runtime/common/cameo_constants.h"
+#include "net/base/escape.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_error_job.h"
+#include "net/url_request/url_request_job.h"
+#include "net/url_request/url_request_status.h"
+
+namespace cameo {
+
+namespace {
+
+const char kDefaultResource[] = "index.html";
+
+// Reads one resource of an AppPackage. The package is kept alive by the job,
+// so the data it points to stays mapped as long as the request needs it.
+class AppPackageJob : public net::URLRequestJob {
+ public:
+  AppPackageJob(net::URLRequest* request,
+                net::NetworkDelegate* network_delegate,
+                AppPackage* package,
+                const std::string& path)
+      : net::URLRequestJob(request, network_delegate),
+        package_(package),
+        path_(path),
+        read_offset_(0),
+        weak_factory_(this) {
+  }
+
+  // URLRequestJob implementation.
+  virtual void Start() OVERRIDE {
+    // Headers can't be reported from within Start().
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&AppPackageJob::StartAsync, weak_factory_.GetWeakPtr()));
+  }
+
+  virtual void Kill() OVERRIDE {
+    weak_factory_.InvalidateWeakPtrs();
+    net::URLRequestJob::Kill();
+  }
+
+  virtual bool ReadRawData(net::IOBuffer* buf,
+                           int buf_size,
+                           int* bytes_read) OVERRIDE {
+    size_t remaining = resource_.data.size() - read_offset_;
+    size_t count = std::min(remaining, static_cast<size_t>(buf_size));
+    memcpy(buf->data(), resource_.data.data() + read_offset_, count);
+    read_offset_ += count;
+    *bytes_read = static_cast<int>(count);
+    return true;
+  }
+
+  virtual bool GetMimeType(std::string* mime_type) const OVERRIDE {
+    resource_.mime_type.CopyToString(mime_type);
+    return !mime_type->empty();
+  }
+
+ private:
+  virtual ~AppPackageJob() {}
+
+  void StartAsync() {
+    if (!package_->Find(path_, &resource_)) {
+      NotifyStartError(net::URLRequestStatus(net::URLRequestStatus::FAILED,
+                                             net::ERR_FILE_NOT_FOUND));
+      return;
+    }
+    set_expected_content_size(resource_.data.size());
+    NotifyHeadersComplete();
+  }
+
+  scoped_refptr<AppPackage> package_;
+  const std::string path_;
+  AppPackage::Resource resource_;
+  size_t read_offset_;
+  base::WeakPtrFactory<AppPackageJob> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(AppPackageJob);
+};
+
+}  // namespace
+
+AppProtocolHandler::AppProtocolHandler(AppPackage* package)
+    : package_(package) {
+}
+
+AppProtocolHandler::~AppProtocolHandler() {
+}
+
+net::URLRequestJob* AppProtocolHandler::MaybeCreateJob(
+    net::URLRequest* request,
+    net::NetworkDelegate* network_delegate) const {
+  const GURL& url = request->url();
+  if (url.host() != kAppPackageHost) {
+    return new net::URLRequestErrorJob(request, network_delegate,
+                                       net::ERR_INVALID_URL);
+  }
+
+  // Drop the leading slash, the package paths are relative to its root.
+  std::string path = net::UnescapeURLComponent(
+      url.path().substr(1),
+      net::UnescapeRule::SPACES | net::UnescapeRule::URL_SPECIAL_CHARS);
+  if (path.empty() || path[path.size() - 1] == '/')
+    path += kDefaultResource;
+  return new AppPackageJob(request, network_delegate, package_.get(), path);
+}
+
+}  // namespace cameo
@@ -0,0 +1,38 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_APP_PROTOCOL_HANDLER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_APP_PROTOCOL_HANDLER_H_
+
+#include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "net/url_request/url_request_job_factory.h"
+
+namespace cameo {
+
+class AppPackage;
+
+// Serves app://package/<path> from the resources of |package|. Nothing hits
+// the disk on the way: the lookup is done in the index of the mapped package
+// and the data is read straight out of the mapping.
+class AppProtocolHandler
+    : public net::URLRequestJobFactory::ProtocolHandler {
+ public:
+  explicit AppProtocolHandler(AppPackage* package);
+  virtual ~AppProtocolHandler();
+
+  // ProtocolHandler implementation.
+  virtual net::URLRequestJob* MaybeCreateJob(
+      net::URLRequest* request,
+      net::NetworkDelegate* network_delegate) const OVERRIDE;
+
+ private:
+  scoped_refptr<AppPackage> package_;
+
+  DISALLOW_COPY_AND_ASSIGN(AppProtocolHandler);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_APP_PROTOCOL_HANDLER_H_
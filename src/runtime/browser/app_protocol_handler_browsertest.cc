@@ -0,0 +1,113 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/common/app_package.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/web_contents.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/net_util.h"
+
+using cameo::AppPackage;
+
+namespace {
+
+// The generated app: an index.html pulling in kScriptCount scripts of about
+// kScriptSize bytes each, loaded kRounds times from each source.
+const int kScriptCount = 200;
+const size_t kScriptSize = 4096;
+const int kRounds = 5;
+
+const char kIndexHtml[] =
+    "<html><head><script>\n"
+    "var loaded = 0;\n"
+    "for (var i = 0; i < %d; ++i) {\n"
+    "  document.write('<script src=\"js/' + i + '.js' + location.search +\n"
+    "                 '\"><\\/script>');\n"
+    "}\n"
+    "</script></head>\n"
+    "<body onload=\"document.title = 'loaded ' + loaded;\"></body></html>\n";
+
+bool WriteString(const base::FilePath& path, const std::string& data) {
+  int size = static_cast<int>(data.size());
+  return file_util::WriteFile(path, data.data(), size) == size;
+}
+
+}  // namespace
+
+class AppProtocolHandlerTest : public InProcessBrowserTest {
+ public:
+  // The package has to be known before the browser starts, as it is given
+  // on the command line.
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    app_dir_ = temp_dir_.path().AppendASCII("app");
+    base::FilePath script_dir = app_dir_.AppendASCII("js");
+    ASSERT_TRUE(file_util::CreateDirectory(script_dir));
+    ASSERT_TRUE(WriteString(app_dir_.AppendASCII("index.html"),
+                            base::StringPrintf(kIndexHtml, kScriptCount)));
+    for (int i = 0; i < kScriptCount; ++i) {
+      std::string script = "++loaded;\n";
+      script.resize(kScriptSize, ' ');
+      ASSERT_TRUE(WriteString(
+          script_dir.AppendASCII(base::StringPrintf("%d.js", i)), script));
+    }
+
+    base::FilePath package_path = temp_dir_.path().AppendASCII("app.capk");
+    ASSERT_TRUE(AppPackage::Build(app_dir_, package_path));
+    command_line->AppendArgPath(package_path);
+  }
+
+  // Loads the app from |base_url| kRounds times and returns the mean time
+  // of a load. The query makes WebKit fetch the scripts again every round.
+  double MeasureLoadTime(const std::string& base_url) {
+    base::TimeDelta total;
+    for (int round = 0; round < kRounds; ++round) {
+      GURL url(base_url + base::StringPrintf("?round=%d", round));
+      base::TimeTicks start = base::TimeTicks::Now();
+      cameo_test_utils::NavigateToURL(runtime(), url);
+      total += base::TimeTicks::Now() - start;
+      EXPECT_EQ(ASCIIToUTF16(base::StringPrintf("loaded %d", kScriptCount)),
+                runtime()->web_contents()->GetTitle());
+    }
+    return total.InMillisecondsF() / kRounds;
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath app_dir_;
+};
+
+IN_PROC_BROWSER_TEST_F(AppProtocolHandlerTest, ServesPackage) {
+  // The package is the startup app, and its index.html the default resource.
+  string16 loaded_title =
+      ASCIIToUTF16(base::StringPrintf("loaded %d", kScriptCount));
+  EXPECT_EQ(GURL("app://package/"), runtime()->web_contents()->GetURL());
+  EXPECT_EQ(loaded_title, runtime()->web_contents()->GetTitle());
+
+  cameo_test_utils::NavigateToURL(runtime(),
+                                  GURL("app://package/missing.html"));
+  EXPECT_NE(loaded_title, runtime()->web_contents()->GetTitle());
+}
+
+IN_PROC_BROWSER_TEST_F(AppProtocolHandlerTest, LoadBenchmark) {
+  double directory_time = MeasureLoadTime(
+      net::FilePathToFileURL(app_dir_.AppendASCII("index.html")).spec());
+  double package_time = MeasureLoadTime("app://package/index.html");
+
+  std::string trace = base::StringPrintf("%d_scripts", kScriptCount);
+  cameo_test_utils::PrintPerfResult("app_load_directory", trace,
+                                    directory_time, "ms");
+  cameo_test_utils::PrintPerfResult("app_load_package", trace,
+                                    package_time, "ms");
+}
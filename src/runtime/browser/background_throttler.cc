@@ -0,0 +1,107 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/background_throttler.h"
+
+#include "base/command_line.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/render_view_host.h"
+#include "content/public/browser/web_contents.h"
+
+namespace cameo {
+
+namespace {
+
+// Pauses the media elements which are playing, and marks them so that only
+// those are resumed. The page may pause or remove them in the meantime.
+const char kPauseMediaScript[] =
+    "(function() {"
+    "  var media = document.querySelectorAll('audio, video');"
+    "  for (var i = 0; i < media.length; ++i) {"
+    "    if (!media[i].paused) {"
+    "      media[i].__cameoPausedInBackground = true;"
+    "      media[i].pause();"
+    "    }"
+    "  }"
+    "})();";
+
+const char kResumeMediaScript[] =
+    "(function() {"
+    "  var media = document.querySelectorAll('audio, video');"
+    "  for (var i = 0; i < media.length; ++i) {"
+    "    if (media[i].__cameoPausedInBackground) {"
+    "      delete media[i].__cameoPausedInBackground;"
+    "      media[i].play();"
+    "    }"
+    "  }"
+    "})();";
+
+}  // namespace
+
+BackgroundThrottler::Config::Config()
+    : throttle_inactive(false),
+      pause_media(false) {
+}
+
+// static
+BackgroundThrottler::Config BackgroundThrottler::Config::FromCommandLine(
+    const CommandLine& command_line) {
+  Config config;
+  config.throttle_inactive =
+      command_line.HasSwitch(switches::kThrottleInactiveWindows);
+  config.pause_media = command_line.HasSwitch(switches::kPauseBackgroundMedia);
+  return config;
+}
+
+BackgroundThrottler::BackgroundThrottler(content::WebContents* web_contents,
+                                         const Config& config)
+    : web_contents_(web_contents),
+      config_(config),
+      is_throttled_(false) {
+}
+
+BackgroundThrottler::~BackgroundThrottler() {
+}
+
+void BackgroundThrottler::Update(bool visible, bool active) {
+  bool throttle = !visible || (config_.throttle_inactive && !active);
+  if (throttle == is_throttled_)
+    return;
+
+  is_throttled_ = throttle;
+  if (throttle)
+    Throttle();
+  else
+    Unthrottle();
+}
+
+void BackgroundThrottler::SetWebContents(content::WebContents* web_contents) {
+  web_contents_ = web_contents;
+  // Nothing plays in the new contents yet, only hide them.
+  if (is_throttled_)
+    web_contents_->WasHidden();
+}
+
+void BackgroundThrottler::Throttle() {
+  content::RenderViewHost* render_view_host =
+      web_contents_->GetRenderViewHost();
+  if (config_.pause_media && render_view_host) {
+    render_view_host->ExecuteJavascriptInWebFrame(
+        string16(), ASCIIToUTF16(kPauseMediaScript));
+  }
+  web_contents_->WasHidden();
+}
+
+void BackgroundThrottler::Unthrottle() {
+  web_contents_->WasShown();
+  content::RenderViewHost* render_view_host =
+      web_contents_->GetRenderViewHost();
+  if (config_.pause_media && render_view_host) {
+    render_view_host->ExecuteJavascriptInWebFrame(
+        string16(), ASCIIToUTF16(kResumeMediaScript));
+  }
+}
+
+}  // namespace cameo
@@ -0,0 +1,72 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_BACKGROUND_THROTTLER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_BACKGROUND_THROTTLER_H_
+
+#include "base/basictypes.h"
+
+class CommandLine;
+
+namespace content {
+class WebContents;
+}
+
+namespace cameo {
+
+// BackgroundThrottler puts the WebContents of a Runtime in the background
+// while nobody can see its window, and brings it back when the window shows
+// up again.
+//
+// Throttled contents are marked hidden: the renderer stops painting and
+// running requestAnimationFrame callbacks, aligns the JS timers of the page
+// to its background timer interval, and lowers the priority of the render
+// process once all its views are hidden. Playing media is optionally paused
+// as well, and resumed along with the contents.
+class BackgroundThrottler {
+ public:
+  struct Config {
+    Config();
+
+    // Reads switches::kThrottleInactiveWindows and
+    // switches::kPauseBackgroundMedia.
+    static Config FromCommandLine(const CommandLine& command_line);
+
+    // Whether a window that is shown but not active is throttled too, for
+    // hosts whose windows cover each other.
+    bool throttle_inactive;
+    // Whether the playing media elements of the main frame are paused.
+    bool pause_media;
+  };
+
+  // |web_contents| must outlive the throttler. The contents are assumed to
+  // be shown.
+  BackgroundThrottler(content::WebContents* web_contents,
+                      const Config& config);
+  ~BackgroundThrottler();
+
+  // Called whenever the state of the window changes, throttles or restores
+  // the contents as needed.
+  void Update(bool visible, bool active);
+
+  // Moves to |web_contents|, which replaced the one throttled until now, see
+  // Runtime::Hibernate(). It is hidden if the throttler is throttled.
+  void SetWebContents(content::WebContents* web_contents);
+
+  bool is_throttled() const { return is_throttled_; }
+
+ private:
+  void Throttle();
+  void Unthrottle();
+
+  content::WebContents* web_contents_;
+  Config config_;
+  bool is_throttled_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundThrottler);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_BACKGROUND_THROTTLER_H_
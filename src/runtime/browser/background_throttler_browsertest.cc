@@ -0,0 +1,87 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/memory/linked_ptr.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/background_throttler.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/ui/native_app_window.h"
+#include "cameo/src/test/base/cameo_headless_runtime_test.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/web_contents.h"
+
+using cameo::Runtime;
+
+namespace {
+
+const int kRuntimeCount = 10;
+
+// Reports the CPU usage of the render processes of |runtimes| over
+// |duration|, in percent of one core.
+double MeasureRendererCPUUsage(const std::vector<Runtime*>& runtimes,
+                               base::TimeDelta duration) {
+  std::set<base::ProcessHandle> handles;
+  for (size_t i = 0; i < runtimes.size(); ++i)
+    handles.insert(runtimes[i]->web_contents()->GetRenderProcessHost()->
+                   GetHandle());
+
+  std::vector<linked_ptr<base::ProcessMetrics> > metrics;
+  for (std::set<base::ProcessHandle>::iterator it = handles.begin();
+       it != handles.end(); ++it) {
+    metrics.push_back(linked_ptr<base::ProcessMetrics>(
+        base::ProcessMetrics::CreateProcessMetrics(*it)));
+    // The first sample only sets the start of the measure.
+    metrics.back()->GetCPUUsage();
+  }
+  cameo_test_utils::RunMessageLoopFor(duration);
+  double usage = 0;
+  for (size_t i = 0; i < metrics.size(); ++i)
+    usage += metrics[i]->GetCPUUsage();
+  return usage;
+}
+
+}  // namespace
+
+typedef CameoHeadlessRuntimeTest BackgroundThrottlerTest;
+
+IN_PROC_BROWSER_TEST_F(BackgroundThrottlerTest, IdleCPUBenchmark) {
+  GURL url = cameo_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII("busy.html"));
+  std::vector<Runtime*> runtimes;
+  for (int i = 0; i < kRuntimeCount; ++i) {
+    runtimes.push_back(Runtime::Create(runtime()->runtime_context(), url));
+    EXPECT_FALSE(runtimes.back()->background_throttler()->is_throttled());
+  }
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(1));
+  base::TimeDelta duration = base::TimeDelta::FromSeconds(3);
+  double visible = MeasureRendererCPUUsage(runtimes, duration);
+
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    runtimes[i]->window()->Minimize();
+    EXPECT_TRUE(runtimes[i]->background_throttler()->is_throttled());
+  }
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(1));
+  double minimized = MeasureRendererCPUUsage(runtimes, duration);
+  EXPECT_LT(minimized, visible);
+
+  // Back to the foreground.
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    runtimes[i]->window()->Restore();
+    EXPECT_FALSE(runtimes[i]->background_throttler()->is_throttled());
+    runtimes[i]->Close();
+  }
+
+  std::string measurement =
+      base::StringPrintf("renderer_cpu_%d_runtimes", kRuntimeCount);
+  cameo_test_utils::PrintPerfResult(measurement, "visible", visible, "%");
+  cameo_test_utils::PrintPerfResult(measurement, "minimized", minimized, "%");
+}
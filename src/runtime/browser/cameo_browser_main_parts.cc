@@ -7,73 +7,321 @@
 #include <string>
 
 #include "base/bind.h"
+#include "base/bind_helpers.h"
 #include "base/command_line.h"
+#include "base/debug/trace_event.h"
+#include "base/file_util.h"
 #include "base/files/file_path.h"
+#include "base/path_service.h"
+#include "base/run_loop.h"
+#include "base/string_number_conversions.h"
+#include "cameo/src/runtime/browser/memory_pressure_coordinator.h"
 #include "cameo/src/runtime/browser/runtime.h"
 #include "cameo/src/runtime/browser/runtime_context.h"
 #include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/browser/runtime_resource_monitor.h"
+#include "cameo/src/runtime/browser/startup_predictor.h"
+#include "cameo/src/runtime/browser/startup_tracer.h"
+#include "cameo/src/runtime/common/app_package.h"
+#include "cameo/src/runtime/common/cameo_constants.h"
+#include "cameo/src/runtime/common/cameo_paths.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/runtime/common/frame_ring.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/child_process_security_policy.h"
 #include "content/public/common/content_switches.h"
 #include "content/public/common/main_function_params.h"
+#include "content/public/common/result_codes.h"
 #include "content/public/common/url_constants.h"
 #include "net/base/net_util.h"
 
 namespace cameo {
 
+namespace {
+
+// The exit code of a browser process whose command line can't be run.
+const int kInvalidCommandLineResultCode = content::RESULT_CODE_LAST_CODE;
+
+// Returns the URL to open for |command_line|. A relative file path is resolved
+// against |current_directory| if it is not empty.
+GURL GetURLFromCommandLine(const CommandLine& command_line,
+                           const base::FilePath& current_directory) {
+  const CommandLine::StringVector& args = command_line.GetArgs();
+
+  if (args.empty())
+    return GURL(chrome::kAboutBlankURL);
+
+  GURL url(args[0]);
+  if (url.is_valid() && url.has_scheme())
+    return url;
+
+  base::FilePath path(args[0]);
+  if (!path.IsAbsolute() && !current_directory.empty())
+    path = current_directory.Append(path);
+  return net::FilePathToFileURL(path);
+}
+
+// Returns the path of the app package to run if |command_line| names one,
+// e.g. "cameo app.capk".
+base::FilePath GetAppPackagePathFromCommandLine(
+    const CommandLine& command_line) {
+  const CommandLine::StringVector& args = command_line.GetArgs();
+  if (args.empty() || GURL(args[0]).has_scheme())
+    return base::FilePath();
+
+  base::FilePath path(args[0]);
+  if (!path.MatchesExtension(kAppPackageExtension))
+    return base::FilePath();
+  return path;
+}
+
+#if defined(OS_LINUX)
+// The data path isn't registered yet when the message loop starts, see
+// RuntimeContext::InitWhileIOAllowed.
+base::FilePath GetDataPathFromCommandLine(const CommandLine& command_line) {
+  if (command_line.HasSwitch(switches::kCameoDataPath))
+    return command_line.GetSwitchValuePath(switches::kCameoDataPath);
+
+  base::FilePath data_path;
+  PathService::Get(cameo::DIR_DATA_PATH, &data_path);
+  return data_path;
+}
+#endif  // defined(OS_LINUX)
+
+void WriteNetworkTimingsOnFileThread(const base::FilePath& path,
+                                     const std::string& json) {
+  int size = static_cast<int>(json.size());
+  if (file_util::WriteFile(path, json.data(), size) != size)
+    LOG(WARNING) << "Failed to write the network timings to " << path.value();
+}
+
+// Writes |json| to |path| on the FILE thread, then runs |done|.
+void WriteNetworkTimings(const base::FilePath& path,
+                         const base::Closure& done,
+                         const std::string& json) {
+  content::BrowserThread::PostTaskAndReply(
+      content::BrowserThread::FILE, FROM_HERE,
+      base::Bind(&WriteNetworkTimingsOnFileThread, path, json), done);
+}
+
+// Streams the frames of |runtime| to the ring given on |command_line|, if any.
+void StartFrameCaptureFromCommandLine(const CommandLine& command_line,
+                                      Runtime* runtime) {
+  if (!command_line.HasSwitch(switches::kFrameCaptureRing))
+    return;
+
+  scoped_ptr<FrameRing> ring = FrameRing::Open(
+      command_line.GetSwitchValueASCII(switches::kFrameCaptureRing));
+  if (!ring)
+    return;
+
+  int max_frame_rate = 0;
+  if (command_line.HasSwitch(switches::kFrameCaptureMaxFps) &&
+      !base::StringToInt(
+          command_line.GetSwitchValueASCII(switches::kFrameCaptureMaxFps),
+          &max_frame_rate)) {
+    LOG(WARNING) << "Invalid --" << switches::kFrameCaptureMaxFps;
+  }
+  runtime->StartFrameCapture(ring.Pass(), max_frame_rate);
+}
+
+}  // namespace
+
 CameoBrowserMainParts::CameoBrowserMainParts(
     const content::MainFunctionParams& parameters)
     : BrowserMainParts(),
       startup_url_(chrome::kAboutBlankURL),
       parameters_(parameters),
-      run_default_message_loop_(true) {
+      run_default_message_loop_(true),
+      result_code_(content::RESULT_CODE_NORMAL_EXIT),
+      notified_other_process_(false) {
 }
 
 CameoBrowserMainParts::~CameoBrowserMainParts() {
 }
 
 void CameoBrowserMainParts::PreMainMessageLoopStart() {
+  TRACE_EVENT0("cameo.startup",
+               "CameoBrowserMainParts::PreMainMessageLoopStart");
   CommandLine* command_line = CommandLine::ForCurrentProcess();
-  const CommandLine::StringVector& args = command_line->GetArgs();
 
-  if (args.empty())
-    return;
+#if defined(OS_LINUX)
+  if (command_line->HasSwitch(switches::kProcessSingleton)) {
+    process_singleton_.reset(new ProcessSingleton(
+        GetDataPathFromCommandLine(*command_line),
+        base::Bind(&CameoBrowserMainParts::ProcessSingletonNotificationCallback,
+                   base::Unretained(this))));
+    switch (process_singleton_->NotifyOtherProcessOrCreate()) {
+      case ProcessSingleton::PROCESS_NONE:
+        break;
+      case ProcessSingleton::PROCESS_NOTIFIED:
+        notified_other_process_ = true;
+        process_singleton_.reset();
+        return;
+      case ProcessSingleton::PROCESS_ERROR:
+        LOG(WARNING) << "Failed to share the browser process, "
+                     << "running a standalone one.";
+        process_singleton_.reset();
+        break;
+    }
+  }
+#endif
 
-  GURL url(args[0]);
-  if (url.is_valid() && url.has_scheme())
-    startup_url_ = url;
-  else
-    startup_url_ = net::FilePathToFileURL(base::FilePath(args[0]));
+  startup_url_ = GetURLFromCommandLine(*command_line, base::FilePath());
+
+  // The package is mapped once here, its resources are then served from
+  // memory under app://package/.
+  base::FilePath package_path =
+      GetAppPackagePathFromCommandLine(*command_line);
+  if (!package_path.empty()) {
+    app_package_ = AppPackage::Open(package_path);
+    if (app_package_) {
+      startup_url_ = GURL(std::string(kAppScheme) + "://" + kAppPackageHost +
+                          "/");
+    }
+  }
 }
 
 void CameoBrowserMainParts::PostMainMessageLoopStart() {
+  TRACE_EVENT0("cameo.startup",
+               "CameoBrowserMainParts::PostMainMessageLoopStart");
+  if (StartupTracer* tracer = StartupTracer::Get())
+    tracer->StartTimeout();
 }
 
 void CameoBrowserMainParts::PreEarlyInitialization() {
+  TRACE_EVENT0("cameo.startup",
+               "CameoBrowserMainParts::PreEarlyInitialization");
 }
 
 void CameoBrowserMainParts::PreMainMessageLoopRun() {
+  TRACE_EVENT0("cameo.startup",
+               "CameoBrowserMainParts::PreMainMessageLoopRun");
+  // Owned from here, so that it is deleted whichever way this returns. See
+  // the end of the function.
+  scoped_ptr<base::Closure> ui_task(parameters_.ui_task);
+
+  // The command line has been handled by the running browser process, quit
+  // without running the main message loop.
+  if (notified_other_process_) {
+    run_default_message_loop_ = false;
+    return;
+  }
+
   runtime_context_.reset(new RuntimeContext);
+  // Better exit than silently go to the network.
+  if (CommandLine::ForCurrentProcess()->HasSwitch(switches::kReplayNetwork) &&
+      !runtime_context_->replay_archive()) {
+    result_code_ = kInvalidCommandLineResultCode;
+    run_default_message_loop_ = false;
+    return;
+  }
   runtime_registry_.reset(new RuntimeRegistry);
+  memory_pressure_coordinator_.reset(new MemoryPressureCoordinator(
+      runtime_context_.get(),
+      MemoryPressureCoordinator::Config::FromCommandLine(
+          *CommandLine::ForCurrentProcess())));
+  memory_pressure_coordinator_->Start();
+  runtime_resource_monitor_.reset(new RuntimeResourceMonitor(
+      runtime_context_.get(),
+      RuntimeResourceMonitor::Config::FromCommandLine(
+          *CommandLine::ForCurrentProcess())));
+  runtime_resource_monitor_->Start();
+
+  content::ChildProcessSecurityPolicy::GetInstance()->RegisterWebSafeScheme(
+      kAppScheme);
+  if (app_package_)
+    runtime_context_->set_app_package(app_package_.get());
+
+  // Let the IO thread set up the network stack while the window and the
+  // renderer of the startup Runtime are being created.
+  runtime_context_->WarmUpRequestContext();
+  startup_predictor_ =
+      new StartupPredictor(runtime_context_->GetPath(), startup_url_);
+  startup_predictor_->Start(runtime_context_->url_request_context_getter());
+
+#if defined(OS_LINUX)
+  if (process_singleton_)
+    process_singleton_->StartListening();
+#endif
 
   // The new created Runtime instance will be managed by RuntimeRegistry.
-  Runtime::Create(runtime_context_.get(), startup_url_);
+  Runtime* runtime = Runtime::Create(runtime_context_.get(), startup_url_);
+  startup_predictor_->SetStartupRuntime(runtime);
+  if (StartupTracer* tracer = StartupTracer::Get())
+    tracer->ObserveStartupWebContents(runtime->web_contents());
+  StartFrameCaptureFromCommandLine(*CommandLine::ForCurrentProcess(), runtime);
 
   // If the |ui_task| is specified in main function parameter, it indicates
   // that we will run this UI task instead of running the the default main
   // message loop. See |content::BrowserTestBase::SetUp| for |ui_task| usage
   // case.
-  if (parameters_.ui_task) {
-    parameters_.ui_task->Run();
-    delete parameters_.ui_task;
+  if (ui_task) {
+    ui_task->Run();
     run_default_message_loop_ = false;
   }
 }
 
 bool CameoBrowserMainParts::MainMessageLoopRun(int* result_code) {
+  if (!run_default_message_loop_)
+    *result_code = result_code_;
   return !run_default_message_loop_;
 }
 
 void CameoBrowserMainParts::PostMainMessageLoopRun() {
+  TRACE_EVENT0("cameo.startup",
+               "CameoBrowserMainParts::PostMainMessageLoopRun");
+  // The timings of the whole session, while the IO and FILE threads are
+  // still there to collect and write them.
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (runtime_context_ &&
+      command_line.HasSwitch(switches::kDumpNetworkTimings)) {
+    base::RunLoop run_loop;
+    runtime_context_->GetNetworkTimingsAsJSON(base::Bind(
+        &WriteNetworkTimings,
+        command_line.GetSwitchValuePath(switches::kDumpNetworkTimings),
+        run_loop.QuitClosure()));
+    run_loop.Run();
+  }
+
+#if defined(OS_LINUX)
+  if (process_singleton_) {
+    process_singleton_->Cleanup();
+    process_singleton_.reset();
+  }
+#endif
+  if (startup_predictor_) {
+    startup_predictor_->Shutdown();
+    startup_predictor_ = NULL;
+  }
+  runtime_resource_monitor_.reset();
+  memory_pressure_coordinator_.reset();
   runtime_context_.reset();
 }
 
+#if defined(OS_LINUX)
+bool CameoBrowserMainParts::ProcessSingletonNotificationCallback(
+    const CommandLine& command_line,
+    const base::FilePath& current_directory) {
+  if (!runtime_context_)
+    return false;
+
+  // A launch only asking for the network timings doesn't open any Runtime.
+  if (command_line.HasSwitch(switches::kDumpNetworkTimings)) {
+    base::FilePath path =
+        command_line.GetSwitchValuePath(switches::kDumpNetworkTimings);
+    if (!path.IsAbsolute())
+      path = current_directory.Append(path);
+    runtime_context_->GetNetworkTimingsAsJSON(
+        base::Bind(&WriteNetworkTimings, path, base::Bind(&base::DoNothing)));
+    return true;
+  }
+
+  // The new created Runtime instance will be managed by RuntimeRegistry.
+  Runtime::Create(runtime_context_.get(),
+                  GetURLFromCommandLine(command_line, current_directory));
+  return true;
+}
+#endif  // defined(OS_LINUX)
+
 }  // cameo
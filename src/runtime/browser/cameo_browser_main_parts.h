@@ -6,15 +6,24 @@
 #define CAMEO_SRC_RUNTIME_BROWSER_CAMEO_BROWSER_MAIN_PARTS_H_
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "content/public/browser/browser_main_parts.h"
 #include "content/public/common/main_function_params.h"
 #include "googleurl/src/gurl.h"
 
+#if defined(OS_LINUX)
+#include "cameo/src/runtime/browser/process_singleton.h"
+#endif
+
 namespace cameo {
 
+class AppPackage;
+class MemoryPressureCoordinator;
 class RuntimeContext;
 class RuntimeRegistry;
+class RuntimeResourceMonitor;
+class StartupPredictor;
 
 class CameoBrowserMainParts : public content::BrowserMainParts {
  public:
@@ -33,11 +42,30 @@ class CameoBrowserMainParts : public content::BrowserMainParts {
   RuntimeContext* runtime_context() { return runtime_context_.get(); }
 
  private:
+#if defined(OS_LINUX)
+  // Called when a later launch hands its command line to this process.
+  bool ProcessSingletonNotificationCallback(
+      const CommandLine& command_line,
+      const base::FilePath& current_directory);
+#endif
+
   scoped_ptr<RuntimeContext> runtime_context_;
 
   // An application wide instance to manage all Runtime instances.
   scoped_ptr<RuntimeRegistry> runtime_registry_;
 
+  // Gives memory back when the system or the cgroup runs low on it.
+  scoped_ptr<MemoryPressureCoordinator> memory_pressure_coordinator_;
+
+  // Samples what every Runtime uses of the machine.
+  scoped_ptr<RuntimeResourceMonitor> runtime_resource_monitor_;
+
+  // Preconnects to the startup origin and the origins its page used last time.
+  scoped_refptr<StartupPredictor> startup_predictor_;
+
+  // The app package given on the command line, served under app://.
+  scoped_refptr<AppPackage> app_package_;
+
   // Should be about:blank If no URL is specified in command line arguments.
   GURL startup_url_;
 
@@ -46,6 +74,18 @@ class CameoBrowserMainParts : public content::BrowserMainParts {
 
   // True if we need to run the default message loop defined in content.
   bool run_default_message_loop_;
+  // The exit code of the process when the default message loop isn't run.
+  int result_code_;
+
+#if defined(OS_LINUX)
+  // Present if this process is the browser process shared by all launches
+  // using the same data path. See switches::kProcessSingleton.
+  scoped_ptr<ProcessSingleton> process_singleton_;
+#endif
+
+  // True if the command line has been handed to an already running browser
+  // process, in which case this process exits without opening any Runtime.
+  bool notified_other_process_;
 
   DISALLOW_COPY_AND_ASSIGN(CameoBrowserMainParts);
 };
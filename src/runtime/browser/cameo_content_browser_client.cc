@@ -4,12 +4,16 @@
 
 #include "cameo/src/runtime/browser/cameo_content_browser_client.h"
 
+#include "base/command_line.h"
 #include "cameo/src/runtime/browser/cameo_browser_main_parts.h"
 #include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/common/cameo_constants.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
 #include "content/public/browser/browser_main_parts.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/browser/web_contents_view_delegate.h"
 #include "content/public/common/main_function_params.h"
+#include "googleurl/src/gurl.h"
 #include "net/url_request/url_request_context_getter.h"
 
 namespace cameo {
@@ -59,10 +63,35 @@ CameoContentBrowserClient::CreateRequestContextForStoragePartition(
           partition_path, in_memory, protocol_handlers);
 }
 
+void CameoContentBrowserClient::GetStoragePartitionConfigForSite(
+    content::BrowserContext* browser_context,
+    const GURL& site,
+    bool can_be_default,
+    std::string* partition_domain,
+    std::string* partition_name,
+    bool* in_memory) {
+  partition_domain->clear();
+  partition_name->clear();
+  *in_memory = false;
+
+  // Everything lives in the default partition unless asked otherwise, so the
+  // data of existing installs stays where it is.
+  if (!CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kIsolateSiteStorage))
+    return;
+  if (!site.is_valid() || site.host().empty())
+    return;
+  *partition_domain = site.host();
+}
+
 content::WebContentsViewDelegate*
 CameoContentBrowserClient::GetWebContentsViewDelegate(
     content::WebContents* web_contents) {
   return NULL;
 }
 
+bool CameoContentBrowserClient::IsHandledURL(const GURL& url) {
+  return url.SchemeIs(kAppScheme);
+}
+
 }  // namespace cameo
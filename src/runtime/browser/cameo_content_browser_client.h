@@ -5,6 +5,8 @@
 #ifndef CAMEO_SRC_RUNTIME_BROWSER_CAMEO_CONTENT_BROWSER_CLIENT_H_
 #define CAMEO_SRC_RUNTIME_BROWSER_CAMEO_CONTENT_BROWSER_CLIENT_H_
 
+#include <string>
+
 #include "base/compiler_specific.h"
 #include "content/public/browser/content_browser_client.h"
 #include "content/public/common/main_function_params.h"
@@ -41,8 +43,16 @@ class CameoContentBrowserClient : public content::ContentBrowserClient {
       const base::FilePath& partition_path,
       bool in_memory,
       content::ProtocolHandlerMap* protocol_handlers) OVERRIDE;
+  virtual void GetStoragePartitionConfigForSite(
+      content::BrowserContext* browser_context,
+      const GURL& site,
+      bool can_be_default,
+      std::string* partition_domain,
+      std::string* partition_name,
+      bool* in_memory) OVERRIDE;
   virtual content::WebContentsViewDelegate* GetWebContentsViewDelegate(
       content::WebContents* web_contents) OVERRIDE;
+  virtual bool IsHandledURL(const GURL& url) OVERRIDE;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(CameoContentBrowserClient);
@@ -4,13 +4,22 @@
 
 #include "base/command_line.h"
 #include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/path_service.h"
 #include "base/process_util.h"
 #include "base/string_util.h"
+#include "base/test/test_timeouts.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/process_singleton.h"
 #include "cameo/src/runtime/browser/runtime.h"
 #include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/browser/ui/native_app_window_headless.h"
 #include "cameo/src/runtime/common/cameo_notification_types.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_headless_runtime_test.h"
 #include "cameo/src/test/base/cameo_test_utils.h"
 #include "cameo/src/test/base/in_process_browser_test.h"
 #include "content/public/browser/navigation_controller.h"
@@ -98,21 +107,81 @@ class CameoRuntimeTest : public InProcessBrowserTest {
   scoped_ptr<content::WindowedNotificationObserver> notification_observer_;
 };
 
-// FIXME(hmin): Since currently the browser process is not shared by multiple
-// app launch, this test is disabled to avoid floody launches.
-IN_PROC_BROWSER_TEST_F(CameoRuntimeTest, DISABLED_SecondLaunch) {
+#if defined(OS_LINUX)
+// Runs the browser as the process singleton of its own data path, so that
+// relaunches of the test binary are handed to it.
+class CameoProcessSingletonTest : public CameoRuntimeTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    ASSERT_TRUE(data_path_.CreateUniqueTempDir());
+    command_line->AppendSwitchPath(switches::kCameoDataPath,
+                                   data_path_.path());
+    command_line->AppendSwitch(switches::kProcessSingleton);
+  }
+
+  // Launches a fresh browser process with its own data path and returns how
+  // long it takes until it has opened a command line handed to it.
+  base::TimeDelta MeasureColdLaunch() {
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    base::ScopedTempDir cold_data_path;
+    EXPECT_TRUE(cold_data_path.CreateUniqueTempDir());
+    CommandLine command_line = GetCommandLineForRelaunch();
+    command_line.AppendSwitchPath(switches::kCameoDataPath,
+                                  cold_data_path.path());
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    base::ProcessHandle handle;
+    EXPECT_TRUE(base::LaunchProcess(command_line, base::LaunchOptions(),
+                                    &handle));
+
+    cameo::ProcessSingleton probe(
+        cold_data_path.path(), cameo::ProcessSingleton::NotificationCallback());
+    base::TimeDelta timeout = TestTimeouts::action_max_timeout();
+    while (probe.NotifyOtherProcess() !=
+               cameo::ProcessSingleton::PROCESS_NOTIFIED &&
+           base::TimeTicks::Now() - start < timeout) {
+      base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(10));
+    }
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+    base::KillProcess(handle, 0, true);
+    base::CloseProcessHandle(handle);
+    return elapsed;
+  }
+
+ private:
+  base::ScopedTempDir data_path_;
+};
+
+IN_PROC_BROWSER_TEST_F(CameoProcessSingletonTest, SecondLaunch) {
   MockRuntimeRegistryObserver observer;
   RuntimeRegistry::Get()->AddObserver(&observer);
+  EXPECT_CALL(observer, OnRuntimeAdded(_)).Times(1);
   Relaunch(GetCommandLineForRelaunch());
 
-  Runtime* second_runtime = NULL;
-  EXPECT_TRUE(second_runtime == WaitForSingleNewRuntime());
-  EXPECT_CALL(observer, OnRuntimeAdded(second_runtime)).Times(1);
+  Runtime* second_runtime = WaitForSingleNewRuntime();
+  EXPECT_TRUE(NULL != second_runtime);
+  EXPECT_NE(runtime(), second_runtime);
   ASSERT_EQ(2u, RuntimeRegistry::Get()->runtimes().size());
 
   RuntimeRegistry::Get()->RemoveObserver(&observer);
 }
 
+IN_PROC_BROWSER_TEST_F(CameoProcessSingletonTest, LaunchTimeBenchmark) {
+  base::TimeTicks start = base::TimeTicks::Now();
+  Relaunch(GetCommandLineForRelaunch());
+  EXPECT_TRUE(NULL != WaitForSingleNewRuntime());
+  base::TimeDelta hand_off = base::TimeTicks::Now() - start;
+
+  base::TimeDelta cold = MeasureColdLaunch();
+
+  cameo_test_utils::PrintPerfResult("launch_time", "cold",
+                                    cold.InMillisecondsF(), "ms");
+  cameo_test_utils::PrintPerfResult("launch_time", "hand_off",
+                                    hand_off.InMillisecondsF(), "ms");
+}
+#endif  // defined(OS_LINUX)
+
 IN_PROC_BROWSER_TEST_F(CameoRuntimeTest, CreateAndCloseRuntime) {
   MockRuntimeRegistryObserver observer;
   RuntimeRegistry::Get()->AddObserver(&observer);
@@ -180,6 +249,35 @@ IN_PROC_BROWSER_TEST_F(CameoRuntimeTest, GetWindowTitle) {
 #endif  // defined(TOOLKIT_GTK)
 }
 
+IN_PROC_BROWSER_TEST_F(CameoHeadlessRuntimeTest, HeadlessWindow) {
+  GURL url = cameo_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII("title.html"));
+  string16 title = ASCIIToUTF16("Dummy Title");
+  content::TitleWatcher title_watcher(runtime()->web_contents(), title);
+  cameo_test_utils::NavigateToURL(runtime(), url);
+  EXPECT_EQ(title, title_watcher.WaitAndGetTitle());
+
+  // No native window is created, its title and bounds live in memory.
+  cameo::NativeAppWindowHeadless* window =
+      static_cast<cameo::NativeAppWindowHeadless*>(runtime()->window());
+  EXPECT_TRUE(NULL == window->GetNativeWindow());
+  EXPECT_EQ(title, window->title());
+
+  gfx::Rect bounds(10, 20, 320, 240);
+  window->SetBounds(bounds);
+  EXPECT_EQ(bounds, window->GetBounds());
+
+  window->Minimize();
+  EXPECT_TRUE(window->IsMinimized());
+  window->Restore();
+  EXPECT_FALSE(window->IsMinimized());
+
+  size_t len = RuntimeRegistry::Get()->runtimes().size();
+  window->Close();
+  content::RunAllPendingInMessageLoop();
+  EXPECT_EQ(len - 1, RuntimeRegistry::Get()->runtimes().size());
+}
+
 IN_PROC_BROWSER_TEST_F(CameoRuntimeTest, OpenLinkInNewRuntime) {
   size_t len = RuntimeRegistry::Get()->runtimes().size();
   GURL url = cameo_test_utils::GetTestURL(
@@ -0,0 +1,195 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/stringprintf.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/cookie_store_factory.h"
+#include "googleurl/src/gurl.h"
+#include "net/cookies/cookie_monster.h"
+#include "net/cookies/cookie_options.h"
+#include "sql/connection.h"
+#include "sql/statement.h"
+#include "sql/transaction.h"
+
+using cameo_test_utils::RunOnIOThreadAndWait;
+using content::BrowserThread;
+
+namespace {
+
+const int kDomainCount = 500;
+const int kCookiesPerDomain = 20;
+
+GURL GetDomainURL(int index) {
+  return GURL(base::StringPrintf("http://www.domain%d.com/", index));
+}
+
+// The state of one cookie store, only touched on the IO thread while the UI
+// thread waits for it.
+struct CookieStoreState {
+  CookieStoreState() : cookie_count(0) {}
+
+  scoped_refptr<net::CookieStore> store;
+  base::TimeTicks start;
+  base::TimeDelta load_time;
+  size_t cookie_count;
+};
+
+void OpenStore(const base::FilePath& path, CookieStoreState* state,
+               const base::Closure& done) {
+  state->start = base::TimeTicks::Now();
+  state->store = content::CreatePersistentCookieStore(path, false, NULL, NULL);
+  done.Run();
+}
+
+void CloseStore(CookieStoreState* state, const base::Closure& done) {
+  // Releasing the store commits whatever is pending and closes the database.
+  state->store = NULL;
+  done.Run();
+}
+
+void OnCookieSet(int* remaining, const base::Closure& done, bool success) {
+  EXPECT_TRUE(success);
+  if (--*remaining == 0)
+    done.Run();
+}
+
+void SetCookies(CookieStoreState* state, int* remaining, const GURL& url,
+                const base::Closure& done) {
+  for (int i = 0; i < kCookiesPerDomain; ++i) {
+    state->store->SetCookieWithOptionsAsync(
+        url, base::StringPrintf("cookie%d=value%d; max-age=86400", i, i),
+        net::CookieOptions(), base::Bind(&OnCookieSet, remaining, done));
+  }
+}
+
+void FlushStore(CookieStoreState* state, const base::Closure& done) {
+  state->store->GetCookieMonster()->FlushStore(done);
+}
+
+void OnDomainCookiesLoaded(CookieStoreState* state, const base::Closure& done,
+                           const std::string& cookie_line) {
+  state->load_time = base::TimeTicks::Now() - state->start;
+  // The cookie line is "name1=value1; name2=value2...".
+  state->cookie_count = cookie_line.empty() ?
+      0 : std::count(cookie_line.begin(), cookie_line.end(), ';') + 1;
+  done.Run();
+}
+
+void LoadDomainCookies(CookieStoreState* state, const GURL& url,
+                       const base::Closure& done) {
+  state->store->GetCookiesWithOptionsAsync(
+      url, net::CookieOptions(),
+      base::Bind(&OnDomainCookiesLoaded, state, done));
+}
+
+void OnAllCookiesLoaded(CookieStoreState* state, const base::Closure& done,
+                        const net::CookieList& cookies) {
+  state->load_time = base::TimeTicks::Now() - state->start;
+  state->cookie_count = cookies.size();
+  done.Run();
+}
+
+void LoadAllCookies(CookieStoreState* state, const base::Closure& done) {
+  state->store->GetCookieMonster()->GetAllCookiesAsync(
+      base::Bind(&OnAllCookiesLoaded, state, done));
+}
+
+}  // namespace
+
+class CookieStoreTest : public InProcessBrowserTest {
+ public:
+  virtual void SetUpOnMainThread() OVERRIDE {
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    seed_path_ = temp_dir_.path().AppendASCII("Cookies");
+  }
+
+  // Writes a cookie database of kDomainCount domains with kCookiesPerDomain
+  // cookies each. The cookie monster keeps at most a few thousand cookies, so
+  // the first domain is written through it and then cloned in SQL.
+  void CreateCookieDatabase() {
+    CookieStoreState state;
+    int remaining = kCookiesPerDomain;
+    RunOnIOThreadAndWait(base::Bind(&OpenStore, seed_path_, &state));
+    RunOnIOThreadAndWait(
+        base::Bind(&SetCookies, &state, &remaining, GetDomainURL(0)));
+    RunOnIOThreadAndWait(base::Bind(&FlushStore, &state));
+    RunOnIOThreadAndWait(base::Bind(&CloseStore, &state));
+    // Let the blocking pool close the database.
+    BrowserThread::GetBlockingPool()->FlushForTesting();
+
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    sql::Connection db;
+    ASSERT_TRUE(db.Open(seed_path_));
+    sql::Transaction transaction(&db);
+    ASSERT_TRUE(transaction.Begin());
+    ASSERT_TRUE(db.Execute("CREATE TEMP TABLE seed AS SELECT * FROM cookies"));
+    for (int i = 1; i < kDomainCount; ++i) {
+      // Creation times are the primary key, move each copy one second on.
+      sql::Statement update(db.GetUniqueStatement(
+          "UPDATE seed SET host_key = ?, "
+          "creation_utc = creation_utc + 1000000"));
+      update.BindString(0, GetDomainURL(i).host());
+      ASSERT_TRUE(update.Run());
+      ASSERT_TRUE(db.Execute("INSERT INTO cookies SELECT * FROM seed"));
+    }
+    ASSERT_TRUE(db.Execute("DROP TABLE seed"));
+    ASSERT_TRUE(transaction.Commit());
+  }
+
+  // Opens a copy of the database in a fresh store, as a new launch would,
+  // and runs |load| on it.
+  CookieStoreState ColdLoad(
+      const base::Callback<void(CookieStoreState*,
+                                const base::Closure&)>& load) {
+    base::FilePath path = temp_dir_.path().AppendASCII("Cookies Copy");
+    {
+      base::ThreadRestrictions::ScopedAllowIO allow_io;
+      file_util::Delete(path, false);
+      EXPECT_TRUE(file_util::CopyFile(seed_path_, path));
+    }
+
+    CookieStoreState state;
+    RunOnIOThreadAndWait(base::Bind(&OpenStore, path, &state));
+    RunOnIOThreadAndWait(base::Bind(load, &state));
+    RunOnIOThreadAndWait(base::Bind(&CloseStore, &state));
+    BrowserThread::GetBlockingPool()->FlushForTesting();
+    return state;
+  }
+
+ private:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath seed_path_;
+};
+
+IN_PROC_BROWSER_TEST_F(CookieStoreTest, ColdLoadBenchmark) {
+  CreateCookieDatabase();
+
+  // What the startup page waits for: the cookies of its own domain, which
+  // are loaded ahead of the rest of the jar.
+  CookieStoreState domain = ColdLoad(
+      base::Bind(&LoadDomainCookies, GetDomainURL(kDomainCount / 2)));
+  EXPECT_EQ(static_cast<size_t>(kCookiesPerDomain), domain.cookie_count);
+
+  CookieStoreState all = ColdLoad(base::Bind(&LoadAllCookies));
+  EXPECT_GT(all.cookie_count, 0u);
+
+  std::string trace = base::StringPrintf(
+      "%d_cookies", kDomainCount * kCookiesPerDomain);
+  cameo_test_utils::PrintPerfResult("cookie_load_first_domain", trace,
+                                    domain.load_time.InMillisecondsF(), "ms");
+  cameo_test_utils::PrintPerfResult("cookie_load_all", trace,
+                                    all.load_time.InMillisecondsF(), "ms");
+}
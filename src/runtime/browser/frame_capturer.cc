@@ -0,0 +1,108 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/frame_capturer.h"
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "cameo/src/runtime/common/frame_ring.h"
+#include "content/public/browser/notification_service.h"
+#include "content/public/browser/notification_source.h"
+#include "content/public/browser/notification_types.h"
+#include "content/public/browser/render_view_host.h"
+#include "content/public/browser/render_widget_host.h"
+#include "content/public/browser/web_contents.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/rect.h"
+#include "ui/gfx/size.h"
+
+namespace cameo {
+
+FrameCapturer::FrameCapturer(content::WebContents* web_contents,
+                             scoped_ptr<FrameRing> ring,
+                             int max_frame_rate)
+    : web_contents_(web_contents),
+      ring_(ring.Pass()),
+      frame_dirty_(true),
+      copy_in_flight_(false),
+      captured_frames_(0),
+      captured_bytes_(0),
+      weak_factory_(this) {
+  if (max_frame_rate > 0) {
+    min_frame_interval_ = base::TimeDelta::FromMicroseconds(
+        base::Time::kMicrosecondsPerSecond / max_frame_rate);
+  }
+
+  // The RenderViewHost changes on cross-site navigations, so listen to all
+  // of them and only keep the current one of |web_contents_|.
+  registrar_.Add(this,
+      content::NOTIFICATION_RENDER_WIDGET_HOST_DID_UPDATE_BACKING_STORE,
+      content::NotificationService::AllSources());
+
+  // Start with what is already on screen.
+  MaybeCaptureFrame();
+}
+
+FrameCapturer::~FrameCapturer() {
+}
+
+void FrameCapturer::Observe(int type,
+                            const content::NotificationSource& source,
+                            const content::NotificationDetails& details) {
+  DCHECK_EQ(content::NOTIFICATION_RENDER_WIDGET_HOST_DID_UPDATE_BACKING_STORE,
+            type);
+  content::RenderWidgetHost* host =
+      content::Source<content::RenderWidgetHost>(source).ptr();
+  if (host != web_contents_->GetRenderViewHost())
+    return;
+
+  frame_dirty_ = true;
+  MaybeCaptureFrame();
+}
+
+void FrameCapturer::MaybeCaptureFrame() {
+  if (!frame_dirty_ || copy_in_flight_ || frame_rate_timer_.IsRunning())
+    return;
+
+  content::RenderViewHost* host = web_contents_->GetRenderViewHost();
+  if (!host)
+    return;
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeDelta since_last_capture = now - last_capture_time_;
+  if (since_last_capture < min_frame_interval_) {
+    frame_rate_timer_.Start(FROM_HERE,
+                            min_frame_interval_ - since_last_capture,
+                            this, &FrameCapturer::MaybeCaptureFrame);
+    return;
+  }
+
+  TRACE_EVENT_ASYNC_BEGIN0("cameo", "FrameCapturer::CaptureFrame", this);
+  frame_dirty_ = false;
+  copy_in_flight_ = true;
+  last_capture_time_ = now;
+  // An empty source rect copies the whole view at its own size.
+  host->CopyFromBackingStore(
+      gfx::Rect(), gfx::Size(),
+      base::Bind(&FrameCapturer::OnFrameCopied, weak_factory_.GetWeakPtr()));
+}
+
+void FrameCapturer::OnFrameCopied(bool succeeded, const SkBitmap& bitmap) {
+  TRACE_EVENT_ASYNC_END0("cameo", "FrameCapturer::CaptureFrame", this);
+  copy_in_flight_ = false;
+
+  if (succeeded && bitmap.config() == SkBitmap::kARGB_8888_Config) {
+    SkAutoLockPixels lock(bitmap);
+    if (ring_->WriteFrame(bitmap.getPixels(), bitmap.width(), bitmap.height(),
+                          bitmap.rowBytes(), FrameRing::PIXEL_FORMAT_BGRA,
+                          last_capture_time_)) {
+      ++captured_frames_;
+      captured_bytes_ += bitmap.getSize();
+    }
+  }
+
+  MaybeCaptureFrame();
+}
+
+}  // namespace cameo
@@ -0,0 +1,76 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_FRAME_CAPTURER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_FRAME_CAPTURER_H_
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "content/public/browser/notification_observer.h"
+#include "content/public/browser/notification_registrar.h"
+
+class SkBitmap;
+
+namespace content {
+class WebContents;
+}
+
+namespace cameo {
+
+class FrameRing;
+
+// FrameCapturer copies every frame painted by a WebContents into a FrameRing.
+// It reads the frames back from the software backing store of the current
+// RenderViewHost, so it doesn't need a GPU. Frames painted faster than the
+// frame rate cap, or while the previous copy is still in flight, are
+// coalesced into the next capture.
+class FrameCapturer : public content::NotificationObserver {
+ public:
+  // |max_frame_rate| is in frames per second, 0 means uncapped.
+  FrameCapturer(content::WebContents* web_contents,
+                scoped_ptr<FrameRing> ring,
+                int max_frame_rate);
+  virtual ~FrameCapturer();
+
+  FrameRing* ring() const { return ring_.get(); }
+  int captured_frames() const { return captured_frames_; }
+  int64 captured_bytes() const { return captured_bytes_; }
+
+  // content::NotificationObserver implementation.
+  virtual void Observe(int type,
+                       const content::NotificationSource& source,
+                       const content::NotificationDetails& details) OVERRIDE;
+
+ private:
+  // Captures the last painted frame unless a copy is in flight or the frame
+  // rate cap says to wait.
+  void MaybeCaptureFrame();
+  void OnFrameCopied(bool succeeded, const SkBitmap& bitmap);
+
+  content::WebContents* web_contents_;
+  scoped_ptr<FrameRing> ring_;
+  base::TimeDelta min_frame_interval_;
+
+  // True if a frame was painted since the last capture started.
+  bool frame_dirty_;
+  bool copy_in_flight_;
+  base::TimeTicks last_capture_time_;
+  base::OneShotTimer<FrameCapturer> frame_rate_timer_;
+
+  int captured_frames_;
+  int64 captured_bytes_;
+
+  content::NotificationRegistrar registrar_;
+  base::WeakPtrFactory<FrameCapturer> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameCapturer);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_FRAME_CAPTURER_H_
@@ -0,0 +1,101 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/frame_capturer.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/common/frame_ring.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/render_widget_host_view.h"
+#include "content/public/browser/web_contents.h"
+
+using cameo::FrameCapturer;
+using cameo::FrameRing;
+
+namespace {
+
+// Large enough for a 1920x1080 window.
+const size_t kMaxFrameBytes = 1920 * 1080 * 4;
+const size_t kSlotCount = 4;
+
+}  // namespace
+
+class FrameCapturerTest : public InProcessBrowserTest {
+ public:
+  // Creates a ring the way a consumer would, and has the startup Runtime
+  // stream the animation test page into it.
+  void StartCapture(int max_frame_rate) {
+    std::string name = base::StringPrintf("cameo-browsertest-frames-%d",
+                                          base::GetCurrentProcId());
+    reader_ = FrameRing::Create(name, kSlotCount, kMaxFrameBytes);
+    ASSERT_TRUE(reader_);
+    runtime()->StartFrameCapture(FrameRing::Open(name), max_frame_rate);
+
+    cameo_test_utils::NavigateToURL(runtime(), cameo_test_utils::GetTestURL(
+        base::FilePath(), base::FilePath().AppendASCII("animation.html")));
+  }
+
+ protected:
+  scoped_ptr<FrameRing> reader_;
+};
+
+IN_PROC_BROWSER_TEST_F(FrameCapturerTest, CaptureFrames) {
+  StartCapture(0);
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(1));
+
+  uint32 sequence = reader_->GetLatestSequence();
+  ASSERT_GT(sequence, 1u);
+  FrameRing::FrameInfo info;
+  std::vector<uint8> pixels;
+  ASSERT_TRUE(reader_->ReadFrame(sequence, &info, &pixels));
+  EXPECT_EQ(sequence, info.sequence);
+
+  gfx::Size view_size = runtime()->web_contents()->GetRenderWidgetHostView()->
+      GetViewBounds().size();
+  EXPECT_EQ(view_size.width(), info.width);
+  EXPECT_EQ(view_size.height(), info.height);
+  EXPECT_EQ(static_cast<size_t>(info.stride * info.height), pixels.size());
+
+  // The previous frame is still in the ring and older.
+  FrameRing::FrameInfo previous_info;
+  ASSERT_TRUE(reader_->ReadFrame(sequence - 1, &previous_info, &pixels));
+  EXPECT_LE(previous_info.timestamp, info.timestamp);
+  EXPECT_EQ(0u, reader_->GetDroppedFrameCount());
+}
+
+IN_PROC_BROWSER_TEST_F(FrameCapturerTest, FrameRateCap) {
+  const int kMaxFrameRate = 10;
+  StartCapture(kMaxFrameRate);
+  int frames_before = runtime()->frame_capturer()->captured_frames();
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(2));
+  int frames = runtime()->frame_capturer()->captured_frames() - frames_before;
+  EXPECT_GT(frames, 0);
+  // Allow one frame of slack for the first capture.
+  EXPECT_LE(frames, 2 * kMaxFrameRate + 1);
+}
+
+IN_PROC_BROWSER_TEST_F(FrameCapturerTest, CaptureThroughputBenchmark) {
+  StartCapture(0);
+  FrameCapturer* capturer = runtime()->frame_capturer();
+  int frames_before = capturer->captured_frames();
+  int64 bytes_before = capturer->captured_bytes();
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(3));
+  double seconds = (base::TimeTicks::Now() - start).InSecondsF();
+
+  int frames = capturer->captured_frames() - frames_before;
+  ASSERT_GT(frames, 0);
+  double bytes = capturer->captured_bytes() - bytes_before;
+  cameo_test_utils::PrintPerfResult("frame_capture", "throughput",
+                                    frames / seconds, "fps");
+  cameo_test_utils::PrintPerfResult("frame_capture", "bytes_per_frame",
+                                    bytes / frames, "bytes");
+}
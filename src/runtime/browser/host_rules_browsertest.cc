@@ -0,0 +1,55 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/string_number_conversions.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/common/content_switches.h"
+#include "googleurl/src/gurl.h"
+
+// The backends are made up names, pinned to the test server by the rules.
+class HostRulesTest : public InProcessBrowserTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    // kHostResolverRules only maps host names to addresses, the port of the
+    // test server stays in the URL. kHostRules maps the port too.
+    command_line->AppendSwitchASCII(switches::kHostResolverRules,
+                                    "MAP *.resolver.test 127.0.0.1");
+    command_line->AppendSwitchASCII(
+        switches::kHostRules,
+        "MAP backend.test 127.0.0.1:" +
+            base::IntToString(test_server()->host_port_pair().port()));
+    command_line->AppendSwitch(switches::kAsyncDns);
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(test_server()->Start());
+    InProcessBrowserTest::SetUp();
+  }
+
+  void ExpectLoaded(const GURL& url) {
+    cameo_test_utils::NavigateToURL(runtime(), url);
+    EXPECT_EQ(ASCIIToUTF16("Dummy Title"),
+              runtime()->web_contents()->GetTitle());
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(HostRulesTest, MapsHostResolution) {
+  GURL::Replacements replacements;
+  std::string host = "app.resolver.test";
+  replacements.SetHostStr(host);
+  ExpectLoaded(test_server()->GetURL("title.html").ReplaceComponents(
+      replacements));
+}
+
+IN_PROC_BROWSER_TEST_F(HostRulesTest, MapsHostAndPort) {
+  ExpectLoaded(GURL("http://backend.test/title.html"));
+}
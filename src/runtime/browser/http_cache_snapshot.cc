@@ -0,0 +1,253 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/http_cache_snapshot.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/pickle.h"
+#include "base/task_runner_util.h"
+#include "base/time.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_util.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// The streams of an entry of net::HttpCache.
+const int kResponseInfoIndex = 0;
+const int kResponseContentIndex = 1;
+
+// Only complete responses the cache could answer with, or revalidate, are
+// worth shipping.
+bool IsCacheable(const NetworkArchive::Entry& response, base::Time now) {
+  const net::HttpResponseHeaders* headers = response.headers.get();
+  return response.method == "GET" && headers->response_code() == 200 &&
+         !headers->HasHeaderValue("cache-control", "no-store") &&
+         (headers->HasValidators() ||
+          headers->GetFreshnessLifetime(now) > base::TimeDelta());
+}
+
+}  // namespace
+
+// static
+int HttpCacheSnapshot::Build(const base::FilePath& archive_path,
+                             const base::FilePath& snapshot_path) {
+  scoped_refptr<NetworkArchive> archive = NetworkArchive::Load(archive_path);
+  if (!archive)
+    return -1;
+  std::vector<const NetworkArchive::Entry*> responses;
+  archive->GetLastResponses(&responses);
+
+  Pickle header;
+  NetworkArchive::WriteHeader(&header);
+  std::string data(static_cast<const char*>(header.data()), header.size());
+  int count = 0;
+  base::Time now = base::Time::Now();
+  for (size_t i = 0; i < responses.size(); ++i) {
+    if (!IsCacheable(*responses[i], now))
+      continue;
+    Pickle pickle;
+    NetworkArchive::WriteEntry(*responses[i], &pickle);
+    data.append(static_cast<const char*>(pickle.data()), pickle.size());
+    ++count;
+  }
+
+  if (file_util::WriteFile(snapshot_path, data.data(), data.size()) !=
+      static_cast<int>(data.size())) {
+    LOG(ERROR) << "Failed to write the cache snapshot "
+               << snapshot_path.value();
+    return -1;
+  }
+  return count;
+}
+
+HttpCacheSnapshot::HttpCacheSnapshot(
+    const base::FilePath& snapshot_path,
+    net::HttpCache::BackendFactory* backend_factory)
+    : snapshot_path_(snapshot_path),
+      backend_factory_(backend_factory),
+      backend_(NULL),
+      backend_out_(NULL),
+      next_response_(0),
+      entry_(NULL),
+      imported_count_(0),
+      skipped_count_(0),
+      weak_factory_(this) {
+}
+
+HttpCacheSnapshot::~HttpCacheSnapshot() {
+  // The cache went away before the import was over.
+  if (entry_)
+    entry_->Close();
+  delete backend_;
+}
+
+int HttpCacheSnapshot::CreateBackend(net::NetLog* net_log,
+                                     disk_cache::Backend** backend,
+                                     const net::CompletionCallback& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  TRACE_EVENT_ASYNC_BEGIN0("cameo.startup", "HttpCacheSnapshot::CreateBackend",
+                           this);
+  backend_out_ = backend;
+  callback_ = callback;
+  int rv = backend_factory_->CreateBackend(
+      net_log, &backend_,
+      base::Bind(&HttpCacheSnapshot::OnBackendCreated,
+                 weak_factory_.GetWeakPtr()));
+  // The cache must not be called back before this returns.
+  if (rv != net::ERR_IO_PENDING) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&HttpCacheSnapshot::OnBackendCreated,
+                   weak_factory_.GetWeakPtr(), rv));
+  }
+  return net::ERR_IO_PENDING;
+}
+
+void HttpCacheSnapshot::OnBackendCreated(int rv) {
+  // Only a new cache gets the snapshot, what a cache in use holds is more
+  // recent.
+  if (rv != net::OK || backend_->GetEntryCount() > 0) {
+    Finish(rv);
+    return;
+  }
+  base::PostTaskAndReplyWithResult(
+      BrowserThread::GetMessageLoopProxyForThread(BrowserThread::FILE),
+      FROM_HERE,
+      base::Bind(&NetworkArchive::Load, snapshot_path_),
+      base::Bind(&HttpCacheSnapshot::OnSnapshotLoaded,
+                 weak_factory_.GetWeakPtr()));
+}
+
+void HttpCacheSnapshot::OnSnapshotLoaded(
+    scoped_refptr<NetworkArchive> snapshot) {
+  // The cache still works without the snapshot, NetworkArchive logged why.
+  if (!snapshot) {
+    Finish(net::OK);
+    return;
+  }
+  snapshot_ = snapshot;
+  snapshot_->GetLastResponses(&responses_);
+  ImportNextResponse();
+}
+
+void HttpCacheSnapshot::ImportNextResponse() {
+  if (next_response_ == responses_.size()) {
+    Finish(net::OK);
+    return;
+  }
+  // The key net::HttpCache gives a GET.
+  const NetworkArchive::Entry* response = responses_[next_response_];
+  int rv = backend_->CreateEntry(
+      net::HttpUtil::SpecForRequest(response->url), &entry_,
+      base::Bind(&HttpCacheSnapshot::OnEntryCreated,
+                 weak_factory_.GetWeakPtr()));
+  if (rv != net::ERR_IO_PENDING)
+    OnEntryCreated(rv);
+}
+
+void HttpCacheSnapshot::OnEntryCreated(int rv) {
+  if (rv != net::OK) {
+    // The cache isn't handed the backend before the import is over, so the
+    // entry either already exists, the snapshot holding its URL twice, or
+    // failed to be created.
+    ++skipped_count_;
+    entry_ = NULL;
+    ++next_response_;
+    ImportNextResponse();
+    return;
+  }
+
+  // As if the response had just been received: the freshness and age of the
+  // entry are worked out from its headers from now on.
+  const NetworkArchive::Entry* response = responses_[next_response_];
+  net::HttpResponseInfo info;
+  info.request_time = base::Time::Now();
+  info.response_time = info.request_time;
+  info.headers = response->headers;
+  Pickle pickle;
+  info.Persist(&pickle, true /* skip_transient_headers */,
+               false /* response_truncated */);
+  scoped_refptr<net::StringIOBuffer> buffer(new net::StringIOBuffer(
+      std::string(static_cast<const char*>(pickle.data()), pickle.size())));
+  rv = entry_->WriteData(
+      kResponseInfoIndex, 0, buffer, buffer->size(),
+      base::Bind(&HttpCacheSnapshot::OnHeadersWritten,
+                 weak_factory_.GetWeakPtr(), buffer->size()),
+      true);
+  if (rv != net::ERR_IO_PENDING)
+    OnHeadersWritten(buffer->size(), rv);
+}
+
+void HttpCacheSnapshot::OnHeadersWritten(int expected, int rv) {
+  if (rv != expected) {
+    entry_->Doom();
+    CloseEntry();
+    return;
+  }
+  const NetworkArchive::Entry* response = responses_[next_response_];
+  scoped_refptr<net::StringIOBuffer> buffer(
+      new net::StringIOBuffer(response->body));
+  rv = entry_->WriteData(
+      kResponseContentIndex, 0, buffer, buffer->size(),
+      base::Bind(&HttpCacheSnapshot::OnBodyWritten,
+                 weak_factory_.GetWeakPtr(), buffer->size()),
+      true);
+  if (rv != net::ERR_IO_PENDING)
+    OnBodyWritten(buffer->size(), rv);
+}
+
+void HttpCacheSnapshot::OnBodyWritten(int expected, int rv) {
+  if (rv == expected)
+    ++imported_count_;
+  else
+    entry_->Doom();
+  CloseEntry();
+}
+
+void HttpCacheSnapshot::CloseEntry() {
+  entry_->Close();
+  entry_ = NULL;
+  ++next_response_;
+  ImportNextResponse();
+}
+
+void HttpCacheSnapshot::Finish(int rv) {
+  TRACE_EVENT_ASYNC_END2("cameo.startup", "HttpCacheSnapshot::CreateBackend",
+                         this, "imported", imported_count_,
+                         "skipped", skipped_count_);
+  if (imported_count_ > 0) {
+    VLOG(1) << "Imported " << imported_count_ << " responses from "
+            << snapshot_path_.value();
+  }
+  if (skipped_count_ > 0) {
+    LOG(WARNING) << "Skipped " << skipped_count_ << " responses of "
+                 << snapshot_path_.value()
+                 << " whose cache entry couldn't be created";
+  }
+  snapshot_ = NULL;
+  responses_.clear();
+
+  *backend_out_ = backend_;
+  backend_ = NULL;
+  // The cache deletes its backend factory once it has the backend.
+  net::CompletionCallback callback = callback_;
+  callback.Run(rv);
+}
+
+}  // namespace cameo
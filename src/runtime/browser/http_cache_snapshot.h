@@ -0,0 +1,93 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_HTTP_CACHE_SNAPSHOT_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_HTTP_CACHE_SNAPSHOT_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "cameo/src/runtime/browser/network_archive.h"
+#include "net/base/completion_callback.h"
+#include "net/http/http_cache.h"
+
+namespace disk_cache {
+class Backend;
+class Entry;
+}
+
+namespace cameo {
+
+// HttpCacheSnapshot is the backend factory of a disk cache which starts out
+// with the responses an app ships with, so that its first launch loads them
+// from disk instead of the network. A snapshot is a network archive holding
+// the last cacheable response to every GET of a session recorded with
+// --record-network, see Build() and cameo_cache_snapshot_builder.
+//
+// When the backend it creates is empty, the snapshot is written into it
+// before it is handed to the HttpCache, so the first requests already find
+// the entries. They are then ordinary entries: once stale they are
+// revalidated or fetched again, as their headers say. IO thread only.
+class HttpCacheSnapshot : public net::HttpCache::BackendFactory {
+ public:
+  // Writes the snapshot of the session recorded in the network archive at
+  // |archive_path| to |snapshot_path|. Returns how many responses it holds,
+  // or -1 on failure. Blocks on the files.
+  static int Build(const base::FilePath& archive_path,
+                   const base::FilePath& snapshot_path);
+
+  // Imports the snapshot at |snapshot_path| into the backends
+  // |backend_factory| creates. Takes ownership of |backend_factory|.
+  HttpCacheSnapshot(const base::FilePath& snapshot_path,
+                    net::HttpCache::BackendFactory* backend_factory);
+  virtual ~HttpCacheSnapshot();
+
+  // net::HttpCache::BackendFactory implementation.
+  virtual int CreateBackend(net::NetLog* net_log,
+                            disk_cache::Backend** backend,
+                            const net::CompletionCallback& callback) OVERRIDE;
+
+ private:
+  void OnBackendCreated(int rv);
+  void OnSnapshotLoaded(scoped_refptr<NetworkArchive> snapshot);
+
+  // Writes the responses one entry after the other.
+  void ImportNextResponse();
+  void OnEntryCreated(int rv);
+  void OnHeadersWritten(int expected, int rv);
+  void OnBodyWritten(int expected, int rv);
+  void CloseEntry();
+
+  // Hands the backend over to the cache.
+  void Finish(int rv);
+
+  base::FilePath snapshot_path_;
+  scoped_ptr<net::HttpCache::BackendFactory> backend_factory_;
+
+  // Owned until it is handed over, through |backend_out_|.
+  disk_cache::Backend* backend_;
+  disk_cache::Backend** backend_out_;
+  net::CompletionCallback callback_;
+
+  scoped_refptr<NetworkArchive> snapshot_;
+  std::vector<const NetworkArchive::Entry*> responses_;
+  size_t next_response_;
+  disk_cache::Entry* entry_;
+  int imported_count_;
+  // Responses whose entry couldn't be created.
+  int skipped_count_;
+
+  base::WeakPtrFactory<HttpCacheSnapshot> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpCacheSnapshot);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_HTTP_CACHE_SNAPSHOT_H_
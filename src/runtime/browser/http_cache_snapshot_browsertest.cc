@@ -0,0 +1,162 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/pickle.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/http_cache_snapshot.h"
+#include "cameo/src/runtime/browser/network_archive.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/content_browser_client.h"
+#include "googleurl/src/gurl.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_util.h"
+
+using cameo::NetworkArchive;
+using cameo::RuntimeURLRequestContextGetter;
+using content::BrowserThread;
+
+namespace {
+
+// The resources of the app, cacheable for a minute by the test server too.
+const int kResourceCount = 50;
+const char kSnapshotBody[] = "From the snapshot";
+
+scoped_refptr<net::HttpResponseHeaders> CreateHeaders(const char* headers) {
+  std::string raw_headers(headers);
+  return new net::HttpResponseHeaders(
+      net::HttpUtil::AssembleRawHeaders(raw_headers.data(),
+                                        raw_headers.size()));
+}
+
+void BuildContext(RuntimeURLRequestContextGetter* getter,
+                  const base::Closure& done) {
+  getter->GetURLRequestContext();
+  done.Run();
+}
+
+void RunClosure(const base::Closure& done) {
+  done.Run();
+}
+
+}  // namespace
+
+// Every launch is the first one of an app, on a new default partition.
+class HttpCacheSnapshotTest : public InProcessBrowserTest {
+ public:
+  GURL GetResourceURL(int i) {
+    return test_server()->GetURL(base::StringPrintf("cachetime?%d", i));
+  }
+
+  // Records what the app loads, as --record-network would have, with a
+  // body the test server doesn't send, and the snapshot of it.
+  void BuildSnapshot() {
+    Pickle archive;
+    NetworkArchive::WriteHeader(&archive);
+    for (int i = 0; i < kResourceCount; ++i) {
+      NetworkArchive::Entry entry;
+      entry.method = "GET";
+      entry.url = GetResourceURL(i);
+      entry.headers = CreateHeaders(
+          "HTTP/1.1 200 OK\nCache-Control: max-age=60\n"
+          "Content-Type: text/html\n");
+      entry.body = kSnapshotBody;
+      NetworkArchive::WriteEntry(entry, &archive);
+    }
+    // Not cacheable, left out of the snapshot.
+    NetworkArchive::Entry entry;
+    entry.method = "GET";
+    entry.url = test_server()->GetURL("nocache.html");
+    entry.headers = CreateHeaders(
+        "HTTP/1.1 200 OK\nCache-Control: no-store\n");
+    NetworkArchive::WriteEntry(entry, &archive);
+
+    base::FilePath archive_path = temp_dir_.path().AppendASCII("archive");
+    ASSERT_EQ(static_cast<int>(archive.size()),
+              file_util::WriteFile(archive_path,
+                                   static_cast<const char*>(archive.data()),
+                                   archive.size()));
+    snapshot_path_ = temp_dir_.path().AppendASCII("snapshot");
+    EXPECT_EQ(kResourceCount,
+              cameo::HttpCacheSnapshot::Build(archive_path, snapshot_path_));
+  }
+
+  scoped_refptr<RuntimeURLRequestContextGetter> Launch(
+      const base::FilePath& path) {
+    content::ProtocolHandlerMap protocol_handlers;
+    scoped_refptr<RuntimeURLRequestContextGetter> getter =
+        new RuntimeURLRequestContextGetter(
+            false,
+            path,
+            false,
+            NULL,
+            BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::IO),
+            BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::FILE),
+            &protocol_handlers);
+    cameo_test_utils::RunOnIOThreadAndWait(
+        base::Bind(&BuildContext, getter));
+    return getter;
+  }
+
+  void Shutdown(scoped_refptr<RuntimeURLRequestContextGetter>* getter) {
+    // The getter is deleted on the IO thread.
+    *getter = NULL;
+    cameo_test_utils::RunOnIOThreadAndWait(base::Bind(&RunClosure));
+  }
+
+  // Fetches the resources one after the other, and counts those which came
+  // from the snapshot.
+  base::TimeDelta LoadResources(RuntimeURLRequestContextGetter* getter,
+                                int* from_snapshot) {
+    *from_snapshot = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kResourceCount; ++i) {
+      if (cameo_test_utils::FetchURL(getter, GetResourceURL(i)) ==
+          kSnapshotBody)
+        ++*from_snapshot;
+    }
+    return base::TimeTicks::Now() - start;
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath snapshot_path_;
+};
+
+IN_PROC_BROWSER_TEST_F(HttpCacheSnapshotTest, FirstLaunchBenchmark) {
+  ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  ASSERT_TRUE(test_server()->Start());
+  BuildSnapshot();
+
+  int from_snapshot = 0;
+  scoped_refptr<RuntimeURLRequestContextGetter> getter =
+      Launch(temp_dir_.path().AppendASCII("cold"));
+  base::TimeDelta cold = LoadResources(getter, &from_snapshot);
+  EXPECT_EQ(0, from_snapshot);
+  Shutdown(&getter);
+
+  // Read when the cache of the next launch is created.
+  CommandLine::ForCurrentProcess()->AppendSwitchPath(
+      switches::kHttpCacheSnapshot, snapshot_path_);
+  getter = Launch(temp_dir_.path().AppendASCII("warm"));
+  base::TimeDelta warm = LoadResources(getter, &from_snapshot);
+  EXPECT_EQ(kResourceCount, from_snapshot);
+  Shutdown(&getter);
+
+  cameo_test_utils::PrintPerfResult("first_launch_resources", "cold",
+                                    cold.InMillisecondsF(), "ms");
+  cameo_test_utils::PrintPerfResult("first_launch_resources", "snapshot",
+                                    warm.InMillisecondsF(), "ms");
+}
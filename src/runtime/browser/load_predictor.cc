@@ -0,0 +1,386 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/load_predictor.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/stl_util.h"
+#include "base/string_number_conversions.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/base/io_buffer.h"
+#include "net/base/request_priority.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_status.h"
+#include "webkit/glue/resource_type.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// Bumped when the format changes, the table of other versions is dropped.
+const int kVersion = 1;
+
+// Subresource requests issued within this delay after the main frame one
+// are considered part of the page.
+const int kLearningWindowInSeconds = 10;
+
+// Bounds of the table.
+const size_t kMaxPages = 20;
+const size_t kMaxResourcesPerPage = 100;
+// Past this many loads of a page the counts are halved, so that what the
+// page stopped using fades away.
+const int kMaxLoads = 10;
+
+// Budget of a page load.
+const size_t kMaxPrefetches = 64;
+const int64 kMaxPrefetchBytes = 8 * 1024 * 1024;
+
+const int kReadBufferSize = 32 * 1024;
+
+void ReadTable(const base::FilePath& path, std::string* data) {
+  // There is nothing to read on the first launch.
+  file_util::ReadFileToString(path, data);
+}
+
+bool IsPrefetchable(const GURL& url) {
+  return url.is_valid() && url.SchemeIsHTTPOrHTTPS();
+}
+
+GURL StripRef(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements);
+}
+
+}  // namespace
+
+LoadPredictor::Stats::Stats()
+    : prefetched(0),
+      used(0) {
+}
+
+LoadPredictor::Resource::Resource()
+    : hits(0),
+      position(0) {
+}
+
+LoadPredictor::Page::Page()
+    : loads(0) {
+}
+
+LoadPredictor::LoadPredictor(const base::FilePath& path,
+                             net::URLRequestContext* context)
+    : context_(context),
+      loaded_(false),
+      writer_(path, BrowserThread::GetMessageLoopProxyForThread(
+          BrowserThread::FILE)),
+      prefetched_bytes_(0),
+      weak_factory_(this) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  std::string* data = new std::string;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&ReadTable, path, data),
+      base::Bind(&LoadPredictor::OnLoaded, weak_factory_.GetWeakPtr(),
+                 base::Owned(data)));
+}
+
+LoadPredictor::~LoadPredictor() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  CancelPrefetches();
+  for (std::map<ViewId, Navigation>::const_iterator it = navigations_.begin();
+       it != navigations_.end(); ++it)
+    FinishNavigation(it->second);
+  if (writer_.HasPendingWrite())
+    writer_.DoScheduledWrite();
+}
+
+void LoadPredictor::LearnFromRequest(const net::URLRequest& request) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  // The requests of the other storage partitions don't go to the cache
+  // prefetched into.
+  const content::ResourceRequestInfo* info =
+      content::ResourceRequestInfo::ForRequest(&request);
+  if (!info || request.context() != context_)
+    return;
+  ViewId view;
+  if (!info->GetAssociatedRenderView(&view.first, &view.second))
+    return;
+
+  GURL url = StripRef(request.url());
+  std::map<ViewId, Navigation>::iterator it = navigations_.find(view);
+  if (info->GetResourceType() == ResourceType::MAIN_FRAME) {
+    if (it != navigations_.end()) {
+      FinishNavigation(it->second);
+      navigations_.erase(it);
+    }
+    if (!IsPrefetchable(url))
+      return;
+    Navigation& navigation = navigations_[view];
+    navigation.page_url = url;
+    navigation.start = base::TimeTicks::Now();
+    return;
+  }
+
+  if (it == navigations_.end())
+    return;
+  Navigation& navigation = it->second;
+  if (base::TimeTicks::Now() - navigation.start >
+      base::TimeDelta::FromSeconds(kLearningWindowInSeconds)) {
+    FinishNavigation(navigation);
+    navigations_.erase(it);
+    return;
+  }
+  if (request.method() != "GET" || !IsPrefetchable(url))
+    return;
+  if (unused_prefetches_.erase(url))
+    ++stats_.used;
+  if (std::find(navigation.resources.begin(), navigation.resources.end(),
+                url) == navigation.resources.end())
+    navigation.resources.push_back(url);
+}
+
+void LoadPredictor::Prefetch(const GURL& page_url) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  std::vector<GURL> predicted = GetPredictedResources(page_url);
+  if (predicted.empty())
+    return;
+
+  // What is left of the previous page load isn't worth finishing.
+  CancelPrefetches();
+  unused_prefetches_.clear();
+  prefetched_bytes_ = 0;
+  for (size_t i = 0; i < predicted.size() && i < kMaxPrefetches; ++i) {
+    net::URLRequest* request = context_->CreateRequest(predicted[i], this);
+    request->set_referrer(page_url.spec());
+    request->SetPriority(net::LOWEST);
+    prefetches_[request] = new net::IOBuffer(kReadBufferSize);
+    unused_prefetches_.insert(predicted[i]);
+    ++stats_.prefetched;
+    request->Start();
+  }
+}
+
+std::vector<GURL> LoadPredictor::GetPredictedResources(
+    const GURL& page_url) const {
+  std::vector<GURL> urls;
+  std::map<GURL, Page>::const_iterator it = pages_.find(StripRef(page_url));
+  if (it == pages_.end())
+    return urls;
+  const Page& page = it->second;
+
+  // The resources most loads of the page used, in the order they were
+  // requested.
+  std::vector<std::pair<int, GURL> > predicted;
+  for (size_t i = 0; i < page.resources.size(); ++i) {
+    const Resource& resource = page.resources[i];
+    if (resource.hits * 2 >= page.loads)
+      predicted.push_back(std::make_pair(resource.position, resource.url));
+  }
+  std::sort(predicted.begin(), predicted.end());
+  for (size_t i = 0; i < predicted.size(); ++i)
+    urls.push_back(predicted[i].second);
+  return urls;
+}
+
+void LoadPredictor::OnResponseStarted(net::URLRequest* request) {
+  if (!request->status().is_success()) {
+    FinishPrefetch(request);
+    return;
+  }
+  ReadBody(request);
+}
+
+void LoadPredictor::OnReadCompleted(net::URLRequest* request,
+                                    int bytes_read) {
+  if (bytes_read <= 0) {
+    FinishPrefetch(request);
+    return;
+  }
+  prefetched_bytes_ += bytes_read;
+  if (prefetched_bytes_ > kMaxPrefetchBytes) {
+    CancelPrefetches();
+    return;
+  }
+  ReadBody(request);
+}
+
+bool LoadPredictor::SerializeData(std::string* data) {
+  base::ListValue* pages = new base::ListValue;
+  for (std::map<GURL, Page>::const_iterator it = pages_.begin();
+       it != pages_.end(); ++it) {
+    base::ListValue* resources = new base::ListValue;
+    for (size_t i = 0; i < it->second.resources.size(); ++i) {
+      const Resource& resource = it->second.resources[i];
+      base::DictionaryValue* resource_value = new base::DictionaryValue;
+      resource_value->SetString("url", resource.url.spec());
+      resource_value->SetInteger("hits", resource.hits);
+      resource_value->SetInteger("position", resource.position);
+      resources->Append(resource_value);
+    }
+    base::DictionaryValue* page = new base::DictionaryValue;
+    page->SetString("url", it->first.spec());
+    page->SetInteger("loads", it->second.loads);
+    page->SetString("last_load", base::Int64ToString(
+        it->second.last_load.ToInternalValue()));
+    page->Set("resources", resources);
+    pages->Append(page);
+  }
+
+  base::DictionaryValue table;
+  table.SetInteger("version", kVersion);
+  table.Set("pages", pages);
+  base::JSONWriter::Write(&table, data);
+  return true;
+}
+
+void LoadPredictor::OnLoaded(const std::string* data) {
+  loaded_ = true;
+  // What was learned meanwhile would be lost otherwise.
+  if (!pages_.empty())
+    writer_.ScheduleWrite(this);
+  if (data->empty())
+    return;
+
+  scoped_ptr<base::Value> value(base::JSONReader::Read(*data));
+  base::DictionaryValue* table = NULL;
+  base::ListValue* pages = NULL;
+  int version = 0;
+  if (!value || !value->GetAsDictionary(&table) ||
+      !table->GetInteger("version", &version) || version != kVersion ||
+      !table->GetList("pages", &pages)) {
+    LOG(WARNING) << "Ignoring the load predictions of the previous sessions.";
+    return;
+  }
+
+  for (size_t i = 0; i < pages->GetSize(); ++i) {
+    base::DictionaryValue* page_value = NULL;
+    std::string url;
+    std::string last_load;
+    int64 last_load_value = 0;
+    base::ListValue* resources = NULL;
+    Page page;
+    if (!pages->GetDictionary(i, &page_value) ||
+        !page_value->GetString("url", &url) ||
+        !page_value->GetInteger("loads", &page.loads) ||
+        !page_value->GetString("last_load", &last_load) ||
+        !base::StringToInt64(last_load, &last_load_value) ||
+        !page_value->GetList("resources", &resources) ||
+        pages_.count(GURL(url)))
+      continue;
+    page.last_load = base::Time::FromInternalValue(last_load_value);
+    for (size_t j = 0; j < resources->GetSize(); ++j) {
+      base::DictionaryValue* resource_value = NULL;
+      std::string resource_url;
+      Resource resource;
+      if (resources->GetDictionary(j, &resource_value) &&
+          resource_value->GetString("url", &resource_url) &&
+          resource_value->GetInteger("hits", &resource.hits) &&
+          resource_value->GetInteger("position", &resource.position)) {
+        resource.url = GURL(resource_url);
+        page.resources.push_back(resource);
+      }
+    }
+    pages_[GURL(url)] = page;
+  }
+}
+
+void LoadPredictor::FinishNavigation(const Navigation& navigation) {
+  Page& page = pages_[navigation.page_url];
+  page.last_load = base::Time::Now();
+  ++page.loads;
+  for (size_t i = 0; i < navigation.resources.size(); ++i) {
+    Resource* resource = NULL;
+    for (size_t j = 0; j < page.resources.size() && !resource; ++j) {
+      if (page.resources[j].url == navigation.resources[i])
+        resource = &page.resources[j];
+    }
+    if (!resource) {
+      page.resources.push_back(Resource());
+      resource = &page.resources.back();
+      resource->url = navigation.resources[i];
+    }
+    ++resource->hits;
+    resource->position = static_cast<int>(i);
+  }
+
+  // Halving the counts of this load too keeps a resource every load used at
+  // as many hits as there are loads.
+  if (page.loads > kMaxLoads) {
+    page.loads /= 2;
+    for (size_t i = 0; i < page.resources.size(); ++i)
+      page.resources[i].hits /= 2;
+  }
+
+  // Keep the resources most used, in the order they were first seen among
+  // those used as much.
+  std::stable_sort(page.resources.begin(), page.resources.end(),
+                   &LoadPredictor::HasMoreHits);
+  // What the halving took down to no hits is forgotten.
+  while (!page.resources.empty() && !page.resources.back().hits)
+    page.resources.pop_back();
+  if (page.resources.size() > kMaxResourcesPerPage)
+    page.resources.resize(kMaxResourcesPerPage);
+
+  // Keep the pages most recently loaded.
+  if (pages_.size() > kMaxPages) {
+    std::map<GURL, Page>::iterator oldest = pages_.begin();
+    for (std::map<GURL, Page>::iterator it = pages_.begin();
+         it != pages_.end(); ++it) {
+      if (it->second.last_load < oldest->second.last_load)
+        oldest = it;
+    }
+    pages_.erase(oldest);
+  }
+
+  // Writing before the table is read would drop the previous sessions.
+  if (loaded_)
+    writer_.ScheduleWrite(this);
+}
+
+// static
+bool LoadPredictor::HasMoreHits(const Resource& a, const Resource& b) {
+  return a.hits > b.hits;
+}
+
+void LoadPredictor::ReadBody(net::URLRequest* request) {
+  scoped_refptr<net::IOBuffer> buffer = prefetches_[request];
+  int bytes_read = 0;
+  while (request->Read(buffer, kReadBufferSize, &bytes_read)) {
+    if (bytes_read <= 0) {
+      FinishPrefetch(request);
+      return;
+    }
+    prefetched_bytes_ += bytes_read;
+    if (prefetched_bytes_ > kMaxPrefetchBytes) {
+      CancelPrefetches();
+      return;
+    }
+  }
+  if (!request->status().is_io_pending())
+    FinishPrefetch(request);
+}
+
+void LoadPredictor::FinishPrefetch(net::URLRequest* request) {
+  prefetches_.erase(request);
+  delete request;
+}
+
+void LoadPredictor::CancelPrefetches() {
+  STLDeleteContainerPairFirstPointers(prefetches_.begin(), prefetches_.end());
+  prefetches_.clear();
+}
+
+}  // namespace cameo
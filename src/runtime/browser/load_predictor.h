@@ -0,0 +1,143 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_LOAD_PREDICTOR_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_LOAD_PREDICTOR_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "googleurl/src/gurl.h"
+#include "net/url_request/url_request.h"
+
+namespace net {
+class IOBuffer;
+class URLRequestContext;
+}
+
+namespace cameo {
+
+// LoadPredictor learns which subresources the pages of the app load, and in
+// what order, and fetches them into the HTTP cache when a page is loaded
+// again, in parallel with its document instead of one after the other as the
+// renderer discovers them.
+//
+// The subresources a render view requests within a while after its main
+// frame request are recorded for the URL of the main frame. The table of
+// what every page loaded is kept in a file, written a while after it
+// changes. Only the resources most loads of a page used are prefetched,
+// within a budget of requests and bytes. Only lives on the IO thread, on
+// the request context of the default storage partition.
+class LoadPredictor : public net::URLRequest::Delegate,
+                      public base::ImportantFileWriter::DataSerializer {
+ public:
+  struct Stats {
+    Stats();
+
+    // Prefetches started, and those the renderer then requested.
+    int prefetched;
+    int used;
+  };
+
+  // |context| must outlive the predictor.
+  LoadPredictor(const base::FilePath& path, net::URLRequestContext* context);
+  virtual ~LoadPredictor();
+
+  // Records |request| if it is a main frame request or a subresource
+  // request following one. Called by the network delegate.
+  void LearnFromRequest(const net::URLRequest& request);
+
+  // Starts fetching the subresources predicted for the page at |page_url|,
+  // which is about to be loaded.
+  void Prefetch(const GURL& page_url);
+
+  // The subresources Prefetch() would fetch for the page at |page_url|, in
+  // the order the page requested them, before the budget is applied.
+  std::vector<GURL> GetPredictedResources(const GURL& page_url) const;
+
+  const Stats& stats() const { return stats_; }
+
+  // net::URLRequest::Delegate implementation.
+  virtual void OnResponseStarted(net::URLRequest* request) OVERRIDE;
+  virtual void OnReadCompleted(net::URLRequest* request,
+                               int bytes_read) OVERRIDE;
+
+  // base::ImportantFileWriter::DataSerializer implementation.
+  virtual bool SerializeData(std::string* data) OVERRIDE;
+
+ private:
+  // A render process id and render view id.
+  typedef std::pair<int, int> ViewId;
+
+  struct Resource {
+    Resource();
+
+    GURL url;
+    // How many loads of the page requested it.
+    int hits;
+    // Its rank among the requests of the last load which requested it.
+    int position;
+  };
+
+  struct Page {
+    Page();
+
+    int loads;
+    base::Time last_load;
+    std::vector<Resource> resources;
+  };
+
+  // A main frame load being recorded.
+  struct Navigation {
+    GURL page_url;
+    base::TimeTicks start;
+    std::vector<GURL> resources;
+  };
+
+  static bool HasMoreHits(const Resource& a, const Resource& b);
+
+  void OnLoaded(const std::string* data);
+
+  // Adds |navigation| to the table.
+  void FinishNavigation(const Navigation& navigation);
+
+  void ReadBody(net::URLRequest* request);
+  void FinishPrefetch(net::URLRequest* request);
+  void CancelPrefetches();
+
+  net::URLRequestContext* context_;
+  std::map<GURL, Page> pages_;
+  std::map<ViewId, Navigation> navigations_;
+  // Whether the table of the previous sessions has been read.
+  bool loaded_;
+  base::ImportantFileWriter writer_;
+
+  // The prefetches in flight, owned, with the buffers their bodies are read
+  // into only to go into the cache. Each request has its own buffer, the
+  // cache writes the data from it asynchronously.
+  std::map<net::URLRequest*, scoped_refptr<net::IOBuffer> > prefetches_;
+  // The bytes the prefetches have read.
+  int64 prefetched_bytes_;
+  // The URLs prefetched which haven't been requested yet.
+  std::set<GURL> unused_prefetches_;
+  Stats stats_;
+
+  base::WeakPtrFactory<LoadPredictor> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadPredictor);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_LOAD_PREDICTOR_H_
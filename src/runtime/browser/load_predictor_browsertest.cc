@@ -0,0 +1,137 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/load_predictor.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_network_delegate.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/runtime/browser/tiered_http_cache.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/escape.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/http/http_cache.h"
+
+using cameo::LoadPredictor;
+using cameo::RuntimeURLRequestContextGetter;
+
+namespace {
+
+// The page loads kResourceCount resources one after the other, each of them
+// a round trip of the emulated latency away.
+const int kResourceCount = 40;
+const char kLatency[] = "latency=50";
+
+// Dooms every entry of the HTTP cache of the default partition, so that the
+// next load of the page goes to the network again.
+class CacheClearer {
+ public:
+  static void Clear(RuntimeURLRequestContextGetter* getter,
+                    const base::Closure& done) {
+    CacheClearer* clearer = new CacheClearer(done);
+    int rv = getter->http_cache()->GetCache()->GetBackend(
+        &clearer->backend_,
+        base::Bind(&CacheClearer::OnBackendReady, base::Unretained(clearer)));
+    if (rv != net::ERR_IO_PENDING)
+      clearer->OnBackendReady(rv);
+  }
+
+ private:
+  explicit CacheClearer(const base::Closure& done)
+      : backend_(NULL),
+        done_(done) {
+  }
+
+  void OnBackendReady(int rv) {
+    if (rv == net::OK) {
+      rv = backend_->DoomAllEntries(
+          base::Bind(&CacheClearer::OnCleared, base::Unretained(this)));
+    }
+    if (rv != net::ERR_IO_PENDING)
+      OnCleared(rv);
+  }
+
+  void OnCleared(int rv) {
+    done_.Run();
+    delete this;
+  }
+
+  disk_cache::Backend* backend_;
+  base::Closure done_;
+};
+
+void GetStats(RuntimeURLRequestContextGetter* getter,
+              LoadPredictor::Stats* stats,
+              const base::Closure& done) {
+  *stats = getter->network_delegate()->load_predictor()->stats();
+  done.Run();
+}
+
+}  // namespace
+
+class LoadPredictorTest : public InProcessBrowserTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    command_line->AppendSwitchASCII(switches::kEmulateNetwork, kLatency);
+  }
+
+  // Loads the page and waits until it has loaded all its resources.
+  base::TimeDelta LoadPage(const GURL& url) {
+    string16 expected_title = ASCIIToUTF16("loaded");
+    content::TitleWatcher title_watcher(runtime()->web_contents(),
+                                        expected_title);
+    base::TimeTicks start = base::TimeTicks::Now();
+    runtime()->LoadURL(url);
+    EXPECT_EQ(expected_title, title_watcher.WaitAndGetTitle());
+    return base::TimeTicks::Now() - start;
+  }
+
+  RuntimeURLRequestContextGetter* getter() {
+    return runtime()->runtime_context()->url_request_context_getter();
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(LoadPredictorTest, PrefetchBenchmark) {
+  ASSERT_TRUE(test_server()->Start());
+  std::string server = net::EscapeQueryParamValue(
+      test_server()->GetURL(std::string()).spec(), true);
+  GURL page_url = test_server()->GetURL(base::StringPrintf(
+      "prefetch.html?server=%s&count=%d", server.c_str(), kResourceCount));
+
+  base::TimeDelta learning = LoadPage(page_url);
+  // The next main frame request ends the recording of the page.
+  cameo_test_utils::NavigateToURL(runtime(),
+                                  test_server()->GetURL("title.html"));
+  cameo_test_utils::RunOnIOThreadAndWait(
+      base::Bind(&CacheClearer::Clear, getter()));
+
+  base::TimeDelta prefetched = LoadPage(page_url);
+  LoadPredictor::Stats stats;
+  cameo_test_utils::RunOnIOThreadAndWait(
+      base::Bind(&GetStats, getter(), &stats));
+  EXPECT_EQ(kResourceCount, stats.prefetched);
+  EXPECT_EQ(kResourceCount, stats.used);
+  EXPECT_LT(prefetched, learning);
+
+  cameo_test_utils::PrintPerfResult("predicted_load", "learning",
+                                    learning.InMillisecondsF(), "ms");
+  cameo_test_utils::PrintPerfResult("predicted_load", "prefetched",
+                                    prefetched.InMillisecondsF(), "ms");
+  cameo_test_utils::PrintPerfResult(
+      "prefetch_hit_rate", "predicted_load",
+      stats.prefetched ? 100.0 * stats.used / stats.prefetched : 0, "%");
+}
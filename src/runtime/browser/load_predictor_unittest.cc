@@ -0,0 +1,114 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/load_predictor.h"
+
+#include <vector>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/run_loop.h"
+#include "content/public/browser/resource_request_info.h"
+#include "content/public/test/test_browser_thread.h"
+#include "googleurl/src/gurl.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/glue/resource_type.h"
+
+using cameo::LoadPredictor;
+using content::BrowserThread;
+
+namespace {
+
+const int kRenderProcessId = 1;
+const int kRenderViewId = 1;
+
+// Many times the number of loads past which the counts are halved.
+const int kLoadCount = 50;
+
+class LoadPredictorTest : public testing::Test {
+ public:
+  LoadPredictorTest()
+      : message_loop_(base::MessageLoop::TYPE_IO),
+        io_thread_(BrowserThread::IO, &message_loop_),
+        file_thread_(BrowserThread::FILE, &message_loop_) {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    predictor_.reset(new LoadPredictor(
+        temp_dir_.path().AppendASCII("Load Predictor"), &context_));
+    // Lets it find there is no table of previous sessions.
+    base::RunLoop().RunUntilIdle();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    predictor_.reset();
+    base::RunLoop().RunUntilIdle();
+  }
+
+  // Shows the predictor a request of the render view for |url|. The
+  // requests are never started.
+  void SeeRequest(const GURL& url, ResourceType::Type resource_type) {
+    scoped_ptr<net::URLRequest> request(
+        context_.CreateRequest(url, &delegate_));
+    content::ResourceRequestInfo::AllocateForTesting(
+        request.get(), resource_type, NULL, kRenderProcessId, kRenderViewId);
+    predictor_->LearnFromRequest(*request);
+  }
+
+  // Loads |page_url| and its |resources|. The load is added to the table
+  // when the next one starts.
+  void Load(const GURL& page_url, const std::vector<GURL>& resources) {
+    SeeRequest(page_url, ResourceType::MAIN_FRAME);
+    for (size_t i = 0; i < resources.size(); ++i)
+      SeeRequest(resources[i], ResourceType::SUB_RESOURCE);
+  }
+
+ protected:
+  base::MessageLoop message_loop_;
+  content::TestBrowserThread io_thread_;
+  content::TestBrowserThread file_thread_;
+  base::ScopedTempDir temp_dir_;
+  net::TestURLRequestContext context_;
+  net::TestDelegate delegate_;
+  scoped_ptr<LoadPredictor> predictor_;
+};
+
+}  // namespace
+
+TEST_F(LoadPredictorTest, KeepsResourcesAcrossHalvings) {
+  GURL page_url("http://example.com/app.html");
+  GURL other_page_url("http://example.com/other.html");
+  std::vector<GURL> core;
+  core.push_back(GURL("http://example.com/app.js"));
+  core.push_back(GURL("http://example.com/app.css"));
+
+  for (int i = 0; i < kLoadCount; ++i) {
+    Load(page_url, core);
+    Load(other_page_url, std::vector<GURL>());
+    EXPECT_EQ(core, predictor_->GetPredictedResources(page_url))
+        << "after " << i + 1 << " loads";
+  }
+}
+
+TEST_F(LoadPredictorTest, PredictsInRequestOrder) {
+  GURL page_url("http://example.com/app.html#start");
+  std::vector<GURL> resources;
+  resources.push_back(GURL("http://example.com/b.js"));
+  resources.push_back(GURL("http://example.com/a.js"));
+  // Not prefetchable.
+  resources.push_back(GURL("data:text/plain,x"));
+  Load(page_url, resources);
+  EXPECT_TRUE(predictor_->GetPredictedResources(page_url).empty());
+
+  Load(GURL("http://example.com/other.html"), std::vector<GURL>());
+  std::vector<GURL> predicted =
+      predictor_->GetPredictedResources(GURL("http://example.com/app.html"));
+  ASSERT_EQ(2u, predicted.size());
+  EXPECT_EQ(resources[0], predicted[0]);
+  EXPECT_EQ(resources[1], predicted[1]);
+}
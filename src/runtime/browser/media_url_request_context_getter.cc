@@ -0,0 +1,96 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/media_url_request_context_getter.h"
+
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/string_number_conversions.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/http/http_cache.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_context_storage.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// Maximum size of the media cache in bytes, 0 lets the backend pick it.
+int GetMediaCacheSize() {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  int size = 0;
+  if (command_line.HasSwitch(switches::kMediaCacheSize) &&
+      (!base::StringToInt(
+           command_line.GetSwitchValueASCII(switches::kMediaCacheSize),
+           &size) ||
+       size < 0)) {
+    LOG(WARNING) << "Invalid --" << switches::kMediaCacheSize
+                 << ", using the default size.";
+    size = 0;
+  }
+  return size;
+}
+
+}  // namespace
+
+MediaURLRequestContextGetter::MediaURLRequestContextGetter(
+    RuntimeURLRequestContextGetter* main_getter,
+    const base::FilePath& base_path,
+    bool in_memory)
+    : main_getter_(main_getter),
+      base_path_(base_path),
+      in_memory_(in_memory),
+      http_cache_(NULL) {
+}
+
+MediaURLRequestContextGetter::~MediaURLRequestContextGetter() {
+}
+
+net::URLRequestContext* MediaURLRequestContextGetter::GetURLRequestContext() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  if (!url_request_context_) {
+    net::URLRequestContext* main_context =
+        main_getter_->GetURLRequestContext();
+
+    url_request_context_.reset(new net::URLRequestContext());
+    url_request_context_->CopyFrom(main_context);
+    storage_.reset(
+        new net::URLRequestContextStorage(url_request_context_.get()));
+
+    int max_bytes = GetMediaCacheSize();
+    net::HttpCache::BackendFactory* backend = NULL;
+    if (in_memory_) {
+      backend = net::HttpCache::DefaultBackend::InMemory(max_bytes);
+    } else {
+      backend = new net::HttpCache::DefaultBackend(
+          net::MEDIA_CACHE,
+          base_path_.Append(FILE_PATH_LITERAL("Media Cache")),
+          max_bytes,
+          BrowserThread::GetMessageLoopProxyForThread(BrowserThread::CACHE));
+    }
+    http_cache_ = new net::HttpCache(
+        main_getter_->CreateNetworkLayer(
+            main_context->http_transaction_factory()->GetSession()),
+        NULL,
+        backend);
+    storage_->set_http_transaction_factory(
+        main_getter_->network_emulator()->WrapTransactionFactory(
+            http_cache_));
+  }
+
+  return url_request_context_.get();
+}
+
+scoped_refptr<base::SingleThreadTaskRunner>
+    MediaURLRequestContextGetter::GetNetworkTaskRunner() const {
+  return BrowserThread::GetMessageLoopProxyForThread(BrowserThread::IO);
+}
+
+}  // namespace cameo
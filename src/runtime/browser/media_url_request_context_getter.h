@@ -0,0 +1,62 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_MEDIA_URL_REQUEST_CONTEXT_GETTER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_MEDIA_URL_REQUEST_CONTEXT_GETTER_H_
+
+#include "base/compiler_specific.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/url_request/url_request_context_getter.h"
+
+namespace net {
+class HttpCache;
+class URLRequestContextStorage;
+}
+
+namespace cameo {
+
+class RuntimeURLRequestContextGetter;
+
+// The request context of the media of a storage partition. It is the request
+// context of the partition, except for its HTTP cache: the media have a
+// backend of their own, so streaming a long video evicts other media rather
+// than the pages and scripts of the app. The backend is a media cache, which
+// keeps the byte ranges of a resource as a sparse entry, so seeking back
+// into a range already fetched doesn't go to the network again. The cache
+// sits on the network session of the partition.
+class MediaURLRequestContextGetter : public net::URLRequestContextGetter {
+ public:
+  // The cache is kept in |base_path|, or in memory if |in_memory| is true.
+  MediaURLRequestContextGetter(RuntimeURLRequestContextGetter* main_getter,
+                               const base::FilePath& base_path,
+                               bool in_memory);
+  virtual ~MediaURLRequestContextGetter();
+
+  // net::URLRequestContextGetter implementation.
+  virtual net::URLRequestContext* GetURLRequestContext() OVERRIDE;
+  virtual scoped_refptr<base::SingleThreadTaskRunner>
+      GetNetworkTaskRunner() const OVERRIDE;
+
+  // Only valid on the IO thread once the context has been built.
+  net::HttpCache* http_cache() const { return http_cache_; }
+
+ private:
+  scoped_refptr<RuntimeURLRequestContextGetter> main_getter_;
+  base::FilePath base_path_;
+  bool in_memory_;
+
+  scoped_ptr<net::URLRequestContextStorage> storage_;
+  scoped_ptr<net::URLRequestContext> url_request_context_;
+
+  // Owned by |storage_|.
+  net::HttpCache* http_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(MediaURLRequestContextGetter);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_MEDIA_URL_REQUEST_CONTEXT_GETTER_H_
@@ -0,0 +1,125 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/stringprintf.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/http/http_cache.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_context_getter.h"
+
+namespace {
+
+const int kMediaUrlCount = 10;
+
+struct EntryCount {
+  EntryCount() : backend(NULL), count(-1) {}
+
+  disk_cache::Backend* backend;
+  int count;
+};
+
+void OnBackendReady(EntryCount* entries, const base::Closure& done, int rv) {
+  EXPECT_EQ(net::OK, rv);
+  if (entries->backend)
+    entries->count = entries->backend->GetEntryCount();
+  done.Run();
+}
+
+void CountEntries(net::URLRequestContextGetter* getter,
+                  EntryCount* entries,
+                  const base::Closure& done) {
+  net::HttpCache* cache = getter->GetURLRequestContext()->
+      http_transaction_factory()->GetCache();
+  int rv = cache->GetBackend(&entries->backend,
+                             base::Bind(&OnBackendReady, entries, done));
+  if (rv != net::ERR_IO_PENDING)
+    OnBackendReady(entries, done, rv);
+}
+
+void GetSessions(net::URLRequestContextGetter* main_getter,
+                 net::URLRequestContextGetter* media_getter,
+                 bool* same_session,
+                 const base::Closure& done) {
+  *same_session =
+      main_getter->GetURLRequestContext()->http_transaction_factory()->
+          GetSession() ==
+      media_getter->GetURLRequestContext()->http_transaction_factory()->
+          GetSession();
+  done.Run();
+}
+
+}  // namespace
+
+class MediaURLRequestContextGetterTest : public InProcessBrowserTest {
+ public:
+  int GetEntryCount(net::URLRequestContextGetter* getter) {
+    EntryCount entries;
+    cameo_test_utils::RunOnIOThreadAndWait(
+        base::Bind(&CountEntries, getter, &entries));
+    return entries.count;
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(MediaURLRequestContextGetterTest, SeparateCache) {
+  ASSERT_TRUE(test_server()->Start());
+  cameo::RuntimeContext* runtime_context = runtime()->runtime_context();
+  net::URLRequestContextGetter* main_getter =
+      runtime_context->GetRequestContext();
+  net::URLRequestContextGetter* media_getter =
+      runtime_context->GetMediaRequestContext();
+  ASSERT_NE(main_getter, media_getter);
+  EXPECT_EQ(media_getter, runtime_context->GetMediaRequestContext());
+
+  bool same_session = false;
+  cameo_test_utils::RunOnIOThreadAndWait(
+      base::Bind(&GetSessions, main_getter, media_getter, &same_session));
+  EXPECT_TRUE(same_session);
+
+  int main_entries = GetEntryCount(main_getter);
+  int media_entries = GetEntryCount(media_getter);
+  for (int i = 0; i < kMediaUrlCount; ++i) {
+    // The /cachetime handler answers with max-age=60 whatever the query.
+    cameo_test_utils::FetchURL(
+        media_getter,
+        test_server()->GetURL(base::StringPrintf("cachetime?media%d", i)));
+  }
+
+  // The media went to their own cache only.
+  EXPECT_EQ(main_entries, GetEntryCount(main_getter));
+  EXPECT_EQ(media_entries + kMediaUrlCount, GetEntryCount(media_getter));
+}
+
+// Seeking back into a range already played is served from the sparse entry
+// of the media cache.
+IN_PROC_BROWSER_TEST_F(MediaURLRequestContextGetterTest, ReusesRanges) {
+  ASSERT_TRUE(test_server()->Start());
+  net::URLRequestContextGetter* media_getter =
+      runtime()->runtime_context()->GetMediaRequestContext();
+  // Its mock headers make the test server answer with the first 100 bytes
+  // of a resource of 1000 bytes, cacheable for an hour.
+  GURL url = test_server()->GetURL("files/media_range.dat");
+  std::string data;
+  for (int i = 0; i < 10; ++i)
+    data += "0123456789";
+
+  std::string body;
+  EXPECT_EQ(206, cameo_test_utils::FetchURLWithHeaders(
+      media_getter, url, "Range: bytes=0-99", &body));
+  EXPECT_EQ(data, body);
+
+  // Nothing can come from the network any more.
+  ASSERT_TRUE(test_server()->Stop());
+  EXPECT_EQ(206, cameo_test_utils::FetchURLWithHeaders(
+      media_getter, url, "Range: bytes=20-59", &body));
+  EXPECT_EQ(data.substr(20, 40), body);
+}
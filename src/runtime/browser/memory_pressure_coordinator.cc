@@ -0,0 +1,359 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/memory_pressure_coordinator.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process_util.h"
+#include "base/string_number_conversions.h"
+#include "base/string_util.h"
+#include "base/strings/string_split.h"
+#include "base/task_runner_util.h"
+#include "base/threading/thread_restrictions.h"
+#include "cameo/src/runtime/browser/background_throttler.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/web_contents.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// The thresholds --memory-pressure starts from.
+const int kDefaultModeratePercent = 15;
+const int kDefaultCriticalPercent = 5;
+const int kDefaultIntervalSeconds = 5;
+
+// The working set of the render process of |runtime|, which it may share
+// with other Runtimes, 0 if it has none, e.g. once hibernated.
+int64 GetRendererWorkingSet(Runtime* runtime) {
+  if (runtime->is_hibernated())
+    return 0;
+  content::RenderProcessHost* render_process_host =
+      runtime->web_contents()->GetRenderProcessHost();
+  base::ProcessHandle handle = render_process_host ?
+      render_process_host->GetHandle() : base::kNullProcessHandle;
+  if (handle == base::kNullProcessHandle)
+    return 0;
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(handle));
+  // A read of /proc/<pid>/statm on Linux, only when a step is taken.
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  return metrics->GetWorkingSetSize();
+}
+
+#if defined(OS_LINUX)
+const char kMeminfoPath[] = "/proc/meminfo";
+const char kProcessCgroupPath[] = "/proc/self/cgroup";
+const char kMemoryCgroupRoot[] = "/sys/fs/cgroup/memory";
+
+// Returns the value of the field |name| of |meminfo|, the contents of
+// /proc/meminfo, in bytes, or -1 if it is missing.
+int64 GetMeminfoValue(const std::string& meminfo, const std::string& name) {
+  std::vector<std::string> lines;
+  base::SplitString(meminfo, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    size_t colon = lines[i].find(':');
+    if (colon == std::string::npos || lines[i].compare(0, colon, name) != 0)
+      continue;
+    // e.g. "MemTotal:        8070604 kB".
+    std::vector<std::string> tokens;
+    base::SplitStringAlongWhitespace(lines[i].substr(colon + 1), &tokens);
+    int64 value = 0;
+    if (tokens.empty() || !base::StringToInt64(tokens[0], &value))
+      return -1;
+    if (tokens.size() > 1 && tokens[1] == "kB")
+      value *= 1024;
+    return value;
+  }
+  return -1;
+}
+
+// Returns the directory of the memory cgroup of the process, or the root of
+// the hierarchy if it can't be told, e.g. in a container which only mounts
+// its own group.
+base::FilePath GetMemoryCgroupPath() {
+  base::FilePath root(kMemoryCgroupRoot);
+  std::string cgroups;
+  if (!file_util::ReadFileToString(base::FilePath(kProcessCgroupPath),
+                                   &cgroups))
+    return root;
+  std::vector<std::string> lines;
+  base::SplitString(cgroups, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    // e.g. "4:memory:/user/1000.user".
+    std::vector<std::string> fields;
+    base::SplitString(lines[i], ':', &fields);
+    if (fields.size() != 3)
+      continue;
+    std::vector<std::string> controllers;
+    base::SplitString(fields[1], ',', &controllers);
+    if (std::find(controllers.begin(), controllers.end(), "memory") ==
+            controllers.end() ||
+        fields[2].empty() || fields[2][0] != '/')
+      continue;
+    base::FilePath path = root.Append(fields[2].substr(1));
+    return file_util::DirectoryExists(path) ? path : root;
+  }
+  return root;
+}
+
+// Returns the field |name| of |memory_stat|, the contents of the memory.stat
+// file of a memory cgroup, e.g. "total_inactive_file 1048576", in bytes, or
+// -1 if it is missing.
+int64 GetMemoryStatValue(const std::string& memory_stat,
+                         const std::string& name) {
+  std::vector<std::string> lines;
+  base::SplitString(memory_stat, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    std::vector<std::string> tokens;
+    base::SplitStringAlongWhitespace(lines[i], &tokens);
+    int64 value = 0;
+    if (tokens.size() == 2 && tokens[0] == name &&
+        base::StringToInt64(tokens[1], &value))
+      return value;
+  }
+  return -1;
+}
+
+// Returns what of |cgroup| is page cache the kernel can reclaim without
+// swapping: the inactive file pages of the group and its children, or all
+// of its page cache on kernels which don't tell them apart.
+int64 GetReclaimableCgroupCache(const base::FilePath& cgroup) {
+  std::string memory_stat;
+  if (!file_util::ReadFileToString(cgroup.Append("memory.stat"),
+                                   &memory_stat))
+    return 0;
+  int64 reclaimable = GetMemoryStatValue(memory_stat, "total_inactive_file");
+  if (reclaimable < 0)
+    reclaimable = GetMemoryStatValue(memory_stat, "cache");
+  return std::max<int64>(reclaimable, 0);
+}
+
+bool ReadInt64File(const base::FilePath& path, int64* value) {
+  std::string contents;
+  if (!file_util::ReadFileToString(path, &contents))
+    return false;
+  TrimWhitespaceASCII(contents, TRIM_ALL, &contents);
+  return base::StringToInt64(contents, value);
+}
+#endif  // defined(OS_LINUX)
+
+}  // namespace
+
+MemoryPressureCoordinator::MemoryStatus::MemoryStatus()
+    : total(0),
+      available(0) {
+}
+
+// static
+MemoryPressureCoordinator::MemoryStatus
+MemoryPressureCoordinator::MemoryStatus::Read() {
+  MemoryStatus status;
+#if defined(OS_LINUX)
+  std::string meminfo;
+  if (!file_util::ReadFileToString(base::FilePath(kMeminfoPath), &meminfo))
+    return status;
+  int64 total = GetMeminfoValue(meminfo, "MemTotal");
+  int64 available = GetMeminfoValue(meminfo, "MemAvailable");
+  // Older kernels don't estimate it, the page cache and the buffers are
+  // mostly reclaimable.
+  if (available < 0) {
+    available = std::max<int64>(GetMeminfoValue(meminfo, "MemFree"), 0) +
+                std::max<int64>(GetMeminfoValue(meminfo, "Buffers"), 0) +
+                std::max<int64>(GetMeminfoValue(meminfo, "Cached"), 0);
+  }
+  if (total <= 0)
+    return status;
+  status.total = total;
+  status.available = std::min(available, total);
+
+  // The usage of the group counts its page cache too, which ordinary file
+  // IO fills up to the limit, so what of it can be reclaimed is left out.
+  // There is no limit when it is above the memory of the system.
+  base::FilePath cgroup = GetMemoryCgroupPath();
+  int64 limit = 0;
+  int64 usage = 0;
+  if (ReadInt64File(cgroup.Append("memory.limit_in_bytes"), &limit) &&
+      ReadInt64File(cgroup.Append("memory.usage_in_bytes"), &usage) &&
+      limit > 0 && limit < status.total) {
+    usage = std::max<int64>(usage - GetReclaimableCgroupCache(cgroup), 0);
+    status.total = limit;
+    status.available = std::min(status.available,
+                                std::max<int64>(limit - usage, 0));
+  }
+#endif
+  return status;
+}
+
+MemoryPressureCoordinator::Config::Config()
+    : moderate_percent(0),
+      critical_percent(kDefaultCriticalPercent),
+      interval(base::TimeDelta::FromSeconds(kDefaultIntervalSeconds)) {
+}
+
+// static
+MemoryPressureCoordinator::Config
+MemoryPressureCoordinator::Config::FromCommandLine(
+    const CommandLine& command_line) {
+  Config config;
+  if (!command_line.HasSwitch(switches::kMemoryPressure))
+    return config;
+  config.moderate_percent = kDefaultModeratePercent;
+  std::vector<std::pair<std::string, std::string> > pairs;
+  base::SplitStringIntoKeyValuePairs(
+      command_line.GetSwitchValueASCII(switches::kMemoryPressure), '=', ',',
+      &pairs);
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    const std::string& key = pairs[i].first;
+    int value = 0;
+    if (!base::StringToInt(pairs[i].second, &value) || value < 0 ||
+        (key != "interval" && value > 100)) {
+      LOG(WARNING) << "Invalid --" << switches::kMemoryPressure << " " << key
+                   << ", using the default.";
+      continue;
+    }
+    if (key == "moderate")
+      config.moderate_percent = value;
+    else if (key == "critical")
+      config.critical_percent = value;
+    else if (key == "interval" && value > 0)
+      config.interval = base::TimeDelta::FromSeconds(value);
+    else
+      LOG(WARNING) << "Unknown --" << switches::kMemoryPressure << " " << key;
+  }
+  config.critical_percent =
+      std::min(config.critical_percent, config.moderate_percent);
+  return config;
+}
+
+MemoryPressureCoordinator::MemoryPressureCoordinator(
+    RuntimeContext* runtime_context,
+    const Config& config)
+    : runtime_context_(runtime_context),
+      config_(config),
+      last_step_(STEP_NONE),
+      caches_purged_(false),
+      weak_factory_(this) {
+}
+
+MemoryPressureCoordinator::~MemoryPressureCoordinator() {
+}
+
+void MemoryPressureCoordinator::Start() {
+  if (config_.moderate_percent == 0)
+    return;
+  timer_.Start(FROM_HERE, config_.interval, this,
+               &MemoryPressureCoordinator::Sample);
+}
+
+void MemoryPressureCoordinator::OnMemoryStatus(const MemoryStatus& status) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (status.total <= 0)
+    return;
+
+  Level level = GetLevel(status);
+  if (level == LEVEL_NONE) {
+    caches_purged_ = false;
+    last_step_ = STEP_NONE;
+  } else {
+    last_step_ = TakeStep(level);
+    if (last_step_ == STEP_NONE)
+      VLOG(1) << "Memory pressure: nothing left to reclaim";
+  }
+}
+
+MemoryPressureCoordinator::Level MemoryPressureCoordinator::GetLevel(
+    const MemoryStatus& status) const {
+  if (status.total <= 0)
+    return LEVEL_NONE;
+  int64 percent = status.available * 100 / status.total;
+  if (percent < config_.critical_percent)
+    return LEVEL_CRITICAL;
+  if (percent < config_.moderate_percent)
+    return LEVEL_MODERATE;
+  return LEVEL_NONE;
+}
+
+void MemoryPressureCoordinator::Sample() {
+  base::PostTaskAndReplyWithResult(
+      BrowserThread::GetMessageLoopProxyForThread(BrowserThread::FILE),
+      FROM_HERE,
+      base::Bind(&MemoryStatus::Read),
+      base::Bind(&MemoryPressureCoordinator::OnMemoryStatus,
+                 weak_factory_.GetWeakPtr()));
+}
+
+MemoryPressureCoordinator::Step MemoryPressureCoordinator::TakeStep(
+    Level level) {
+  if (!caches_purged_) {
+    caches_purged_ = true;
+    runtime_context_->PurgeMemoryCaches(
+        base::Bind(&MemoryPressureCoordinator::OnCachesPurged,
+                   weak_factory_.GetWeakPtr()));
+    return STEP_PURGE_CACHES;
+  }
+
+  if (Runtime* runtime = GetLeastRecentlyActiveRuntime(false)) {
+    VLOG(1) << "Memory pressure: hibernating "
+            << runtime->web_contents()->GetURL().spec() << ", freeing up to "
+            << GetRendererWorkingSet(runtime) / 1024 << " KB";
+    runtime->Hibernate();
+    return STEP_HIBERNATE;
+  }
+
+  // Closing the last Runtime would quit.
+  if (level == LEVEL_CRITICAL &&
+      RuntimeRegistry::Get()->runtimes().size() > 1) {
+    if (Runtime* runtime = GetLeastRecentlyActiveRuntime(true)) {
+      LOG(WARNING) << "Memory pressure: closing "
+                   << runtime->web_contents()->GetURL().spec()
+                   << ", freeing up to "
+                   << GetRendererWorkingSet(runtime) / 1024 << " KB";
+      runtime->Close();
+      return STEP_CLOSE;
+    }
+  }
+  return STEP_NONE;
+}
+
+void MemoryPressureCoordinator::OnCachesPurged(int64 bytes) {
+  VLOG(1) << "Memory pressure: purged " << bytes / 1024
+          << " KB of HTTP memory cache";
+}
+
+Runtime* MemoryPressureCoordinator::GetLeastRecentlyActiveRuntime(
+    bool hibernated_too) const {
+  Runtime* least_recent = NULL;
+  const RuntimeList& runtimes = RuntimeRegistry::Get()->runtimes();
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    Runtime* runtime = runtimes[i];
+    if (runtime->runtime_context() != runtime_context_ ||
+        !runtime->background_throttler()->is_throttled() ||
+        (runtime->is_hibernated() && !hibernated_too))
+      continue;
+    if (!least_recent ||
+        runtime->last_active_time() < least_recent->last_active_time())
+      least_recent = runtime;
+  }
+  return least_recent;
+}
+
+}  // namespace cameo
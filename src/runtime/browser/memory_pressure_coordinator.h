@@ -0,0 +1,120 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_MEMORY_PRESSURE_COORDINATOR_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_MEMORY_PRESSURE_COORDINATOR_H_
+
+#include "base/basictypes.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time.h"
+#include "base/timer.h"
+
+class CommandLine;
+
+namespace cameo {
+
+class Runtime;
+class RuntimeContext;
+
+// MemoryPressureCoordinator watches the memory left to the browser and gives
+// some back when it runs low, one step at a time while the pressure lasts:
+//
+//   1. The HTTP memory caches and the host cache of the RuntimeContext are
+//      purged, see RuntimeContext::PurgeMemoryCaches().
+//   2. The Runtime in the background for the longest time hibernates, see
+//      Runtime::Hibernate(), then the next one at the next sample, and so on.
+//   3. Under critical pressure, once all of them hibernated, the Runtime in
+//      the background for the longest time is closed.
+//
+// The Runtimes the user can see are left alone. Each step logs what it
+// frees: the bytes of the purged cache entries, or the working set of the
+// render process of the Runtime. The steps start over from the
+// first one once the pressure is gone. It only runs when asked to with
+// switches::kMemoryPressure.
+class MemoryPressureCoordinator {
+ public:
+  enum Level {
+    LEVEL_NONE,
+    LEVEL_MODERATE,
+    LEVEL_CRITICAL,
+  };
+
+  enum Step {
+    STEP_NONE,
+    STEP_PURGE_CACHES,
+    STEP_HIBERNATE,
+    STEP_CLOSE,
+  };
+
+  // The memory left, in bytes.
+  struct MemoryStatus {
+    MemoryStatus();
+
+    // Reads /proc/meminfo, and the limit and usage of the memory cgroup of
+    // the process, less its reclaimable page cache, keeping the tighter of
+    // both. Does blocking IO. |total| is
+    // 0 where the status isn't known.
+    static MemoryStatus Read();
+
+    int64 total;
+    int64 available;
+  };
+
+  struct Config {
+    Config();
+
+    // Reads switches::kMemoryPressure, e.g. "moderate=15,critical=5,
+    // interval=5", keeping the defaults for what is missing or invalid.
+    // Without the switch, the coordinator is disabled.
+    static Config FromCommandLine(const CommandLine& command_line);
+
+    // Pressure is moderate, or critical, below these percents of the total
+    // memory available. A moderate threshold of 0, the default, disables the
+    // coordinator.
+    int moderate_percent;
+    int critical_percent;
+    base::TimeDelta interval;
+  };
+
+  MemoryPressureCoordinator(RuntimeContext* runtime_context,
+                            const Config& config);
+  ~MemoryPressureCoordinator();
+
+  // Samples the memory status every Config::interval on the FILE thread.
+  void Start();
+
+  // Called with each sample, takes the next step if there is pressure. Tests
+  // call it with simulated statuses rather than starting the coordinator.
+  void OnMemoryStatus(const MemoryStatus& status);
+
+  Level GetLevel(const MemoryStatus& status) const;
+  // The step taken with the last sample.
+  Step last_step() const { return last_step_; }
+
+ private:
+  void Sample();
+  // Takes the first step which still has something to give back at |level|.
+  Step TakeStep(Level level);
+  void OnCachesPurged(int64 bytes);
+
+  // The Runtime in the background for the longest time, among those which
+  // haven't hibernated yet unless |hibernated_too|. NULL if there is none.
+  Runtime* GetLeastRecentlyActiveRuntime(bool hibernated_too) const;
+
+  RuntimeContext* runtime_context_;
+  Config config_;
+  base::RepeatingTimer<MemoryPressureCoordinator> timer_;
+
+  Step last_step_;
+  // Whether the caches were purged since the pressure started.
+  bool caches_purged_;
+
+  base::WeakPtrFactory<MemoryPressureCoordinator> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureCoordinator);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_MEMORY_PRESSURE_COORDINATOR_H_
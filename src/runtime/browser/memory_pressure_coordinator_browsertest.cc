@@ -0,0 +1,120 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+
+#include "base/command_line.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/memory_pressure_coordinator.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/browser/ui/native_app_window.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_headless_runtime_test.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+
+using cameo::MemoryPressureCoordinator;
+using cameo::Runtime;
+using cameo::RuntimeRegistry;
+
+namespace {
+
+// A simulated status with |percent| of 1 GB available.
+MemoryPressureCoordinator::MemoryStatus MakeStatus(int percent) {
+  MemoryPressureCoordinator::MemoryStatus status;
+  status.total = 1024 * 1024 * 1024;
+  status.available = status.total / 100 * percent;
+  return status;
+}
+
+bool IsRegistered(Runtime* runtime) {
+  const cameo::RuntimeList& runtimes = RuntimeRegistry::Get()->runtimes();
+  return std::find(runtimes.begin(), runtimes.end(), runtime) !=
+         runtimes.end();
+}
+
+}  // namespace
+
+typedef CameoHeadlessRuntimeTest MemoryPressureCoordinatorTest;
+
+IN_PROC_BROWSER_TEST_F(MemoryPressureCoordinatorTest, OptIn) {
+  CommandLine command_line(CommandLine::NO_PROGRAM);
+  EXPECT_EQ(0, MemoryPressureCoordinator::Config::FromCommandLine(
+      command_line).moderate_percent);
+
+  command_line.AppendSwitch(switches::kMemoryPressure);
+  MemoryPressureCoordinator::Config config =
+      MemoryPressureCoordinator::Config::FromCommandLine(command_line);
+  EXPECT_EQ(15, config.moderate_percent);
+  EXPECT_EQ(5, config.critical_percent);
+}
+
+#if defined(OS_LINUX)
+IN_PROC_BROWSER_TEST_F(MemoryPressureCoordinatorTest, ReadsMemoryStatus) {
+  MemoryPressureCoordinator::MemoryStatus status =
+      MemoryPressureCoordinator::MemoryStatus::Read();
+  EXPECT_GT(status.total, 0);
+  EXPECT_GE(status.available, 0);
+  EXPECT_LE(status.available, status.total);
+}
+#endif
+
+IN_PROC_BROWSER_TEST_F(MemoryPressureCoordinatorTest, Escalates) {
+  // Sampling isn't started, the test simulates the statuses.
+  MemoryPressureCoordinator::Config config;
+  config.moderate_percent = 15;
+  config.critical_percent = 5;
+  MemoryPressureCoordinator coordinator(runtime()->runtime_context(), config);
+
+  GURL url = cameo_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII("test.html"));
+  Runtime* older = Runtime::Create(runtime()->runtime_context(), url);
+  Runtime* newer = Runtime::Create(runtime()->runtime_context(), url);
+  older->window()->Minimize();
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromMilliseconds(10));
+  newer->window()->Minimize();
+
+  coordinator.OnMemoryStatus(MakeStatus(50));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_NONE, coordinator.last_step());
+
+  coordinator.OnMemoryStatus(MakeStatus(10));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_PURGE_CACHES,
+            coordinator.last_step());
+  EXPECT_FALSE(older->is_hibernated());
+
+  // The Runtime in the background for the longest time goes first.
+  coordinator.OnMemoryStatus(MakeStatus(10));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_HIBERNATE,
+            coordinator.last_step());
+  EXPECT_TRUE(older->is_hibernated());
+  EXPECT_FALSE(newer->is_hibernated());
+
+  coordinator.OnMemoryStatus(MakeStatus(10));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_HIBERNATE,
+            coordinator.last_step());
+  EXPECT_TRUE(newer->is_hibernated());
+
+  // The Runtime in the foreground is left alone, and nothing is closed until
+  // the pressure is critical.
+  coordinator.OnMemoryStatus(MakeStatus(10));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_NONE, coordinator.last_step());
+  EXPECT_FALSE(runtime()->is_hibernated());
+  EXPECT_TRUE(IsRegistered(older));
+
+  coordinator.OnMemoryStatus(MakeStatus(2));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_CLOSE, coordinator.last_step());
+  EXPECT_FALSE(IsRegistered(older));
+  EXPECT_TRUE(IsRegistered(newer));
+
+  // Once the pressure is gone, the steps start over.
+  coordinator.OnMemoryStatus(MakeStatus(50));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_NONE, coordinator.last_step());
+  coordinator.OnMemoryStatus(MakeStatus(10));
+  EXPECT_EQ(MemoryPressureCoordinator::STEP_PURGE_CACHES,
+            coordinator.last_step());
+
+  newer->Close();
+  EXPECT_TRUE(IsRegistered(runtime()));
+}
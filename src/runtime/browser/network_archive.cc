@@ -0,0 +1,147 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/network_archive.h"
+
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/http/http_response_headers.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+const char kArchiveMagic[] = "CNETARC";
+const int kArchiveVersion = 1;
+
+bool ReadEntry(const Pickle& pickle, NetworkArchive::Entry* entry) {
+  PickleIterator iter(pickle);
+  std::string url;
+  int64 headers_delay = 0;
+  int64 total_delay = 0;
+  if (!pickle.ReadString(&iter, &entry->method) ||
+      !pickle.ReadString(&iter, &url) ||
+      !pickle.ReadInt64(&iter, &headers_delay) ||
+      !pickle.ReadInt64(&iter, &total_delay) ||
+      !pickle.ReadString(&iter, &entry->body))
+    return false;
+  entry->headers = new net::HttpResponseHeaders(pickle, &iter);
+  entry->url = GURL(url);
+  entry->headers_delay = base::TimeDelta::FromMicroseconds(headers_delay);
+  entry->total_delay = base::TimeDelta::FromMicroseconds(total_delay);
+  return entry->url.is_valid() && entry->headers->response_code() > 0;
+}
+
+}  // namespace
+
+NetworkArchive::Entry::Entry() {
+}
+
+NetworkArchive::Entry::~Entry() {
+}
+
+NetworkArchive::Responses::Responses() : next(0) {
+}
+
+NetworkArchive::Responses::~Responses() {
+}
+
+// static
+scoped_refptr<NetworkArchive> NetworkArchive::Load(
+    const base::FilePath& path) {
+  std::string data;
+  if (!file_util::ReadFileToString(path, &data)) {
+    LOG(ERROR) << "Failed to read the network archive " << path.value();
+    return NULL;
+  }
+  scoped_refptr<NetworkArchive> archive(new NetworkArchive);
+  if (!archive->Initialize(data)) {
+    LOG(ERROR) << path.value() << " is not a network archive.";
+    return NULL;
+  }
+  return archive;
+}
+
+// static
+void NetworkArchive::WriteHeader(Pickle* pickle) {
+  pickle->WriteString(kArchiveMagic);
+  pickle->WriteInt(kArchiveVersion);
+}
+
+// static
+void NetworkArchive::WriteEntry(const Entry& entry, Pickle* pickle) {
+  pickle->WriteString(entry.method);
+  pickle->WriteString(entry.url.spec());
+  pickle->WriteInt64(entry.headers_delay.InMicroseconds());
+  pickle->WriteInt64(entry.total_delay.InMicroseconds());
+  pickle->WriteString(entry.body);
+  entry.headers->Persist(pickle, net::HttpResponseHeaders::PERSIST_RAW);
+}
+
+const NetworkArchive::Entry* NetworkArchive::Next(const std::string& method,
+                                                  const GURL& url) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  std::map<Key, Responses>::iterator it =
+      responses_.find(Key(method, url.spec()));
+  if (it == responses_.end())
+    return NULL;
+  Responses& responses = it->second;
+  const Entry* entry = &responses.entries[responses.next];
+  if (responses.next + 1 < responses.entries.size())
+    ++responses.next;
+  return entry;
+}
+
+void NetworkArchive::GetLastResponses(
+    std::vector<const Entry*>* entries) const {
+  for (std::map<Key, Responses>::const_iterator it = responses_.begin();
+       it != responses_.end(); ++it)
+    entries->push_back(&it->second.entries.back());
+}
+
+NetworkArchive::NetworkArchive() : entry_count_(0) {
+}
+
+NetworkArchive::~NetworkArchive() {
+}
+
+bool NetworkArchive::Initialize(const std::string& data) {
+  const char* cursor = data.data();
+  const char* end = cursor + data.size();
+  bool has_header = false;
+  while (cursor < end) {
+    const char* next = Pickle::FindNext(sizeof(Pickle::Header), cursor, end);
+    if (!next) {
+      // The recording stopped in the middle of a write.
+      LOG(WARNING) << "Ignoring the truncated end of the network archive.";
+      break;
+    }
+    Pickle pickle(cursor, static_cast<int>(next - cursor));
+    cursor = next;
+
+    if (!has_header) {
+      PickleIterator iter(pickle);
+      std::string magic;
+      int version = 0;
+      if (!pickle.ReadString(&iter, &magic) || magic != kArchiveMagic ||
+          !pickle.ReadInt(&iter, &version) || version != kArchiveVersion)
+        return false;
+      has_header = true;
+      continue;
+    }
+
+    Entry entry;
+    if (!ReadEntry(pickle, &entry))
+      return false;
+    responses_[Key(entry.method, entry.url.spec())].entries.push_back(entry);
+    ++entry_count_;
+  }
+  return has_header;
+}
+
+}  // namespace cameo
@@ -0,0 +1,95 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_NETWORK_ARCHIVE_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_NETWORK_ARCHIVE_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
+#include "googleurl/src/gurl.h"
+
+class Pickle;
+
+namespace net {
+class HttpResponseHeaders;
+}
+
+namespace cameo {
+
+// NetworkArchive holds the responses recorded by NetworkRecorder, which
+// ReplayProtocolHandler serves back. The file is a header followed by one
+// pickled Entry per response, appended as soon as the response has been read
+// to its end, so a recording cut short only loses the responses in flight.
+class NetworkArchive : public base::RefCountedThreadSafe<NetworkArchive> {
+ public:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    std::string method;
+    GURL url;
+    scoped_refptr<net::HttpResponseHeaders> headers;
+    std::string body;
+    // From the start of the transaction to its headers, and to the end of
+    // its body.
+    base::TimeDelta headers_delay;
+    base::TimeDelta total_delay;
+  };
+
+  // Reads the archive at |path|. Returns NULL if it can't be read or isn't
+  // an archive. Blocks on the file.
+  static scoped_refptr<NetworkArchive> Load(const base::FilePath& path);
+
+  // The header an archive starts with, and the record of |entry| following
+  // it.
+  static void WriteHeader(Pickle* pickle);
+  static void WriteEntry(const Entry& entry, Pickle* pickle);
+
+  // Returns the next response recorded for |method| and |url|, or NULL if
+  // there is none. A URL recorded several times gets its responses in the
+  // recorded order, the last one repeating, so a given sequence of requests
+  // always gets the same responses. Must be called on the IO thread.
+  const Entry* Next(const std::string& method, const GURL& url);
+
+  // Appends the last response recorded for every method and URL to
+  // |entries|. They are owned by the archive.
+  void GetLastResponses(std::vector<const Entry*>* entries) const;
+
+  size_t entry_count() const { return entry_count_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<NetworkArchive>;
+
+  // The method and the URL of a request.
+  typedef std::pair<std::string, std::string> Key;
+
+  struct Responses {
+    Responses();
+    ~Responses();
+
+    std::vector<Entry> entries;
+    size_t next;
+  };
+
+  NetworkArchive();
+  ~NetworkArchive();
+
+  bool Initialize(const std::string& data);
+
+  std::map<Key, Responses> responses_;
+  size_t entry_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkArchive);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_NETWORK_ARCHIVE_H_
@@ -0,0 +1,198 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/pickle.h"
+#include "base/run_loop.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/network_archive.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/web_contents.h"
+#include "googleurl/src/gurl.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_util.h"
+
+using cameo::NetworkArchive;
+using content::BrowserThread;
+
+namespace {
+
+const char kPageUrl[] = "http://replay.test/";
+const char kScriptUrl[] = "http://replay.test/app.js";
+const char kPageHtml[] =
+    "<html><head><script src=\"app.js\"></script></head></html>";
+const char kScript[] = "document.title = 'replayed';";
+
+// The delays of every recorded response in the latency test.
+const int kHeadersDelayMs = 100;
+const int kTotalDelayMs = 200;
+
+void AddEntry(const std::string& url,
+              const std::string& mime_type,
+              const std::string& body,
+              base::TimeDelta headers_delay,
+              base::TimeDelta total_delay,
+              Pickle* archive) {
+  NetworkArchive::Entry entry;
+  entry.method = "GET";
+  entry.url = GURL(url);
+  std::string headers = "HTTP/1.1 200 OK\nContent-Type: " + mime_type + "\n";
+  entry.headers = new net::HttpResponseHeaders(
+      net::HttpUtil::AssembleRawHeaders(headers.data(), headers.size()));
+  entry.body = body;
+  entry.headers_delay = headers_delay;
+  entry.total_delay = total_delay;
+  NetworkArchive::WriteEntry(entry, archive);
+}
+
+// Writes an archive of the page at kPageUrl and its script.
+bool WriteArchive(const base::FilePath& path, base::TimeDelta headers_delay,
+                  base::TimeDelta total_delay) {
+  std::string data;
+  Pickle header;
+  NetworkArchive::WriteHeader(&header);
+  data.append(static_cast<const char*>(header.data()), header.size());
+  Pickle page;
+  AddEntry(kPageUrl, "text/html", kPageHtml, headers_delay, total_delay,
+           &page);
+  data.append(static_cast<const char*>(page.data()), page.size());
+  Pickle script;
+  AddEntry(kScriptUrl, "application/javascript", kScript, headers_delay,
+           total_delay, &script);
+  data.append(static_cast<const char*>(script.data()), script.size());
+  int size = static_cast<int>(data.size());
+  return file_util::WriteFile(path, data.data(), size) == size;
+}
+
+struct RecordedResponse {
+  RecordedResponse() : code(0) {}
+
+  int code;
+  std::string body;
+};
+
+// NetworkArchive::Next() is meant for the IO thread.
+void FindResponse(NetworkArchive* archive,
+                  const GURL& url,
+                  RecordedResponse* response,
+                  const base::Closure& done) {
+  const NetworkArchive::Entry* entry = archive->Next("GET", url);
+  if (entry) {
+    response->code = entry->headers->response_code();
+    response->body = entry->body;
+  }
+  done.Run();
+}
+
+}  // namespace
+
+class NetworkRecordTest : public InProcessBrowserTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    archive_path_ = temp_dir_.path().AppendASCII("archive");
+    command_line->AppendSwitchPath(switches::kRecordNetwork, archive_path_);
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath archive_path_;
+};
+
+IN_PROC_BROWSER_TEST_F(NetworkRecordTest, RecordsResponses) {
+  ASSERT_TRUE(test_server()->Start());
+  GURL url = test_server()->GetURL("title.html");
+  cameo_test_utils::NavigateToURL(runtime(), url);
+
+  // The archive is written on the FILE thread.
+  base::RunLoop run_loop;
+  BrowserThread::PostTaskAndReply(BrowserThread::FILE, FROM_HERE,
+                                  base::Bind(&base::DoNothing),
+                                  run_loop.QuitClosure());
+  run_loop.Run();
+
+  scoped_refptr<NetworkArchive> archive;
+  {
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    archive = NetworkArchive::Load(archive_path_);
+  }
+  ASSERT_TRUE(archive);
+
+  RecordedResponse response;
+  cameo_test_utils::RunOnIOThreadAndWait(
+      base::Bind(&FindResponse, archive, url, &response));
+  EXPECT_EQ(200, response.code);
+  EXPECT_NE(std::string::npos, response.body.find("<title>Dummy Title"));
+}
+
+class NetworkReplayTest : public InProcessBrowserTest {
+ public:
+  explicit NetworkReplayTest(bool replay_latency)
+      : replay_latency_(replay_latency) {}
+
+  // The archive is made up beforehand: nothing in it can be reached.
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    base::FilePath archive_path = temp_dir_.path().AppendASCII("archive");
+    ASSERT_TRUE(WriteArchive(
+        archive_path,
+        base::TimeDelta::FromMilliseconds(kHeadersDelayMs),
+        base::TimeDelta::FromMilliseconds(kTotalDelayMs)));
+    command_line->AppendSwitchPath(switches::kReplayNetwork, archive_path);
+    if (replay_latency_)
+      command_line->AppendSwitch(switches::kReplayNetworkLatency);
+  }
+
+  base::TimeDelta LoadPage() {
+    base::TimeTicks start = base::TimeTicks::Now();
+    cameo_test_utils::NavigateToURL(runtime(), GURL(kPageUrl));
+    base::TimeDelta load_time = base::TimeTicks::Now() - start;
+    EXPECT_EQ(ASCIIToUTF16("replayed"),
+              runtime()->web_contents()->GetTitle());
+    return load_time;
+  }
+
+ private:
+  bool replay_latency_;
+  base::ScopedTempDir temp_dir_;
+};
+
+class NetworkReplayWithoutLatencyTest : public NetworkReplayTest {
+ public:
+  NetworkReplayWithoutLatencyTest() : NetworkReplayTest(false) {}
+};
+
+class NetworkReplayWithLatencyTest : public NetworkReplayTest {
+ public:
+  NetworkReplayWithLatencyTest() : NetworkReplayTest(true) {}
+};
+
+IN_PROC_BROWSER_TEST_F(NetworkReplayWithoutLatencyTest, ServesArchive) {
+  LoadPage();
+
+  // What wasn't recorded fails rather than going to the network.
+  cameo_test_utils::NavigateToURL(runtime(),
+                                  GURL("http://replay.test/missing.html"));
+  EXPECT_NE(ASCIIToUTF16("replayed"), runtime()->web_contents()->GetTitle());
+}
+
+IN_PROC_BROWSER_TEST_F(NetworkReplayWithLatencyTest, ReplaysLatency) {
+  // The script is only requested once the page has been received.
+  base::TimeDelta load_time = LoadPage();
+  EXPECT_GE(load_time.InMilliseconds(), 2 * kTotalDelayMs);
+  cameo_test_utils::PrintPerfResult("network_replay_load", "with_latency",
+                                    load_time.InMillisecondsF(), "ms");
+}
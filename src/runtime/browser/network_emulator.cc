@@ -0,0 +1,382 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/network_emulator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop.h"
+#include "base/rand_util.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/strings/string_split.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/base/net_errors.h"
+#include "net/base/upload_data_stream.h"
+#include "net/http/http_request_info.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_transaction.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/url_request/url_request.h"
+
+namespace cameo {
+
+namespace {
+
+struct Preset {
+  const char* name;
+  int latency_ms;
+  int download_kbps;
+  int upload_kbps;
+};
+
+const Preset kPresets[] = {
+  { "2g", 300, 250, 50 },
+  { "3g", 100, 750, 250 },
+};
+
+}  // namespace
+
+NetworkEmulator::Conditions::Conditions()
+    : download_kbps(0),
+      upload_kbps(0),
+      failure_rate(0) {
+}
+
+// static
+bool NetworkEmulator::Conditions::Parse(const std::string& profile,
+                                        Conditions* conditions) {
+  *conditions = Conditions();
+  for (size_t i = 0; i < arraysize(kPresets); ++i) {
+    if (profile == kPresets[i].name) {
+      conditions->latency =
+          base::TimeDelta::FromMilliseconds(kPresets[i].latency_ms);
+      conditions->download_kbps = kPresets[i].download_kbps;
+      conditions->upload_kbps = kPresets[i].upload_kbps;
+      return true;
+    }
+  }
+  if (profile == "none")
+    return true;
+
+  std::vector<std::pair<std::string, std::string> > pairs;
+  if (!base::SplitStringIntoKeyValuePairs(profile, '=', ',', &pairs))
+    return false;
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    const std::string& key = pairs[i].first;
+    int value = 0;
+    if (!base::StringToInt(pairs[i].second, &value) || value < 0)
+      return false;
+    if (key == "latency")
+      conditions->latency = base::TimeDelta::FromMilliseconds(value);
+    else if (key == "down")
+      conditions->download_kbps = value;
+    else if (key == "up")
+      conditions->upload_kbps = value;
+    else if (key == "loss" && value <= 100)
+      conditions->failure_rate = value / 100.0;
+    else
+      return false;
+  }
+  return true;
+}
+
+bool NetworkEmulator::Conditions::IsEmulated() const {
+  return latency > base::TimeDelta() || download_kbps > 0 ||
+         upload_kbps > 0 || failure_rate > 0;
+}
+
+std::string NetworkEmulator::Conditions::ToString() const {
+  if (!IsEmulated())
+    return "none";
+  return base::StringPrintf(
+      "latency=%d,down=%d,up=%d,loss=%d",
+      static_cast<int>(latency.InMilliseconds()), download_kbps, upload_kbps,
+      static_cast<int>(failure_rate * 100 + 0.5));
+}
+
+// Forwards to the transaction of the layer below. Once it has started, and
+// unless it was answered from the cache, the conditions it started under
+// delay its start and every read.
+class NetworkEmulator::EmulatedTransaction : public net::HttpTransaction {
+ public:
+  EmulatedTransaction(NetworkEmulator* emulator,
+                      const ViewId& owner,
+                      const Conditions& conditions,
+                      scoped_ptr<net::HttpTransaction> transaction)
+      : emulator_(emulator),
+        owner_(owner),
+        conditions_(conditions),
+        transaction_(transaction.Pass()),
+        upload_size_(0),
+        emulated_(false),
+        weak_factory_(this) {
+  }
+  virtual ~EmulatedTransaction() {}
+
+  // net::HttpTransaction implementation.
+  virtual int Start(const net::HttpRequestInfo* request_info,
+                    const net::CompletionCallback& callback,
+                    const net::BoundNetLog& net_log) OVERRIDE {
+    if (request_info->upload_data_stream)
+      upload_size_ = request_info->upload_data_stream->size();
+    return OnStarted(
+        transaction_->Start(request_info, WrapStartCallback(callback),
+                            net_log),
+        callback);
+  }
+  virtual int RestartIgnoringLastError(
+      const net::CompletionCallback& callback) OVERRIDE {
+    return OnStarted(
+        transaction_->RestartIgnoringLastError(WrapStartCallback(callback)),
+        callback);
+  }
+  virtual int RestartWithCertificate(
+      net::X509Certificate* client_cert,
+      const net::CompletionCallback& callback) OVERRIDE {
+    return OnStarted(
+        transaction_->RestartWithCertificate(client_cert,
+                                             WrapStartCallback(callback)),
+        callback);
+  }
+  virtual int RestartWithAuth(
+      const net::AuthCredentials& credentials,
+      const net::CompletionCallback& callback) OVERRIDE {
+    return OnStarted(
+        transaction_->RestartWithAuth(credentials,
+                                      WrapStartCallback(callback)),
+        callback);
+  }
+  virtual bool IsReadyToRestartForAuth() OVERRIDE {
+    return transaction_->IsReadyToRestartForAuth();
+  }
+  virtual int Read(net::IOBuffer* buf,
+                   int buf_len,
+                   const net::CompletionCallback& callback) OVERRIDE {
+    return OnRead(
+        transaction_->Read(
+            buf, buf_len,
+            base::Bind(&EmulatedTransaction::OnReadComplete,
+                       base::Unretained(this), callback)),
+        callback);
+  }
+  virtual void StopCaching() OVERRIDE {
+    transaction_->StopCaching();
+  }
+  virtual bool GetFullRequestHeaders(
+      net::HttpRequestHeaders* headers) const OVERRIDE {
+    return transaction_->GetFullRequestHeaders(headers);
+  }
+  virtual void DoneReading() OVERRIDE {
+    transaction_->DoneReading();
+  }
+  virtual const net::HttpResponseInfo* GetResponseInfo() const OVERRIDE {
+    return transaction_->GetResponseInfo();
+  }
+  virtual net::LoadState GetLoadState() const OVERRIDE {
+    return transaction_->GetLoadState();
+  }
+  virtual net::UploadProgress GetUploadProgress() const OVERRIDE {
+    return transaction_->GetUploadProgress();
+  }
+  virtual bool GetLoadTimingInfo(
+      net::LoadTimingInfo* load_timing_info) const OVERRIDE {
+    return transaction_->GetLoadTimingInfo(load_timing_info);
+  }
+  virtual void SetPriority(net::RequestPriority priority) OVERRIDE {
+    transaction_->SetPriority(priority);
+  }
+
+ private:
+  // The transaction owned by this one never runs the callbacks it is given
+  // once destroyed, hence the unretained pointers. The delayed callbacks
+  // are cancelled with |weak_factory_|.
+  net::CompletionCallback WrapStartCallback(
+      const net::CompletionCallback& callback) {
+    return base::Bind(&EmulatedTransaction::OnStartComplete,
+                      base::Unretained(this), callback);
+  }
+
+  void OnStartComplete(const net::CompletionCallback& callback, int rv) {
+    rv = OnStarted(rv, callback);
+    if (rv != net::ERR_IO_PENDING)
+      callback.Run(rv);
+  }
+
+  void OnReadComplete(const net::CompletionCallback& callback, int rv) {
+    rv = OnRead(rv, callback);
+    if (rv != net::ERR_IO_PENDING)
+      callback.Run(rv);
+  }
+
+  int OnStarted(int rv, const net::CompletionCallback& callback) {
+    if (rv != net::OK || !conditions_.IsEmulated())
+      return rv;
+    const net::HttpResponseInfo* response = GetResponseInfo();
+    if (response && response->was_cached)
+      return rv;
+
+    emulated_ = true;
+    if (conditions_.failure_rate > 0 &&
+        base::RandDouble() < conditions_.failure_rate)
+      return net::ERR_CONNECTION_RESET;
+    base::TimeTicks ready = emulator_->Transfer(
+        owner_, true, upload_size_, conditions_.upload_kbps) +
+        conditions_.latency;
+    return DelayUntil(ready, rv, callback);
+  }
+
+  int OnRead(int rv, const net::CompletionCallback& callback) {
+    if (rv <= 0 || !emulated_)
+      return rv;
+    base::TimeTicks ready = emulator_->Transfer(
+        owner_, false, rv, conditions_.download_kbps);
+    return DelayUntil(ready, rv, callback);
+  }
+
+  // Returns |rv| if |ready| has come, otherwise returns net::ERR_IO_PENDING
+  // and runs |callback| with |rv| then.
+  int DelayUntil(base::TimeTicks ready, int rv,
+                 const net::CompletionCallback& callback) {
+    base::TimeDelta delay = ready - base::TimeTicks::Now();
+    if (delay <= base::TimeDelta())
+      return rv;
+    base::MessageLoop::current()->PostDelayedTask(
+        FROM_HERE,
+        base::Bind(&EmulatedTransaction::RunCallback,
+                   weak_factory_.GetWeakPtr(), callback, rv),
+        delay);
+    return net::ERR_IO_PENDING;
+  }
+
+  void RunCallback(const net::CompletionCallback& callback, int rv) {
+    callback.Run(rv);
+  }
+
+  NetworkEmulator* emulator_;
+  const ViewId owner_;
+  const Conditions conditions_;
+  scoped_ptr<net::HttpTransaction> transaction_;
+  int64 upload_size_;
+  // True once the transaction went to the network under conditions
+  // emulating something.
+  bool emulated_;
+  base::WeakPtrFactory<EmulatedTransaction> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(EmulatedTransaction);
+};
+
+class NetworkEmulator::EmulatedLayer : public net::HttpTransactionFactory {
+ public:
+  EmulatedLayer(NetworkEmulator* emulator, net::HttpTransactionFactory* next)
+      : emulator_(emulator),
+        next_(next) {
+  }
+
+  // net::HttpTransactionFactory implementation.
+  virtual int CreateTransaction(
+      net::RequestPriority priority,
+      scoped_ptr<net::HttpTransaction>* trans,
+      net::HttpTransactionDelegate* delegate) OVERRIDE {
+    ViewId owner = emulator_->GetConditionsOwner(emulator_->next_view_);
+    emulator_->next_view_ = ViewId(-1, -1);
+
+    scoped_ptr<net::HttpTransaction> transaction;
+    int rv = next_->CreateTransaction(priority, &transaction, delegate);
+    if (rv != net::OK)
+      return rv;
+    trans->reset(new EmulatedTransaction(
+        emulator_, owner, emulator_->conditions_[owner], transaction.Pass()));
+    return net::OK;
+  }
+  virtual net::HttpCache* GetCache() OVERRIDE {
+    return next_->GetCache();
+  }
+  virtual net::HttpNetworkSession* GetSession() OVERRIDE {
+    return next_->GetSession();
+  }
+
+ private:
+  NetworkEmulator* emulator_;
+  scoped_ptr<net::HttpTransactionFactory> next_;
+
+  DISALLOW_COPY_AND_ASSIGN(EmulatedLayer);
+};
+
+NetworkEmulator::NetworkEmulator()
+    : next_view_(-1, -1) {
+  Conditions conditions;
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(switches::kEmulateNetwork) &&
+      !Conditions::Parse(
+          command_line.GetSwitchValueASCII(switches::kEmulateNetwork),
+          &conditions)) {
+    LOG(WARNING) << "Invalid --" << switches::kEmulateNetwork
+                 << ", not emulating any network conditions.";
+  }
+  conditions_[ViewId(-1, -1)] = conditions;
+}
+
+NetworkEmulator::~NetworkEmulator() {
+}
+
+void NetworkEmulator::SetConditions(int render_process_id,
+                                    int render_view_id,
+                                    const Conditions& conditions) {
+  ViewId view(render_process_id, render_view_id);
+  if (view != ViewId(-1, -1) && !conditions.IsEmulated()) {
+    conditions_.erase(view);
+    links_.erase(view);
+    return;
+  }
+  conditions_[view] = conditions;
+}
+
+const NetworkEmulator::Conditions& NetworkEmulator::GetConditions(
+    int render_process_id, int render_view_id) const {
+  ViewId owner =
+      GetConditionsOwner(ViewId(render_process_id, render_view_id));
+  return conditions_.find(owner)->second;
+}
+
+void NetworkEmulator::OnSendHeaders(const net::URLRequest& request) {
+  int render_process_id = -1;
+  int render_view_id = -1;
+  content::ResourceRequestInfo::GetRenderViewForRequest(
+      &request, &render_process_id, &render_view_id);
+  next_view_ = ViewId(render_process_id, render_view_id);
+}
+
+net::HttpTransactionFactory* NetworkEmulator::WrapTransactionFactory(
+    net::HttpTransactionFactory* factory) {
+  return new EmulatedLayer(this, factory);
+}
+
+NetworkEmulator::ViewId NetworkEmulator::GetConditionsOwner(
+    const ViewId& view) const {
+  return conditions_.count(view) ? view : ViewId(-1, -1);
+}
+
+base::TimeTicks NetworkEmulator::Transfer(const ViewId& owner,
+                                          bool upload,
+                                          int64 bytes,
+                                          int kbps) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (bytes <= 0 || kbps <= 0)
+    return now;
+  Link& link = links_[owner];
+  base::TimeTicks& free = upload ? link.upload_free : link.download_free;
+  free = std::max(now, free) +
+      base::TimeDelta::FromMicroseconds(bytes * 8 * 1000 / kbps);
+  return free;
+}
+
+}  // namespace cameo
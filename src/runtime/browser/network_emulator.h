@@ -0,0 +1,117 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_NETWORK_EMULATOR_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_NETWORK_EMULATOR_H_
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+
+namespace net {
+class HttpTransactionFactory;
+class URLRequest;
+}
+
+namespace cameo {
+
+// NetworkEmulator makes the network look slower and less reliable than it
+// is, e.g. like the 3G connection of a device. Every transaction which goes
+// to the network waits for the latency of its conditions, and its upload and
+// its body go through a link of the given bandwidth, shared by all the
+// transactions under the same conditions. A given fraction of them fail as
+// if the connection had been reset. Responses from the HTTP cache aren't
+// slowed down.
+//
+// The conditions are set for all the requests, by switches::kEmulateNetwork
+// or SetConditions(-1, -1, ...), and can be overridden for the requests of a
+// render view. Only lives on the IO thread.
+class NetworkEmulator {
+ public:
+  struct Conditions {
+    Conditions();
+
+    // Parses |profile|, which is either "2g", "3g", or comma separated
+    // "latency=<ms>", "down=<kbit/s>", "up=<kbit/s>" and "loss=<percent>",
+    // e.g. "latency=100,down=750,up=250,loss=1". Returns false if it isn't
+    // valid.
+    static bool Parse(const std::string& profile, Conditions* conditions);
+
+    // False if nothing is emulated.
+    bool IsEmulated() const;
+
+    // The profile of these conditions, in the format Parse() takes, or
+    // "none".
+    std::string ToString() const;
+
+    base::TimeDelta latency;
+    // 0 for no limit.
+    int download_kbps;
+    int upload_kbps;
+    // The fraction of the transactions failing, from 0 to 1.
+    double failure_rate;
+  };
+
+  NetworkEmulator();
+  ~NetworkEmulator();
+
+  // Sets the conditions of the requests of a render view, or those of all
+  // the requests without conditions of their own for -1, -1. Conditions not
+  // emulating anything remove those of the render view.
+  void SetConditions(int render_process_id,
+                     int render_view_id,
+                     const Conditions& conditions);
+
+  // The conditions the requests of a render view get.
+  const Conditions& GetConditions(int render_process_id,
+                                  int render_view_id) const;
+
+  // Called by the network delegate right before the transaction of
+  // |request| is created, which is how it gets the conditions of its
+  // render view.
+  void OnSendHeaders(const net::URLRequest& request);
+
+  // Returns a transaction factory emulating the conditions on the
+  // transactions of |factory|, which it takes ownership of. The emulator
+  // must outlive it.
+  net::HttpTransactionFactory* WrapTransactionFactory(
+      net::HttpTransactionFactory* factory);
+
+ private:
+  class EmulatedLayer;
+  class EmulatedTransaction;
+
+  // A render process id and render view id, both -1 for all the requests.
+  typedef std::pair<int, int> ViewId;
+
+  // When the links of some conditions are free again.
+  struct Link {
+    base::TimeTicks download_free;
+    base::TimeTicks upload_free;
+  };
+
+  // The render view whose conditions apply to the requests of |view|.
+  ViewId GetConditionsOwner(const ViewId& view) const;
+
+  // Sends |bytes| through the link of |owner| at |kbps| and returns when the
+  // last byte gets through, after what is already on the link.
+  base::TimeTicks Transfer(const ViewId& owner,
+                           bool upload,
+                           int64 bytes,
+                           int kbps);
+
+  std::map<ViewId, Conditions> conditions_;
+  std::map<ViewId, Link> links_;
+  // The view of the request whose transaction is being created.
+  ViewId next_view_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkEmulator);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_NETWORK_EMULATOR_H_
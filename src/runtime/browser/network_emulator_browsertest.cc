@@ -0,0 +1,105 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/string_number_conversions.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/network_emulator.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/web_contents.h"
+#include "googleurl/src/gurl.h"
+
+using cameo::NetworkEmulator;
+using cameo::Runtime;
+
+namespace {
+
+const int kLatencyMs = 200;
+
+// The page at /nocachetime of the test server has the current time as its
+// title.
+bool HasLoadedUncachedPage(Runtime* runtime) {
+  double time = 0;
+  return base::StringToDouble(
+      UTF16ToASCII(runtime->web_contents()->GetTitle()), &time);
+}
+
+}  // namespace
+
+class NetworkEmulatorTest : public InProcessBrowserTest {
+ public:
+  explicit NetworkEmulatorTest(const std::string& profile)
+      : profile_(profile) {}
+
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    if (!profile_.empty())
+      command_line->AppendSwitchASCII(switches::kEmulateNetwork, profile_);
+  }
+
+  // Loads a page which is never cached from the test server.
+  base::TimeDelta LoadUncachedPage() {
+    EXPECT_TRUE(test_server()->Start());
+    base::TimeTicks start = base::TimeTicks::Now();
+    cameo_test_utils::NavigateToURL(runtime(),
+                                    test_server()->GetURL("nocachetime"));
+    return base::TimeTicks::Now() - start;
+  }
+
+ protected:
+  std::string profile_;
+};
+
+class NetworkEmulatorLatencyTest : public NetworkEmulatorTest {
+ public:
+  NetworkEmulatorLatencyTest() : NetworkEmulatorTest("latency=200") {}
+};
+
+class NetworkEmulatorLossTest : public NetworkEmulatorTest {
+ public:
+  NetworkEmulatorLossTest() : NetworkEmulatorTest("loss=100") {}
+};
+
+class NetworkEmulatorPerRuntimeTest : public NetworkEmulatorTest {
+ public:
+  NetworkEmulatorPerRuntimeTest() : NetworkEmulatorTest(std::string()) {}
+};
+
+IN_PROC_BROWSER_TEST_F(NetworkEmulatorLatencyTest, DelaysResponses) {
+  base::TimeDelta load_time = LoadUncachedPage();
+  EXPECT_GE(load_time.InMilliseconds(), kLatencyMs);
+  EXPECT_TRUE(HasLoadedUncachedPage(runtime()));
+
+  NetworkEmulator::Conditions conditions;
+  ASSERT_TRUE(NetworkEmulator::Conditions::Parse(profile_, &conditions));
+  cameo_test_utils::PrintPerfResult("emulated_network_load",
+                                    conditions.ToString(),
+                                    load_time.InMillisecondsF(), "ms");
+}
+
+IN_PROC_BROWSER_TEST_F(NetworkEmulatorLossTest, FailsTransactions) {
+  LoadUncachedPage();
+  EXPECT_FALSE(HasLoadedUncachedPage(runtime()));
+}
+
+IN_PROC_BROWSER_TEST_F(NetworkEmulatorPerRuntimeTest, EmulatesRuntime) {
+  NetworkEmulator::Conditions conditions;
+  ASSERT_TRUE(NetworkEmulator::Conditions::Parse("latency=200", &conditions));
+  runtime()->runtime_context()->SetNetworkConditions(runtime(), conditions);
+  EXPECT_GE(LoadUncachedPage().InMilliseconds(), kLatencyMs);
+  EXPECT_TRUE(HasLoadedUncachedPage(runtime()));
+
+  // Removing them restores the network of the Runtime.
+  runtime()->runtime_context()->SetNetworkConditions(
+      runtime(), NetworkEmulator::Conditions());
+  cameo_test_utils::NavigateToURL(runtime(),
+                                  test_server()->GetURL("nocachetime"));
+  EXPECT_TRUE(HasLoadedUncachedPage(runtime()));
+}
@@ -0,0 +1,247 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/network_recorder.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/pickle.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_request_info.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_transaction.h"
+#include "net/http/http_transaction_factory.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+void WriteArchive(const base::FilePath& path, const std::string& data) {
+  if (file_util::WriteFile(path, data.data(), data.size()) !=
+      static_cast<int>(data.size()))
+    LOG(ERROR) << "Failed to create the network archive " << path.value();
+}
+
+void AppendToArchive(const base::FilePath& path, const std::string& data) {
+  if (!file_util::AppendToFile(path, data.data(), data.size()))
+    LOG(ERROR) << "Failed to write to the network archive " << path.value();
+}
+
+}  // namespace
+
+// Forwards to the transaction of the network layer, keeping a copy of the
+// response. The copy goes to the recorder once the body has been read to its
+// end; a transaction failing or destroyed before is not recorded.
+class NetworkRecorder::RecordingTransaction : public net::HttpTransaction {
+ public:
+  RecordingTransaction(NetworkRecorder* recorder,
+                       scoped_ptr<net::HttpTransaction> transaction)
+      : recorder_(recorder),
+        transaction_(transaction.Pass()),
+        failed_(false) {
+  }
+  virtual ~RecordingTransaction() {}
+
+  // net::HttpTransaction implementation.
+  virtual int Start(const net::HttpRequestInfo* request_info,
+                    const net::CompletionCallback& callback,
+                    const net::BoundNetLog& net_log) OVERRIDE {
+    request_info_ = *request_info;
+    request_info_.extra_headers.SetHeader(
+        net::HttpRequestHeaders::kAcceptEncoding, "identity");
+    entry_.method = request_info_.method;
+    entry_.url = request_info_.url;
+    start_time_ = base::TimeTicks::Now();
+    return OnStarted(transaction_->Start(&request_info_,
+                                         WrapStartCallback(callback),
+                                         net_log));
+  }
+  virtual int RestartIgnoringLastError(
+      const net::CompletionCallback& callback) OVERRIDE {
+    return OnStarted(transaction_->RestartIgnoringLastError(
+        WrapStartCallback(callback)));
+  }
+  virtual int RestartWithCertificate(
+      net::X509Certificate* client_cert,
+      const net::CompletionCallback& callback) OVERRIDE {
+    return OnStarted(transaction_->RestartWithCertificate(
+        client_cert, WrapStartCallback(callback)));
+  }
+  virtual int RestartWithAuth(
+      const net::AuthCredentials& credentials,
+      const net::CompletionCallback& callback) OVERRIDE {
+    return OnStarted(transaction_->RestartWithAuth(
+        credentials, WrapStartCallback(callback)));
+  }
+  virtual bool IsReadyToRestartForAuth() OVERRIDE {
+    return transaction_->IsReadyToRestartForAuth();
+  }
+  virtual int Read(net::IOBuffer* buf,
+                   int buf_len,
+                   const net::CompletionCallback& callback) OVERRIDE {
+    read_buf_ = buf;
+    return OnRead(transaction_->Read(
+        buf, buf_len,
+        base::Bind(&RecordingTransaction::OnReadComplete,
+                   base::Unretained(this), callback)));
+  }
+  virtual void StopCaching() OVERRIDE {
+    transaction_->StopCaching();
+  }
+  virtual bool GetFullRequestHeaders(
+      net::HttpRequestHeaders* headers) const OVERRIDE {
+    return transaction_->GetFullRequestHeaders(headers);
+  }
+  virtual void DoneReading() OVERRIDE {
+    transaction_->DoneReading();
+  }
+  virtual const net::HttpResponseInfo* GetResponseInfo() const OVERRIDE {
+    return transaction_->GetResponseInfo();
+  }
+  virtual net::LoadState GetLoadState() const OVERRIDE {
+    return transaction_->GetLoadState();
+  }
+  virtual net::UploadProgress GetUploadProgress() const OVERRIDE {
+    return transaction_->GetUploadProgress();
+  }
+  virtual bool GetLoadTimingInfo(
+      net::LoadTimingInfo* load_timing_info) const OVERRIDE {
+    return transaction_->GetLoadTimingInfo(load_timing_info);
+  }
+  virtual void SetPriority(net::RequestPriority priority) OVERRIDE {
+    transaction_->SetPriority(priority);
+  }
+
+ private:
+  // The transaction owned by this one never runs the callbacks it is given
+  // once destroyed, hence the unretained pointers.
+  net::CompletionCallback WrapStartCallback(
+      const net::CompletionCallback& callback) {
+    return base::Bind(&RecordingTransaction::OnStartComplete,
+                      base::Unretained(this), callback);
+  }
+
+  void OnStartComplete(const net::CompletionCallback& callback, int rv) {
+    callback.Run(OnStarted(rv));
+  }
+
+  void OnReadComplete(const net::CompletionCallback& callback, int rv) {
+    callback.Run(OnRead(rv));
+  }
+
+  int OnStarted(int rv) {
+    if (rv == net::OK) {
+      entry_.headers_delay = base::TimeTicks::Now() - start_time_;
+      entry_.body.clear();
+    }
+    return rv;
+  }
+
+  int OnRead(int rv) {
+    if (rv == net::ERR_IO_PENDING)
+      return rv;
+    if (rv < 0) {
+      failed_ = true;
+    } else if (rv > 0) {
+      entry_.body.append(read_buf_->data(), rv);
+    } else if (!failed_) {
+      const net::HttpResponseInfo* response = GetResponseInfo();
+      if (response && response->headers) {
+        entry_.headers = response->headers;
+        entry_.total_delay = base::TimeTicks::Now() - start_time_;
+        recorder_->Record(entry_);
+      }
+    }
+    read_buf_ = NULL;
+    return rv;
+  }
+
+  NetworkRecorder* recorder_;
+  scoped_ptr<net::HttpTransaction> transaction_;
+  // The request as sent, which must outlive |transaction_|.
+  net::HttpRequestInfo request_info_;
+  base::TimeTicks start_time_;
+  scoped_refptr<net::IOBuffer> read_buf_;
+  NetworkArchive::Entry entry_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingTransaction);
+};
+
+class NetworkRecorder::RecordingLayer : public net::HttpTransactionFactory {
+ public:
+  RecordingLayer(NetworkRecorder* recorder, net::HttpTransactionFactory* next)
+      : recorder_(recorder),
+        next_(next) {
+  }
+
+  // net::HttpTransactionFactory implementation.
+  virtual int CreateTransaction(
+      net::RequestPriority priority,
+      scoped_ptr<net::HttpTransaction>* trans,
+      net::HttpTransactionDelegate* delegate) OVERRIDE {
+    scoped_ptr<net::HttpTransaction> transaction;
+    int rv = next_->CreateTransaction(priority, &transaction, delegate);
+    if (rv != net::OK)
+      return rv;
+    trans->reset(new RecordingTransaction(recorder_, transaction.Pass()));
+    return net::OK;
+  }
+  virtual net::HttpCache* GetCache() OVERRIDE {
+    return next_->GetCache();
+  }
+  virtual net::HttpNetworkSession* GetSession() OVERRIDE {
+    return next_->GetSession();
+  }
+
+ private:
+  NetworkRecorder* recorder_;
+  scoped_ptr<net::HttpTransactionFactory> next_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingLayer);
+};
+
+NetworkRecorder::NetworkRecorder(const base::FilePath& archive_path)
+    : archive_path_(archive_path) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  Pickle pickle;
+  NetworkArchive::WriteHeader(&pickle);
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&WriteArchive, archive_path_,
+                 std::string(static_cast<const char*>(pickle.data()),
+                             pickle.size())));
+}
+
+NetworkRecorder::~NetworkRecorder() {
+}
+
+net::HttpTransactionFactory* NetworkRecorder::WrapNetworkLayer(
+    net::HttpTransactionFactory* network_layer) {
+  return new RecordingLayer(this, network_layer);
+}
+
+void NetworkRecorder::Record(const NetworkArchive::Entry& entry) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  Pickle pickle;
+  NetworkArchive::WriteEntry(entry, &pickle);
+  // The FILE thread runs the writes in order, after the header.
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&AppendToArchive, archive_path_,
+                 std::string(static_cast<const char*>(pickle.data()),
+                             pickle.size())));
+}
+
+}  // namespace cameo
@@ -0,0 +1,50 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_NETWORK_RECORDER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_NETWORK_RECORDER_H_
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "cameo/src/runtime/browser/network_archive.h"
+
+namespace net {
+class HttpTransactionFactory;
+}
+
+namespace cameo {
+
+// NetworkRecorder writes every response coming from the network into a
+// NetworkArchive file, with its headers, its body and how long both took.
+// It sits right above the network layers, below the HTTP caches, so what it
+// sees is what the servers sent. Requests are recorded without compression,
+// so replaying them doesn't need any content decoding. Lives on the IO
+// thread and writes the archive from the FILE thread.
+class NetworkRecorder {
+ public:
+  // Starts a new archive at |archive_path|, replacing any existing file.
+  explicit NetworkRecorder(const base::FilePath& archive_path);
+  ~NetworkRecorder();
+
+  // Returns a transaction factory recording the transactions of
+  // |network_layer|, which it takes ownership of. The recorder must outlive
+  // it.
+  net::HttpTransactionFactory* WrapNetworkLayer(
+      net::HttpTransactionFactory* network_layer);
+
+ private:
+  class RecordingLayer;
+  class RecordingTransaction;
+
+  // Appends a response read to its end to the archive.
+  void Record(const NetworkArchive::Entry& entry);
+
+  base::FilePath archive_path_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkRecorder);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_NETWORK_RECORDER_H_
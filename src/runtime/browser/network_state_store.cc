@@ -0,0 +1,233 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/network_state_store.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_number_conversions.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/address_list.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_util.h"
+#include "net/dns/host_cache.h"
+#include "net/http/http_server_properties_impl.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// Bumped when the format changes, the state of other versions is dropped.
+const int kVersion = 1;
+
+// How often the state is written while running.
+const int kWriteIntervalSeconds = 30;
+
+void ReadState(const base::FilePath& path, std::string* data) {
+  // There is nothing to read on the first launch.
+  file_util::ReadFileToString(path, data);
+}
+
+base::ListValue* SerializeAlternateProtocols(
+    const net::AlternateProtocolMap& map) {
+  base::ListValue* list = new base::ListValue;
+  for (net::AlternateProtocolMap::const_iterator it = map.begin();
+       it != map.end(); ++it) {
+    if (it->second.protocol == net::ALTERNATE_PROTOCOL_BROKEN)
+      continue;
+    base::DictionaryValue* server = new base::DictionaryValue;
+    server->SetString("server", it->first.ToString());
+    server->SetInteger("port", it->second.port);
+    server->SetString("protocol",
+                      net::AlternateProtocolToString(it->second.protocol));
+    list->Append(server);
+  }
+  return list;
+}
+
+// Only the successful resolutions are kept, with when they expire.
+base::ListValue* SerializeHostCache(const net::HostCache& host_cache) {
+  base::ListValue* list = new base::ListValue;
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::Time wall_now = base::Time::Now();
+  for (net::HostCache::EntryMap::Iterator it(host_cache.entries());
+       it.HasNext(); it.Advance()) {
+    const net::HostCache::Entry& entry = it.value();
+    if (entry.error != net::OK || it.expiration() <= now)
+      continue;
+    base::ListValue* addresses = new base::ListValue;
+    for (size_t i = 0; i < entry.addrlist.size(); ++i)
+      addresses->AppendString(entry.addrlist[i].ToStringWithoutPort());
+    base::DictionaryValue* host = new base::DictionaryValue;
+    host->SetString("host", it.key().hostname);
+    host->SetInteger("address_family", it.key().address_family);
+    host->SetInteger("flags", it.key().host_resolver_flags);
+    host->Set("addresses", addresses);
+    host->SetString("expiration", base::Int64ToString(
+        (wall_now + (it.expiration() - now)).ToInternalValue()));
+    list->Append(host);
+  }
+  return list;
+}
+
+void RestoreSpdyServers(const base::ListValue& list,
+                        net::HttpServerPropertiesImpl* properties) {
+  for (size_t i = 0; i < list.GetSize(); ++i) {
+    std::string server;
+    if (list.GetString(i, &server))
+      properties->SetSupportsSpdy(net::HostPortPair::FromString(server), true);
+  }
+}
+
+void RestoreAlternateProtocols(const base::ListValue& list,
+                               net::HttpServerPropertiesImpl* properties) {
+  for (size_t i = 0; i < list.GetSize(); ++i) {
+    const base::DictionaryValue* server = NULL;
+    std::string host_port;
+    int port = 0;
+    std::string protocol_name;
+    if (!list.GetDictionary(i, &server) ||
+        !server->GetString("server", &host_port) ||
+        !server->GetInteger("port", &port) ||
+        !server->GetString("protocol", &protocol_name))
+      continue;
+    net::HostPortPair host_port_pair = net::HostPortPair::FromString(host_port);
+    net::AlternateProtocol protocol =
+        net::AlternateProtocolFromString(protocol_name);
+    // What was learned this run is more recent.
+    if (protocol == net::UNINITIALIZED_ALTERNATE_PROTOCOL ||
+        properties->HasAlternateProtocol(host_port_pair))
+      continue;
+    properties->SetAlternateProtocol(host_port_pair,
+                                     static_cast<uint16>(port), protocol);
+  }
+}
+
+void RestoreHostCache(const base::ListValue& list,
+                      net::HostCache* host_cache) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::Time wall_now = base::Time::Now();
+  for (size_t i = 0; i < list.GetSize(); ++i) {
+    const base::DictionaryValue* host = NULL;
+    std::string hostname;
+    int address_family = 0;
+    int flags = 0;
+    const base::ListValue* addresses = NULL;
+    std::string expiration_value;
+    int64 expiration = 0;
+    if (!list.GetDictionary(i, &host) ||
+        !host->GetString("host", &hostname) ||
+        !host->GetInteger("address_family", &address_family) ||
+        !host->GetInteger("flags", &flags) ||
+        !host->GetList("addresses", &addresses) ||
+        !host->GetString("expiration", &expiration_value) ||
+        !base::StringToInt64(expiration_value, &expiration))
+      continue;
+    base::TimeDelta ttl =
+        base::Time::FromInternalValue(expiration) - wall_now;
+    if (ttl <= base::TimeDelta())
+      continue;
+
+    net::AddressList address_list;
+    for (size_t j = 0; j < addresses->GetSize(); ++j) {
+      std::string address;
+      net::IPAddressNumber number;
+      if (addresses->GetString(j, &address) &&
+          net::ParseIPLiteralToNumber(address, &number))
+        address_list.push_back(net::IPEndPoint(number, 0));
+    }
+    if (address_list.empty())
+      continue;
+
+    net::HostCache::Key key(hostname,
+                            static_cast<net::AddressFamily>(address_family),
+                            flags);
+    if (host_cache->Lookup(key, now))
+      continue;
+    host_cache->Set(key, net::HostCache::Entry(net::OK, address_list, ttl),
+                    now, ttl);
+  }
+}
+
+}  // namespace
+
+NetworkStateStore::NetworkStateStore(
+    const base::FilePath& path,
+    net::HttpServerPropertiesImpl* http_server_properties,
+    net::HostCache* host_cache)
+    : http_server_properties_(http_server_properties),
+      host_cache_(host_cache),
+      loaded_(false),
+      writer_(path, BrowserThread::GetMessageLoopProxyForThread(
+          BrowserThread::FILE)),
+      weak_factory_(this) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  std::string* data = new std::string;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&ReadState, path, data),
+      base::Bind(&NetworkStateStore::OnLoaded, weak_factory_.GetWeakPtr(),
+                 base::Owned(data)));
+  write_timer_.Start(FROM_HERE,
+                     base::TimeDelta::FromSeconds(kWriteIntervalSeconds),
+                     this, &NetworkStateStore::Write);
+}
+
+NetworkStateStore::~NetworkStateStore() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  Write();
+}
+
+std::string NetworkStateStore::Serialize() const {
+  base::DictionaryValue state;
+  state.SetInteger("version", kVersion);
+  base::ListValue* spdy_servers = new base::ListValue;
+  http_server_properties_->GetSpdyServerList(spdy_servers);
+  state.Set("spdy_servers", spdy_servers);
+  state.Set("alternate_protocols", SerializeAlternateProtocols(
+      http_server_properties_->alternate_protocol_map()));
+  if (host_cache_)
+    state.Set("host_cache", SerializeHostCache(*host_cache_));
+  std::string data;
+  base::JSONWriter::Write(&state, &data);
+  return data;
+}
+
+void NetworkStateStore::OnLoaded(const std::string* data) {
+  loaded_ = true;
+  if (data->empty())
+    return;
+  scoped_ptr<base::Value> value(base::JSONReader::Read(*data));
+  base::DictionaryValue* state = NULL;
+  int version = 0;
+  if (!value || !value->GetAsDictionary(&state) ||
+      !state->GetInteger("version", &version) || version != kVersion) {
+    LOG(WARNING) << "Ignoring the network state of the previous run.";
+    return;
+  }
+
+  const base::ListValue* list = NULL;
+  if (state->GetList("spdy_servers", &list))
+    RestoreSpdyServers(*list, http_server_properties_);
+  if (state->GetList("alternate_protocols", &list))
+    RestoreAlternateProtocols(*list, http_server_properties_);
+  if (host_cache_ && state->GetList("host_cache", &list))
+    RestoreHostCache(*list, host_cache_);
+}
+
+void NetworkStateStore::Write() {
+  if (loaded_)
+    writer_.WriteNow(Serialize());
+}
+
+}  // namespace cameo
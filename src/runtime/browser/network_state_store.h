@@ -0,0 +1,56 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_NETWORK_STATE_STORE_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_NETWORK_STATE_STORE_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer.h"
+
+namespace net {
+class HostCache;
+class HttpServerPropertiesImpl;
+}
+
+namespace cameo {
+
+// NetworkStateStore keeps what the network stack learned about servers
+// across launches: which servers speak SPDY or an alternate protocol, and
+// the host names resolved recently, as long as they haven't expired. The
+// file is read on the FILE thread once the store is created, and what it
+// holds is added to what was learned meanwhile. The state is written back
+// periodically and when the store is destroyed, unless the file hasn't been
+// read yet. Only lives on the IO thread.
+class NetworkStateStore {
+ public:
+  // |http_server_properties| and |host_cache| must outlive the store.
+  NetworkStateStore(const base::FilePath& path,
+                    net::HttpServerPropertiesImpl* http_server_properties,
+                    net::HostCache* host_cache);
+  ~NetworkStateStore();
+
+ private:
+  void OnLoaded(const std::string* data);
+  std::string Serialize() const;
+  void Write();
+
+  net::HttpServerPropertiesImpl* http_server_properties_;
+  net::HostCache* host_cache_;
+  // Whether the state of the previous run has been read.
+  bool loaded_;
+  base::ImportantFileWriter writer_;
+  base::RepeatingTimer<NetworkStateStore> write_timer_;
+  base::WeakPtrFactory<NetworkStateStore> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkStateStore);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_NETWORK_STATE_STORE_H_
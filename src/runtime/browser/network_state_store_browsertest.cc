@@ -0,0 +1,159 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/run_loop.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/content_browser_client.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_errors.h"
+#include "net/dns/host_cache.h"
+#include "net/dns/host_resolver.h"
+#include "net/http/http_server_properties.h"
+#include "net/test/test_server.h"
+#include "net/url_request/url_request_context.h"
+
+using cameo::RuntimeURLRequestContextGetter;
+using content::BrowserThread;
+
+namespace {
+
+// The test server doesn't speak SPDY, so the first launch is told this
+// server does, as the negotiation with it would have.
+const char kSpdyServer[] = "spdy.test:443";
+
+void BuildContext(RuntimeURLRequestContextGetter* getter,
+                  const base::Closure& done) {
+  getter->GetURLRequestContext();
+  done.Run();
+}
+
+void AddSpdyServer(RuntimeURLRequestContextGetter* getter,
+                   const base::Closure& done) {
+  getter->GetURLRequestContext()->http_server_properties()->SetSupportsSpdy(
+      net::HostPortPair::FromString(kSpdyServer), true);
+  done.Run();
+}
+
+struct LearnedState {
+  LearnedState() : supports_spdy(false), resolved_localhost(false) {}
+
+  bool supports_spdy;
+  bool resolved_localhost;
+};
+
+void GetLearnedState(RuntimeURLRequestContextGetter* getter,
+                     LearnedState* state,
+                     const base::Closure& done) {
+  net::URLRequestContext* context = getter->GetURLRequestContext();
+  state->supports_spdy = context->http_server_properties()->SupportsSpdy(
+      net::HostPortPair::FromString(kSpdyServer));
+  const net::HostCache* host_cache = getter->host_resolver()->GetHostCache();
+  base::TimeTicks now = base::TimeTicks::Now();
+  for (net::HostCache::EntryMap::Iterator it(host_cache->entries());
+       it.HasNext(); it.Advance()) {
+    if (it.key().hostname == "localhost" && it.value().error == net::OK &&
+        it.expiration() > now)
+      state->resolved_localhost = true;
+  }
+  done.Run();
+}
+
+// Lets what was posted to the FILE thread so far run.
+void FlushFileThread() {
+  base::RunLoop run_loop;
+  BrowserThread::PostTaskAndReply(BrowserThread::FILE, FROM_HERE,
+                                  base::Bind(&base::DoNothing),
+                                  run_loop.QuitClosure());
+  run_loop.Run();
+}
+
+void RunClosure(const base::Closure& done) {
+  done.Run();
+}
+
+}  // namespace
+
+// Each launch is a new request context of a default partition on the same
+// directory, as the next run of Cameo would have.
+class NetworkStateStoreTest : public InProcessBrowserTest {
+ public:
+  // Returns once the state of the previous launch has been read.
+  scoped_refptr<RuntimeURLRequestContextGetter> Launch() {
+    content::ProtocolHandlerMap protocol_handlers;
+    scoped_refptr<RuntimeURLRequestContextGetter> getter =
+        new RuntimeURLRequestContextGetter(
+            true, /* ignore_certificate_errors, for the test server */
+            temp_dir_.path(),
+            false,
+            NULL,
+            BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::IO),
+            BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::FILE),
+            &protocol_handlers);
+    cameo_test_utils::RunOnIOThreadAndWait(
+        base::Bind(&BuildContext, getter));
+    FlushFileThread();
+    cameo_test_utils::RunOnIOThreadAndWait(base::Bind(&RunClosure));
+    return getter;
+  }
+
+  // Returns once the state has been written.
+  void Shutdown(scoped_refptr<RuntimeURLRequestContextGetter>* getter) {
+    // The getter is deleted on the IO thread.
+    *getter = NULL;
+    cameo_test_utils::RunOnIOThreadAndWait(base::Bind(&RunClosure));
+    FlushFileThread();
+  }
+
+  // Returns how long fetching |url| through |getter| took.
+  base::TimeDelta Fetch(RuntimeURLRequestContextGetter* getter,
+                        const GURL& url) {
+    base::TimeTicks start = base::TimeTicks::Now();
+    cameo_test_utils::FetchURL(getter, url);
+    return base::TimeTicks::Now() - start;
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+};
+
+IN_PROC_BROWSER_TEST_F(NetworkStateStoreTest, RelaunchBenchmark) {
+  ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  net::TestServer https_server(
+      net::TestServer::TYPE_HTTPS,
+      net::TestServer::SSLOptions(),
+      base::FilePath(FILE_PATH_LITERAL("cameo/src/test/data")));
+  ASSERT_TRUE(https_server.Start());
+  // Going through the host resolver, unlike 127.0.0.1.
+  GURL url = https_server.GetURLWithHostName("title.html", "localhost");
+
+  scoped_refptr<RuntimeURLRequestContextGetter> getter = Launch();
+  base::TimeDelta cold = Fetch(getter, url);
+  cameo_test_utils::RunOnIOThreadAndWait(base::Bind(&AddSpdyServer, getter));
+  Shutdown(&getter);
+
+  getter = Launch();
+  LearnedState state;
+  cameo_test_utils::RunOnIOThreadAndWait(
+      base::Bind(&GetLearnedState, getter, &state));
+  EXPECT_TRUE(state.supports_spdy);
+  EXPECT_TRUE(state.resolved_localhost);
+  base::TimeDelta relaunched = Fetch(getter, url);
+  Shutdown(&getter);
+
+  cameo_test_utils::PrintPerfResult("relaunch_first_request", "cold",
+                                    cold.InMillisecondsF(), "ms");
+  cameo_test_utils::PrintPerfResult("relaunch_first_request", "persisted",
+                                    relaunched.InMillisecondsF(), "ms");
+}
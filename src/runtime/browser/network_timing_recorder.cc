@@ -0,0 +1,235 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/values.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/base/load_timing_info.h"
+#include "net/http/http_response_headers.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_status.h"
+
+namespace cameo {
+
+namespace {
+
+// The upper bounds, in milliseconds, of the buckets of a Histogram: powers of
+// the square root of 2. Longer durations go to an overflow bucket.
+const int64 kBucketLimits[] = {
+  1, 2, 3, 4, 6, 8, 11, 16, 23, 32, 45, 64, 91, 128, 181, 256, 362, 512, 724,
+  1024, 1448, 2048, 2896, 4096, 5793, 8192, 11585, 16384, 23170, 32768, 46341,
+  65536,
+};
+
+const char* const kPhaseNames[] = {
+  "queued",
+  "dns",
+  "connect",
+  "ssl",
+  "first_byte",
+  "total",
+};
+
+COMPILE_ASSERT(arraysize(kPhaseNames) == NetworkTimingRecorder::PHASE_COUNT,
+               phase_names_mismatch);
+
+}  // namespace
+
+NetworkTimingRecorder::Histogram::Histogram()
+    : count_(0),
+      sum_(0),
+      max_(0) {
+  COMPILE_ASSERT(arraysize(kBucketLimits) == kBucketCount,
+                 bucket_limits_mismatch);
+  std::fill(buckets_, buckets_ + arraysize(buckets_), 0);
+}
+
+void NetworkTimingRecorder::Histogram::Add(base::TimeDelta duration) {
+  int64 value = std::max<int64>(duration.InMilliseconds(), 0);
+  size_t bucket = std::lower_bound(kBucketLimits, kBucketLimits + kBucketCount,
+                                   value) - kBucketLimits;
+  ++buckets_[bucket];
+  ++count_;
+  sum_ += value;
+  max_ = std::max(max_, value);
+}
+
+int64 NetworkTimingRecorder::Histogram::GetPercentile(
+    double percentile) const {
+  if (!count_)
+    return 0;
+
+  int64 rank = static_cast<int64>(percentile * count_ / 100.0 + 0.5);
+  rank = std::max<int64>(rank, 1);
+  int64 seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank)
+      return std::min(kBucketLimits[i], max_);
+  }
+  return max_;
+}
+
+base::DictionaryValue* NetworkTimingRecorder::Histogram::ToValue() const {
+  base::DictionaryValue* value = new base::DictionaryValue;
+  // Doubles, as base::Value has no 64-bit integers.
+  value->SetDouble("count", count_);
+  value->SetDouble("mean_ms", count_ ? static_cast<double>(sum_) / count_ : 0);
+  value->SetDouble("p50_ms", GetPercentile(50));
+  value->SetDouble("p90_ms", GetPercentile(90));
+  value->SetDouble("p99_ms", GetPercentile(99));
+  value->SetDouble("max_ms", max_);
+
+  // Only the buckets which got a value, as [upper bound, count] pairs, the
+  // overflow bucket having a null bound.
+  base::ListValue* buckets = new base::ListValue;
+  for (size_t i = 0; i <= kBucketCount; ++i) {
+    if (!buckets_[i])
+      continue;
+    base::ListValue* bucket = new base::ListValue;
+    if (i < kBucketCount)
+      bucket->AppendDouble(kBucketLimits[i]);
+    else
+      bucket->Append(base::Value::CreateNullValue());
+    bucket->AppendDouble(buckets_[i]);
+    buckets->Append(bucket);
+  }
+  value->Set("buckets", buckets);
+  return value;
+}
+
+NetworkTimingRecorder::OwnerStats::OwnerStats()
+    : requests(0),
+      failed_requests(0),
+      cached_requests(0),
+      bytes_read(0),
+      sdch_requests(0),
+      sdch_bytes_read(0) {
+}
+
+NetworkTimingRecorder::NetworkTimingRecorder() {
+}
+
+NetworkTimingRecorder::~NetworkTimingRecorder() {
+}
+
+void NetworkTimingRecorder::OnResponseStarted(
+    const net::URLRequest& request) {
+  pending_requests_[&request].response_start = base::TimeTicks::Now();
+}
+
+void NetworkTimingRecorder::OnRawBytesRead(const net::URLRequest& request,
+                                           int bytes_read) {
+  pending_requests_[&request].bytes_read += bytes_read;
+}
+
+void NetworkTimingRecorder::OnCompleted(const net::URLRequest& request) {
+  PendingRequest pending;
+  PendingRequestMap::iterator it = pending_requests_.find(&request);
+  if (it != pending_requests_.end()) {
+    pending = it->second;
+    pending_requests_.erase(it);
+  }
+
+  OwnerStats& stats = owners_[GetOwnerId(request)];
+  stats.origin = request.first_party_for_cookies().GetOrigin().spec();
+  ++stats.requests;
+  if (!request.status().is_success())
+    ++stats.failed_requests;
+  if (request.was_cached())
+    ++stats.cached_requests;
+  stats.bytes_read += pending.bytes_read;
+  const net::HttpResponseHeaders* headers = request.response_headers();
+  if (headers && headers->HasHeaderValue("content-encoding", "sdch")) {
+    ++stats.sdch_requests;
+    stats.sdch_bytes_read += pending.bytes_read;
+  }
+
+  net::LoadTimingInfo timing;
+  request.GetLoadTimingInfo(&timing);
+  if (timing.request_start.is_null())
+    return;
+
+  stats.phases[PHASE_QUEUED].Add(timing.request_start -
+                                 request.creation_time());
+  // The connect times are only there if the request opened a new socket.
+  const net::LoadTimingInfo::ConnectTiming& connect = timing.connect_timing;
+  if (!connect.dns_start.is_null() && !connect.dns_end.is_null())
+    stats.phases[PHASE_DNS].Add(connect.dns_end - connect.dns_start);
+  if (!connect.connect_start.is_null() && !connect.connect_end.is_null()) {
+    base::TimeDelta connect_time = connect.connect_end - connect.connect_start;
+    if (!connect.ssl_start.is_null() && !connect.ssl_end.is_null()) {
+      base::TimeDelta ssl_time = connect.ssl_end - connect.ssl_start;
+      stats.phases[PHASE_SSL].Add(ssl_time);
+      connect_time -= ssl_time;
+    }
+    stats.phases[PHASE_CONNECT].Add(connect_time);
+  }
+  if (!pending.response_start.is_null()) {
+    stats.phases[PHASE_FIRST_BYTE].Add(pending.response_start -
+                                       timing.request_start);
+  }
+  stats.phases[PHASE_TOTAL].Add(base::TimeTicks::Now() -
+                                timing.request_start);
+}
+
+void NetworkTimingRecorder::OnURLRequestDestroyed(
+    const net::URLRequest& request) {
+  pending_requests_.erase(&request);
+}
+
+scoped_ptr<base::ListValue> NetworkTimingRecorder::GetAsValue() const {
+  scoped_ptr<base::ListValue> list(new base::ListValue);
+  for (std::map<OwnerId, OwnerStats>::const_iterator it = owners_.begin();
+       it != owners_.end(); ++it) {
+    const OwnerStats& stats = it->second;
+    base::DictionaryValue* owner = new base::DictionaryValue;
+    owner->SetInteger("render_process_id", it->first.first);
+    owner->SetInteger("render_view_id", it->first.second);
+    owner->SetString("origin", stats.origin);
+    owner->SetDouble("requests", stats.requests);
+    owner->SetDouble("failed_requests", stats.failed_requests);
+    owner->SetDouble("cached_requests", stats.cached_requests);
+    owner->SetDouble("bytes_read", stats.bytes_read);
+    owner->SetDouble("sdch_requests", stats.sdch_requests);
+    owner->SetDouble("sdch_bytes_read", stats.sdch_bytes_read);
+
+    base::DictionaryValue* phases = new base::DictionaryValue;
+    for (int i = 0; i < PHASE_COUNT; ++i)
+      phases->Set(kPhaseNames[i], stats.phases[i].ToValue());
+    owner->Set("phases", phases);
+    list->Append(owner);
+  }
+  return list.Pass();
+}
+
+void NetworkTimingRecorder::GetBytesReadByOwner(ByteCountMap* bytes) const {
+  bytes->clear();
+  for (std::map<OwnerId, OwnerStats>::const_iterator it = owners_.begin();
+       it != owners_.end(); ++it)
+    (*bytes)[it->first] = it->second.bytes_read;
+  // The requests are only attributed once they complete, those in flight are
+  // still alive.
+  for (PendingRequestMap::const_iterator it = pending_requests_.begin();
+       it != pending_requests_.end(); ++it)
+    (*bytes)[GetOwnerId(*it->first)] += it->second.bytes_read;
+}
+
+// static
+NetworkTimingRecorder::OwnerId NetworkTimingRecorder::GetOwnerId(
+    const net::URLRequest& request) {
+  int render_process_id = -1;
+  int render_view_id = -1;
+  if (!content::ResourceRequestInfo::GetRenderViewForRequest(
+          &request, &render_process_id, &render_view_id)) {
+    return OwnerId(-1, -1);
+  }
+  return OwnerId(render_process_id, render_view_id);
+}
+
+}  // namespace cameo
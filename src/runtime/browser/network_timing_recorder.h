@@ -0,0 +1,131 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_NETWORK_TIMING_RECORDER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_NETWORK_TIMING_RECORDER_H_
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time.h"
+
+namespace base {
+class DictionaryValue;
+class ListValue;
+}
+
+namespace net {
+class URLRequest;
+}
+
+namespace cameo {
+
+// NetworkTimingRecorder aggregates how long the requests of every Runtime
+// spend in each phase of their life, and how much they read. The requests are
+// attributed to the render view which issued them, requests of the browser
+// process being kept apart.
+//
+// It is fed by RuntimeNetworkDelegate and, like it, only lives on the IO
+// thread: the histograms are plain counters, with no lock or atomic on the
+// request path. They are read by posting a task to the IO thread.
+class NetworkTimingRecorder {
+ public:
+  enum Phase {
+    // From the creation of the request until it is started, e.g. while the
+    // resource scheduler holds it back.
+    PHASE_QUEUED,
+    PHASE_DNS,
+    // The TCP connect, excluding DNS and SSL.
+    PHASE_CONNECT,
+    PHASE_SSL,
+    // From the start of the request until its response starts.
+    PHASE_FIRST_BYTE,
+    PHASE_TOTAL,
+    PHASE_COUNT,
+  };
+
+  // A histogram of durations with exponential buckets, from 1ms to about a
+  // minute. Percentiles are estimated with the upper bound of their bucket.
+  class Histogram {
+   public:
+    Histogram();
+
+    void Add(base::TimeDelta duration);
+    int64 GetPercentile(double percentile) const;
+    int64 count() const { return count_; }
+
+    base::DictionaryValue* ToValue() const;
+
+   private:
+    static const size_t kBucketCount = 32;
+
+    int64 buckets_[kBucketCount + 1];
+    int64 count_;
+    int64 sum_;
+    int64 max_;
+  };
+
+  // A render process id and render view id, both -1 for the browser.
+  typedef std::pair<int, int> OwnerId;
+  typedef std::map<OwnerId, int64> ByteCountMap;
+
+  NetworkTimingRecorder();
+  ~NetworkTimingRecorder();
+
+  void OnResponseStarted(const net::URLRequest& request);
+  void OnRawBytesRead(const net::URLRequest& request, int bytes_read);
+  void OnCompleted(const net::URLRequest& request);
+  void OnURLRequestDestroyed(const net::URLRequest& request);
+
+  // Returns the stats of every render view, and of the browser process, as
+  // a list of dictionaries with "render_process_id", "render_view_id",
+  // "origin", the request counters and a histogram per phase.
+  scoped_ptr<base::ListValue> GetAsValue() const;
+
+  // Fills |bytes| with what the requests of every render view, and of the
+  // browser process, read from the network or the cache so far, including
+  // the requests still in flight.
+  void GetBytesReadByOwner(ByteCountMap* bytes) const;
+
+ private:
+  struct OwnerStats {
+    OwnerStats();
+
+    // The origin of the page which issued the last request.
+    std::string origin;
+    int64 requests;
+    int64 failed_requests;
+    int64 cached_requests;
+    int64 bytes_read;
+    // The responses encoded with a shared dictionary, and what they read
+    // from the network, included in the counters above.
+    int64 sdch_requests;
+    int64 sdch_bytes_read;
+    Histogram phases[PHASE_COUNT];
+  };
+
+  // What is known about a request until it completes.
+  struct PendingRequest {
+    PendingRequest() : bytes_read(0) {}
+
+    base::TimeTicks response_start;
+    int64 bytes_read;
+  };
+
+  typedef std::map<const net::URLRequest*, PendingRequest> PendingRequestMap;
+
+  static OwnerId GetOwnerId(const net::URLRequest& request);
+
+  std::map<OwnerId, OwnerStats> owners_;
+  PendingRequestMap pending_requests_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkTimingRecorder);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_NETWORK_TIMING_RECORDER_H_
@@ -0,0 +1,70 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/run_loop.h"
+#include "base/values.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/web_contents.h"
+
+namespace {
+
+void OnNetworkTimings(std::string* result, const base::Closure& done,
+                      const std::string& json) {
+  *result = json;
+  done.Run();
+}
+
+}  // namespace
+
+class NetworkTimingRecorderTest : public InProcessBrowserTest {
+ public:
+  scoped_ptr<base::Value> GetNetworkTimings() {
+    std::string json;
+    base::RunLoop run_loop;
+    runtime()->runtime_context()->GetNetworkTimingsAsJSON(
+        base::Bind(&OnNetworkTimings, &json, run_loop.QuitClosure()));
+    run_loop.Run();
+    return scoped_ptr<base::Value>(base::JSONReader::Read(json));
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(NetworkTimingRecorderTest, AttributesToRuntime) {
+  GURL url = cameo_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII("title.html"));
+  cameo_test_utils::NavigateToURL(runtime(), url);
+
+  scoped_ptr<base::Value> timings = GetNetworkTimings();
+  base::ListValue* owners = NULL;
+  ASSERT_TRUE(timings && timings->GetAsList(&owners));
+
+  // The page is attributed to the render view of the Runtime showing it.
+  base::DictionaryValue* owner = NULL;
+  for (size_t i = 0; i < owners->GetSize(); ++i) {
+    base::DictionaryValue* candidate = NULL;
+    std::string runtime_url;
+    if (owners->GetDictionary(i, &candidate) &&
+        candidate->GetString("runtime_url", &runtime_url) &&
+        runtime_url == url.spec())
+      owner = candidate;
+  }
+  ASSERT_TRUE(owner);
+
+  double requests = 0;
+  double bytes_read = 0;
+  double total_count = 0;
+  EXPECT_TRUE(owner->GetDouble("requests", &requests));
+  EXPECT_TRUE(owner->GetDouble("bytes_read", &bytes_read));
+  EXPECT_TRUE(owner->GetDouble("phases.total.count", &total_count));
+  EXPECT_GE(requests, 1);
+  EXPECT_GT(bytes_read, 0);
+  EXPECT_GE(total_count, 1);
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
+
+#include "base/memory/scoped_ptr.h"
+#include "base/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using cameo::NetworkTimingRecorder;
+
+namespace {
+
+base::TimeDelta Milliseconds(int64 ms) {
+  return base::TimeDelta::FromMilliseconds(ms);
+}
+
+}  // namespace
+
+TEST(NetworkTimingRecorderTest, EmptyHistogram) {
+  NetworkTimingRecorder::Histogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.GetPercentile(50));
+  EXPECT_EQ(0, histogram.GetPercentile(99));
+}
+
+// The percentiles are the upper bounds of the buckets they fall in, no more
+// than the largest sample.
+TEST(NetworkTimingRecorderTest, Percentiles) {
+  NetworkTimingRecorder::Histogram histogram;
+  for (int64 ms = 1; ms <= 100; ++ms)
+    histogram.Add(Milliseconds(ms));
+  EXPECT_EQ(100, histogram.count());
+
+  // The 50th sample is in (45, 64], the 90th in (64, 91], the 99th in
+  // (91, 128].
+  EXPECT_EQ(64, histogram.GetPercentile(50));
+  EXPECT_EQ(91, histogram.GetPercentile(90));
+  EXPECT_EQ(100, histogram.GetPercentile(99));
+  // The rank is rounded, and never below the first sample.
+  EXPECT_EQ(1, histogram.GetPercentile(0));
+  EXPECT_EQ(100, histogram.GetPercentile(100));
+
+  scoped_ptr<base::DictionaryValue> value(histogram.ToValue());
+  double mean = 0;
+  ASSERT_TRUE(value->GetDouble("mean_ms", &mean));
+  EXPECT_DOUBLE_EQ(50.5, mean);
+  double p90 = 0;
+  ASSERT_TRUE(value->GetDouble("p90_ms", &p90));
+  EXPECT_DOUBLE_EQ(91, p90);
+}
+
+TEST(NetworkTimingRecorderTest, SkewedPercentiles) {
+  // 98 fast requests and 2 slow ones.
+  NetworkTimingRecorder::Histogram histogram;
+  for (int i = 0; i < 98; ++i)
+    histogram.Add(Milliseconds(3));
+  histogram.Add(Milliseconds(700));
+  histogram.Add(Milliseconds(1000));
+
+  EXPECT_EQ(3, histogram.GetPercentile(50));
+  EXPECT_EQ(3, histogram.GetPercentile(90));
+  // The 99th sample is in (512, 724].
+  EXPECT_EQ(724, histogram.GetPercentile(99));
+}
+
+TEST(NetworkTimingRecorderTest, OverflowAndNegativeSamples) {
+  NetworkTimingRecorder::Histogram histogram;
+  // Clamped to 0, in the first bucket.
+  histogram.Add(Milliseconds(-5));
+  EXPECT_EQ(0, histogram.GetPercentile(50));
+
+  // Past the last bucket, the percentile is the largest sample.
+  histogram.Add(Milliseconds(100000));
+  histogram.Add(Milliseconds(200000));
+  EXPECT_EQ(200000, histogram.GetPercentile(99));
+
+  scoped_ptr<base::DictionaryValue> value(histogram.ToValue());
+  base::ListValue* buckets = NULL;
+  ASSERT_TRUE(value->GetList("buckets", &buckets));
+  // The first bucket and the overflow one, whose bound is null.
+  ASSERT_EQ(2u, buckets->GetSize());
+  base::ListValue* overflow = NULL;
+  ASSERT_TRUE(buckets->GetList(1, &overflow));
+  const base::Value* bound = NULL;
+  ASSERT_TRUE(overflow->Get(0, &bound));
+  EXPECT_TRUE(bound->IsType(base::Value::TYPE_NULL));
+  double count = 0;
+  ASSERT_TRUE(overflow->GetDouble(1, &count));
+  EXPECT_DOUBLE_EQ(2, count);
+}
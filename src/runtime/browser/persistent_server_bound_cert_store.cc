@@ -0,0 +1,154 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/persistent_server_bound_cert_store.h"
+
+#include "base/base64.h"
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/string_number_conversions.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/ssl/ssl_client_cert_type.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+typedef net::DefaultServerBoundCertStore::ServerBoundCert ServerBoundCert;
+
+void ReadCerts(const base::FilePath& path, std::string* data) {
+  // There is nothing to read on the first launch.
+  file_util::ReadFileToString(path, data);
+}
+
+base::DictionaryValue* SerializeCert(const ServerBoundCert& cert) {
+  std::string private_key;
+  std::string der_cert;
+  base::Base64Encode(cert.private_key(), &private_key);
+  base::Base64Encode(cert.cert(), &der_cert);
+  base::DictionaryValue* value = new base::DictionaryValue;
+  value->SetString("server", cert.server_identifier());
+  value->SetInteger("type", cert.type());
+  value->SetString("creation_time",
+                   base::Int64ToString(cert.creation_time().ToInternalValue()));
+  value->SetString(
+      "expiration_time",
+      base::Int64ToString(cert.expiration_time().ToInternalValue()));
+  value->SetString("private_key", private_key);
+  value->SetString("cert", der_cert);
+  return value;
+}
+
+ServerBoundCert* DeserializeCert(const base::DictionaryValue& value) {
+  std::string server;
+  int type = 0;
+  std::string creation_time;
+  std::string expiration_time;
+  std::string private_key;
+  std::string der_cert;
+  int64 creation = 0;
+  int64 expiration = 0;
+  if (!value.GetString("server", &server) ||
+      !value.GetInteger("type", &type) ||
+      !value.GetString("creation_time", &creation_time) ||
+      !value.GetString("expiration_time", &expiration_time) ||
+      !value.GetString("private_key", &private_key) ||
+      !value.GetString("cert", &der_cert) ||
+      !base::StringToInt64(creation_time, &creation) ||
+      !base::StringToInt64(expiration_time, &expiration) ||
+      !base::Base64Decode(private_key, &private_key) ||
+      !base::Base64Decode(der_cert, &der_cert))
+    return NULL;
+  return new ServerBoundCert(server,
+                             static_cast<net::SSLClientCertType>(type),
+                             base::Time::FromInternalValue(creation),
+                             base::Time::FromInternalValue(expiration),
+                             private_key,
+                             der_cert);
+}
+
+}  // namespace
+
+PersistentServerBoundCertStore::PersistentServerBoundCertStore(
+    const base::FilePath& path)
+    : path_(path),
+      writer_(path, BrowserThread::GetMessageLoopProxyForThread(
+          BrowserThread::FILE)) {
+}
+
+PersistentServerBoundCertStore::~PersistentServerBoundCertStore() {
+  if (writer_.HasPendingWrite())
+    writer_.DoScheduledWrite();
+}
+
+void PersistentServerBoundCertStore::Load(
+    const LoadedCallback& loaded_callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  std::string* data = new std::string;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&ReadCerts, path_, data),
+      base::Bind(&PersistentServerBoundCertStore::OnLoaded, this,
+                 loaded_callback, base::Owned(data)));
+}
+
+void PersistentServerBoundCertStore::AddServerBoundCert(
+    const ServerBoundCert& cert) {
+  certs_[cert.server_identifier()] = cert;
+  writer_.ScheduleWrite(this);
+}
+
+void PersistentServerBoundCertStore::DeleteServerBoundCert(
+    const ServerBoundCert& cert) {
+  certs_.erase(cert.server_identifier());
+  writer_.ScheduleWrite(this);
+}
+
+void PersistentServerBoundCertStore::SetForceKeepSessionState() {
+  // Nothing is cleared at shutdown anyway.
+}
+
+bool PersistentServerBoundCertStore::SerializeData(std::string* data) {
+  base::ListValue certs;
+  for (CertMap::const_iterator it = certs_.begin(); it != certs_.end(); ++it)
+    certs.Append(SerializeCert(it->second));
+  base::JSONWriter::Write(&certs, data);
+  return true;
+}
+
+void PersistentServerBoundCertStore::OnLoaded(
+    const LoadedCallback& loaded_callback,
+    const std::string* data) {
+  scoped_ptr<ScopedVector<ServerBoundCert> > certs(
+      new ScopedVector<ServerBoundCert>);
+  scoped_ptr<base::Value> value;
+  if (!data->empty())
+    value.reset(base::JSONReader::Read(*data));
+  base::ListValue* list = NULL;
+  if (value && value->GetAsList(&list)) {
+    for (size_t i = 0; i < list->GetSize(); ++i) {
+      base::DictionaryValue* cert_value = NULL;
+      ServerBoundCert* cert = list->GetDictionary(i, &cert_value) ?
+          DeserializeCert(*cert_value) : NULL;
+      if (!cert)
+        continue;
+      certs_[cert->server_identifier()] = *cert;
+      certs->push_back(cert);
+    }
+  } else if (!data->empty()) {
+    LOG(WARNING) << "Ignoring the unreadable channel ID certificates in "
+                 << path_.value();
+  }
+  loaded_callback.Run(certs.Pass());
+}
+
+}  // namespace cameo
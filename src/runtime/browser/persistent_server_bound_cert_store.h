@@ -0,0 +1,60 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_PERSISTENT_SERVER_BOUND_CERT_STORE_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_PERSISTENT_SERVER_BOUND_CERT_STORE_H_
+
+#include <map>
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "net/ssl/default_server_bound_cert_store.h"
+
+namespace cameo {
+
+// Keeps the channel ID certificates of net::DefaultServerBoundCertStore in a
+// file, so that servers see the same ones across launches instead of new
+// ones being generated. The file is read on the FILE thread when the
+// certificates are first needed, and written back a while after they change
+// and when the store is destroyed. Only used on the IO thread.
+class PersistentServerBoundCertStore
+    : public net::DefaultServerBoundCertStore::PersistentStore,
+      public base::ImportantFileWriter::DataSerializer {
+ public:
+  explicit PersistentServerBoundCertStore(const base::FilePath& path);
+
+  // net::DefaultServerBoundCertStore::PersistentStore implementation.
+  virtual void Load(const LoadedCallback& loaded_callback) OVERRIDE;
+  virtual void AddServerBoundCert(
+      const net::DefaultServerBoundCertStore::ServerBoundCert& cert) OVERRIDE;
+  virtual void DeleteServerBoundCert(
+      const net::DefaultServerBoundCertStore::ServerBoundCert& cert) OVERRIDE;
+  virtual void SetForceKeepSessionState() OVERRIDE;
+
+  // base::ImportantFileWriter::DataSerializer implementation.
+  virtual bool SerializeData(std::string* data) OVERRIDE;
+
+ private:
+  typedef std::map<std::string,
+                   net::DefaultServerBoundCertStore::ServerBoundCert>
+      CertMap;
+
+  virtual ~PersistentServerBoundCertStore();
+
+  void OnLoaded(const LoadedCallback& loaded_callback,
+                const std::string* data);
+
+  base::FilePath path_;
+  // By server identifier.
+  CertMap certs_;
+  base::ImportantFileWriter writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(PersistentServerBoundCertStore);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_PERSISTENT_SERVER_BOUND_CERT_STORE_H_
@@ -0,0 +1,106 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_PROCESS_SINGLETON_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_PROCESS_SINGLETON_H_
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/non_thread_safe.h"
+
+namespace cameo {
+
+// ProcessSingleton makes sure that only one browser process runs per data
+// path. The first process listening on a Unix domain socket in the data path
+// is the owner; any later launch forwards its command line to the owner over
+// that socket and exits, so that the already initialized browser process can
+// open the app in a new Runtime instead of paying the full startup cost.
+//
+// Only built on Linux, see switches::kProcessSingleton.
+class ProcessSingleton : public base::NonThreadSafe {
+ public:
+  enum NotifyResult {
+    // No other process was found, this process is now the singleton.
+    PROCESS_NONE,
+    // The command line was handed to the running process, which replied
+    // whether or not it could handle it.
+    PROCESS_NOTIFIED,
+    // The running process didn't respond, and the socket couldn't be taken
+    // over either.
+    PROCESS_ERROR,
+  };
+
+  // Called on the UI thread of the owning process with the forwarded command
+  // line and the working directory of the process that sent it. Returns true
+  // if the command line has been handled.
+  typedef base::Callback<bool(const CommandLine& command_line,
+                              const base::FilePath& current_directory)>
+      NotificationCallback;
+
+  ProcessSingleton(const base::FilePath& data_path,
+                   const NotificationCallback& notification_callback);
+  ~ProcessSingleton();
+
+  // Hands the current command line to the running process if any, otherwise
+  // takes the ownership of the data path for this process.
+  NotifyResult NotifyOtherProcessOrCreate();
+
+  // Only tries to hand the current command line to the running process.
+  NotifyResult NotifyOtherProcess();
+
+  // Takes the lock of the data path and sets up the listening socket.
+  // Returns false if another process holds the lock or the socket can't be
+  // bound. Must be called before the main message loop starts; connections
+  // are accepted once StartListening() is called after the IO thread is up.
+  bool Create();
+
+  // Starts accepting forwarded command lines on the IO thread.
+  void StartListening();
+
+  // Stops listening, removes the socket from the data path and releases the
+  // lock.
+  void Cleanup();
+
+  const base::FilePath& socket_path() const { return socket_path_; }
+
+ private:
+  class LinuxWatcher;
+
+  enum LockResult {
+    LOCK_ACQUIRED,
+    // Another process holds the lock.
+    LOCK_HELD,
+    LOCK_ERROR,
+  };
+
+  // Takes the lock file of the data path, which the singleton holds for as
+  // long as it runs. The kernel releases it if the process dies, so whoever
+  // holds it may replace a stale socket.
+  LockResult Lock();
+
+  // Called on the UI thread when a command line has been received.
+  bool ProcessCommandLine(const CommandLine& command_line,
+                          const base::FilePath& current_directory);
+
+  base::FilePath socket_path_;
+  base::FilePath lock_path_;
+  NotificationCallback notification_callback_;
+
+  // The open lock file, -1 if this process doesn't hold the lock.
+  int lock_fd_;
+
+  // The listening socket, -1 if this process isn't the singleton.
+  int sock_;
+
+  scoped_refptr<LinuxWatcher> watcher_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessSingleton);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_PROCESS_SINGLETON_H_
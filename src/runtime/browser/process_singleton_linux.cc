@@ -0,0 +1,577 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// On Linux, the singleton is a Unix domain socket named SingletonSocket in the
+// data path. A second launch connects to the socket and writes
+//
+//   START\0<current working dir>\0<argv[0]>\0<argv[1]>...
+//
+// then shuts down its writing end. The browser process hands the command line
+// to the UI thread, and once it has been handled replies with "ACK", after
+// which the second process exits. If the command line couldn't be handled,
+// e.g. it is malformed, the reply is "NACK" and the second process exits as
+// well: running it standalone wouldn't do any better.
+//
+// The singleton also holds an flock() on SingletonLock in the data path for
+// as long as it runs. Only the holder of the lock may remove and bind the
+// socket, so that two processes launched at the same time can't both become
+// the singleton. If nobody is listening and the lock is free, the socket is
+// stale and is replaced by the new process; if the lock is held, the holder
+// is about to listen and the connection is retried.
+
+#include "cameo/src/runtime/browser/process_singleton.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/stl_util.h"
+#include "base/string_util.h"
+#include "base/threading/platform_thread.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/net_util.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+const char kSingletonSocketFilename[] = "SingletonSocket";
+const char kSingletonLockFilename[] = "SingletonLock";
+const char kStartToken[] = "START";
+const char kACKToken[] = "ACK";
+const char kNACKToken[] = "NACK";
+const char kTokenDelimiter = '\0';
+const int kTimeoutInSeconds = 20;
+const int kRetryDelayInMilliseconds = 100;
+const size_t kMaxMessageLength = 32 * 1024;
+const size_t kReadBufferSize = 4096;
+
+bool SetupSockAddr(const std::string& path, struct sockaddr_un* addr) {
+  if (path.length() >= sizeof(addr->sun_path)) {
+    LOG(ERROR) << "Socket path is too long: " << path;
+    return false;
+  }
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  base::strlcpy(addr->sun_path, path.c_str(), sizeof(addr->sun_path));
+  return true;
+}
+
+void CloseFileDescriptor(int fd) {
+  if (fd >= 0 && HANDLE_EINTR(close(fd)) < 0)
+    PLOG(ERROR) << "close() failed";
+}
+
+void SetSocketTimeout(int fd, int timeout_in_seconds) {
+  struct timeval timeout = { timeout_in_seconds, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+bool WriteToSocket(int fd, const char* message, size_t length) {
+  size_t bytes_written = 0;
+  while (bytes_written < length) {
+    ssize_t rv = HANDLE_EINTR(
+        write(fd, message + bytes_written, length - bytes_written));
+    if (rv < 0) {
+      PLOG(ERROR) << "write() failed";
+      return false;
+    }
+    bytes_written += rv;
+  }
+  return true;
+}
+
+// Splits |message| on the token delimiter. Unlike base::SplitString, this
+// keeps leading and trailing whitespace which may be part of a file name.
+void SplitMessage(const std::string& message,
+                  std::vector<std::string>* tokens) {
+  tokens->clear();
+  size_t begin = 0;
+  while (begin <= message.length()) {
+    size_t end = message.find(kTokenDelimiter, begin);
+    if (end == std::string::npos)
+      end = message.length();
+    tokens->push_back(message.substr(begin, end - begin));
+    begin = end + 1;
+  }
+}
+
+}  // namespace
+
+// Accepts connections on the singleton socket and reads the forwarded command
+// lines. Lives on the IO thread.
+class ProcessSingleton::LinuxWatcher
+    : public base::MessageLoopForIO::Watcher,
+      public base::RefCountedThreadSafe<ProcessSingleton::LinuxWatcher,
+                                        BrowserThread::DeleteOnIOThread> {
+ public:
+  explicit LinuxWatcher(ProcessSingleton* parent)
+      : parent_(parent),
+        listen_fd_(-1) {
+  }
+
+  // Starts watching |socket| for new connections. Called on the IO thread,
+  // the watcher takes the ownership of |socket|.
+  void StartListening(int socket);
+
+  // Stops accepting connections and closes the listening socket. Called on
+  // the IO thread.
+  void StopListening();
+
+  // Detaches the watcher from its ProcessSingleton. Called on the UI thread.
+  void ClearParent() { parent_ = NULL; }
+
+  // base::MessageLoopForIO::Watcher implementation.
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE;
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE {
+    NOTREACHED();
+  }
+
+ private:
+  class SocketReader;
+  friend struct BrowserThread::DeleteOnThread<BrowserThread::IO>;
+  friend class base::DeleteHelper<ProcessSingleton::LinuxWatcher>;
+
+  virtual ~LinuxWatcher() {
+    DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+    STLDeleteElements(&readers_);
+    CloseFileDescriptor(listen_fd_);
+  }
+
+  // Called on the IO thread by |reader| once a full message is read.
+  void HandleMessage(const std::string& current_dir,
+                     const std::vector<std::string>& argv,
+                     SocketReader* reader);
+
+  // Runs the command line on the UI thread, then replies to |reader|.
+  void HandleMessageOnUIThread(const std::string& current_dir,
+                               const std::vector<std::string>& argv,
+                               SocketReader* reader);
+
+  // Replies |reply| to the sender on the IO thread if |reader| is still
+  // alive. An empty |reply| only closes the connection.
+  void FinishWithReply(SocketReader* reader, const std::string& reply);
+
+  // Removes and deletes |reader|.
+  void RemoveSocketReader(SocketReader* reader);
+
+  // Accessed only on the UI thread.
+  ProcessSingleton* parent_;
+
+  int listen_fd_;
+  base::MessageLoopForIO::FileDescriptorWatcher fd_watcher_;
+  std::set<SocketReader*> readers_;
+
+  DISALLOW_COPY_AND_ASSIGN(LinuxWatcher);
+};
+
+// Reads one message from an accepted connection. Lives on the IO thread and is
+// owned by the LinuxWatcher.
+class ProcessSingleton::LinuxWatcher::SocketReader
+    : public base::MessageLoopForIO::Watcher {
+ public:
+  SocketReader(ProcessSingleton::LinuxWatcher* parent, int fd)
+      : parent_(parent),
+        fd_(fd) {
+    base::MessageLoopForIO::current()->WatchFileDescriptor(
+        fd_, true, base::MessageLoopForIO::WATCH_READ, &fd_reader_, this);
+    // Give up on clients which never finish their message.
+    timer_.Start(FROM_HERE, base::TimeDelta::FromSeconds(kTimeoutInSeconds),
+                 this, &SocketReader::CleanupAndDeleteSelf);
+  }
+
+  virtual ~SocketReader() {
+    CloseFileDescriptor(fd_);
+  }
+
+  // base::MessageLoopForIO::Watcher implementation.
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE;
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE {
+    NOTREACHED();
+  }
+
+  // Writes |reply| and closes the connection. |this| is deleted afterwards.
+  void FinishWithReply(const std::string& reply);
+
+ private:
+  void CleanupAndDeleteSelf() {
+    parent_->RemoveSocketReader(this);
+    // We are deleted beyond this point.
+  }
+
+  base::MessageLoopForIO::FileDescriptorWatcher fd_reader_;
+  ProcessSingleton::LinuxWatcher* const parent_;
+  int fd_;
+  std::string buffer_;
+  base::OneShotTimer<SocketReader> timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(SocketReader);
+};
+
+void ProcessSingleton::LinuxWatcher::SocketReader::
+    OnFileCanReadWithoutBlocking(int fd) {
+  DCHECK_EQ(fd, fd_);
+  char buf[kReadBufferSize];
+  ssize_t rv = HANDLE_EINTR(read(fd, buf, sizeof(buf)));
+  if (rv < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      PLOG(ERROR) << "read() failed";
+      CleanupAndDeleteSelf();
+    }
+    return;
+  }
+
+  if (rv > 0) {
+    buffer_.append(buf, rv);
+    if (buffer_.length() > kMaxMessageLength) {
+      LOG(ERROR) << "Forwarded command line is too long, ignored.";
+      CleanupAndDeleteSelf();
+    }
+    return;
+  }
+
+  // The sender has shut down its writing end, the message is complete.
+  fd_reader_.StopWatchingFileDescriptor();
+
+  std::vector<std::string> tokens;
+  SplitMessage(buffer_, &tokens);
+  if (tokens.size() < 3 || tokens[0] != kStartToken) {
+    LOG(ERROR) << "Malformed message on the singleton socket.";
+    CleanupAndDeleteSelf();
+    return;
+  }
+
+  std::string current_dir = tokens[1];
+  std::vector<std::string> argv(tokens.begin() + 2, tokens.end());
+  parent_->HandleMessage(current_dir, argv, this);
+}
+
+void ProcessSingleton::LinuxWatcher::SocketReader::FinishWithReply(
+    const std::string& reply) {
+  if (!reply.empty())
+    WriteToSocket(fd_, reply.data(), reply.length());
+  if (shutdown(fd_, SHUT_WR) < 0)
+    PLOG(ERROR) << "shutdown() failed";
+  timer_.Stop();
+  CleanupAndDeleteSelf();
+}
+
+void ProcessSingleton::LinuxWatcher::StartListening(int socket) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  listen_fd_ = socket;
+  base::MessageLoopForIO::current()->WatchFileDescriptor(
+      listen_fd_, true, base::MessageLoopForIO::WATCH_READ, &fd_watcher_,
+      this);
+}
+
+void ProcessSingleton::LinuxWatcher::StopListening() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  fd_watcher_.StopWatchingFileDescriptor();
+  CloseFileDescriptor(listen_fd_);
+  listen_fd_ = -1;
+}
+
+void ProcessSingleton::LinuxWatcher::OnFileCanReadWithoutBlocking(int fd) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  struct sockaddr_un from;
+  socklen_t from_len = sizeof(from);
+  int connection_socket = HANDLE_EINTR(
+      accept(fd, reinterpret_cast<sockaddr*>(&from), &from_len));
+  if (connection_socket < 0) {
+    PLOG(ERROR) << "accept() failed";
+    return;
+  }
+  if (net::SetNonBlocking(connection_socket) < 0) {
+    PLOG(ERROR) << "Failed to make the connection non-blocking";
+    CloseFileDescriptor(connection_socket);
+    return;
+  }
+  readers_.insert(new SocketReader(this, connection_socket));
+}
+
+void ProcessSingleton::LinuxWatcher::HandleMessage(
+    const std::string& current_dir,
+    const std::vector<std::string>& argv,
+    SocketReader* reader) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&LinuxWatcher::HandleMessageOnUIThread, this,
+                 current_dir, argv, reader));
+}
+
+void ProcessSingleton::LinuxWatcher::HandleMessageOnUIThread(
+    const std::string& current_dir,
+    const std::vector<std::string>& argv,
+    SocketReader* reader) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  // Without a parent this process is shutting down. The connection is then
+  // closed without a reply, so that the sender runs standalone at once.
+  std::string reply;
+  if (parent_) {
+    CommandLine parsed_command_line(argv);
+    if (parent_->ProcessCommandLine(parsed_command_line,
+                                    base::FilePath(current_dir))) {
+      reply = kACKToken;
+    } else {
+      LOG(WARNING) << "Forwarded command line was not handled.";
+      reply = kNACKToken;
+    }
+  }
+
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&LinuxWatcher::FinishWithReply, this, reader, reply));
+}
+
+void ProcessSingleton::LinuxWatcher::FinishWithReply(
+    SocketReader* reader,
+    const std::string& reply) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  // The reader may have timed out in the meantime.
+  if (readers_.find(reader) == readers_.end())
+    return;
+  reader->FinishWithReply(reply);
+}
+
+void ProcessSingleton::LinuxWatcher::RemoveSocketReader(SocketReader* reader) {
+  DCHECK(reader);
+  readers_.erase(reader);
+  delete reader;
+}
+
+ProcessSingleton::ProcessSingleton(
+    const base::FilePath& data_path,
+    const NotificationCallback& notification_callback)
+    : socket_path_(data_path.Append(kSingletonSocketFilename)),
+      lock_path_(data_path.Append(kSingletonLockFilename)),
+      notification_callback_(notification_callback),
+      lock_fd_(-1),
+      sock_(-1) {
+}
+
+ProcessSingleton::~ProcessSingleton() {
+  DCHECK(CalledOnValidThread());
+  CloseFileDescriptor(lock_fd_);
+}
+
+ProcessSingleton::NotifyResult ProcessSingleton::NotifyOtherProcessOrCreate() {
+  base::TimeTicks deadline = base::TimeTicks::Now() +
+      base::TimeDelta::FromSeconds(kTimeoutInSeconds);
+  while (true) {
+    NotifyResult result = NotifyOtherProcess();
+    if (result != PROCESS_NONE)
+      return result;
+
+    switch (Lock()) {
+      case LOCK_ACQUIRED:
+        return Create() ? PROCESS_NONE : PROCESS_ERROR;
+      case LOCK_ERROR:
+        return PROCESS_ERROR;
+      case LOCK_HELD:
+        break;
+    }
+
+    // The process holding the lock hasn't bound the socket yet.
+    if (base::TimeTicks::Now() >= deadline) {
+      LOG(ERROR) << "The browser process holding " << lock_path_.value()
+                 << " never listened.";
+      return PROCESS_ERROR;
+    }
+    base::PlatformThread::Sleep(
+        base::TimeDelta::FromMilliseconds(kRetryDelayInMilliseconds));
+  }
+}
+
+ProcessSingleton::NotifyResult ProcessSingleton::NotifyOtherProcess() {
+  DCHECK(CalledOnValidThread());
+  struct sockaddr_un addr;
+  if (!SetupSockAddr(socket_path_.value(), &addr))
+    return PROCESS_ERROR;
+
+  int sock = socket(PF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0) {
+    PLOG(ERROR) << "socket() failed";
+    return PROCESS_ERROR;
+  }
+  SetSocketTimeout(sock, kTimeoutInSeconds);
+
+  // Nobody is listening if the connection fails, see
+  // NotifyOtherProcessOrCreate().
+  if (HANDLE_EINTR(connect(sock, reinterpret_cast<sockaddr*>(&addr),
+                           sizeof(addr))) < 0) {
+    CloseFileDescriptor(sock);
+    return PROCESS_NONE;
+  }
+
+  base::FilePath current_dir;
+  if (!file_util::GetCurrentDirectory(&current_dir)) {
+    CloseFileDescriptor(sock);
+    return PROCESS_ERROR;
+  }
+
+  std::string to_send(kStartToken);
+  to_send.push_back(kTokenDelimiter);
+  to_send.append(current_dir.value());
+  const std::vector<std::string>& argv =
+      CommandLine::ForCurrentProcess()->argv();
+  for (std::vector<std::string>::const_iterator it = argv.begin();
+       it != argv.end(); ++it) {
+    to_send.push_back(kTokenDelimiter);
+    to_send.append(*it);
+  }
+
+  if (!WriteToSocket(sock, to_send.data(), to_send.length())) {
+    CloseFileDescriptor(sock);
+    return PROCESS_ERROR;
+  }
+  if (shutdown(sock, SHUT_WR) < 0)
+    PLOG(ERROR) << "shutdown() failed";
+
+  // Wait until the running process has handled the forwarded command line,
+  // it closes the connection after its reply.
+  std::string reply;
+  char buf[arraysize(kNACKToken)];
+  ssize_t len = 0;
+  while (reply.length() < arraysize(kNACKToken) &&
+         (len = HANDLE_EINTR(read(sock, buf, sizeof(buf)))) > 0)
+    reply.append(buf, len);
+  CloseFileDescriptor(sock);
+  if (reply == kACKToken)
+    return PROCESS_NOTIFIED;
+  // Handled as well as it could be, this process has nothing else to do.
+  if (reply == kNACKToken) {
+    LOG(WARNING) << "The running browser process couldn't handle the "
+                 << "command line.";
+    return PROCESS_NOTIFIED;
+  }
+
+  LOG(ERROR) << "The running browser process didn't respond.";
+  return PROCESS_ERROR;
+}
+
+bool ProcessSingleton::Create() {
+  DCHECK(CalledOnValidThread());
+  DCHECK_LT(sock_, 0);
+
+  if (Lock() != LOCK_ACQUIRED)
+    return false;
+
+  struct sockaddr_un addr;
+  if (!SetupSockAddr(socket_path_.value(), &addr))
+    return false;
+
+  int sock = socket(PF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0) {
+    PLOG(ERROR) << "socket() failed";
+    return false;
+  }
+  if (net::SetNonBlocking(sock) < 0) {
+    PLOG(ERROR) << "Failed to make the singleton socket non-blocking";
+    CloseFileDescriptor(sock);
+    return false;
+  }
+
+  // Remove the stale socket left over by a crashed process, if any. Holding
+  // the lock, no running singleton owns it.
+  unlink(socket_path_.value().c_str());
+
+  if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      listen(sock, 5) < 0) {
+    PLOG(ERROR) << "Failed to listen on " << socket_path_.value();
+    CloseFileDescriptor(sock);
+    return false;
+  }
+
+  sock_ = sock;
+  return true;
+}
+
+void ProcessSingleton::StartListening() {
+  DCHECK(CalledOnValidThread());
+  DCHECK_GE(sock_, 0);
+  DCHECK(!watcher_);
+  watcher_ = new LinuxWatcher(this);
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&LinuxWatcher::StartListening, watcher_, sock_));
+  // The watcher owns the socket from now on.
+  sock_ = -1;
+}
+
+void ProcessSingleton::Cleanup() {
+  DCHECK(CalledOnValidThread());
+  if (watcher_) {
+    watcher_->ClearParent();
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&LinuxWatcher::StopListening, watcher_));
+    watcher_ = NULL;
+  } else if (sock_ < 0) {
+    // Not the singleton, don't remove the socket of the running process.
+    return;
+  }
+  CloseFileDescriptor(sock_);
+  sock_ = -1;
+  unlink(socket_path_.value().c_str());
+  // The lock file itself stays, removing it would let a process lock a new
+  // file while another waits on the old one.
+  CloseFileDescriptor(lock_fd_);
+  lock_fd_ = -1;
+}
+
+ProcessSingleton::LockResult ProcessSingleton::Lock() {
+  DCHECK(CalledOnValidThread());
+  if (lock_fd_ >= 0)
+    return LOCK_ACQUIRED;
+
+  if (!file_util::CreateDirectory(lock_path_.DirName()))
+    return LOCK_ERROR;
+
+  int fd = HANDLE_EINTR(open(lock_path_.value().c_str(),
+                             O_RDWR | O_CREAT | O_CLOEXEC, 0600));
+  if (fd < 0) {
+    PLOG(ERROR) << "Failed to open " << lock_path_.value();
+    return LOCK_ERROR;
+  }
+  if (HANDLE_EINTR(flock(fd, LOCK_EX | LOCK_NB)) < 0) {
+    LockResult result = LOCK_HELD;
+    if (errno != EWOULDBLOCK) {
+      PLOG(ERROR) << "Failed to lock " << lock_path_.value();
+      result = LOCK_ERROR;
+    }
+    CloseFileDescriptor(fd);
+    return result;
+  }
+  lock_fd_ = fd;
+  return LOCK_ACQUIRED;
+}
+
+bool ProcessSingleton::ProcessCommandLine(
+    const CommandLine& command_line,
+    const base::FilePath& current_directory) {
+  DCHECK(CalledOnValidThread());
+  if (notification_callback_.is_null())
+    return false;
+  return notification_callback_.Run(command_line, current_directory);
+}
+
+}  // namespace cameo
@@ -0,0 +1,170 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/replay_protocol_handler.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/network_archive.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_error_job.h"
+#include "net/url_request/url_request_job.h"
+#include "net/url_request/url_request_status.h"
+
+namespace cameo {
+
+namespace {
+
+// Plays one recorded response back. The archive is kept alive by the job,
+// so the entry stays valid as long as the request needs it.
+class ReplayJob : public net::URLRequestJob {
+ public:
+  ReplayJob(net::URLRequest* request,
+            net::NetworkDelegate* network_delegate,
+            NetworkArchive* archive,
+            const NetworkArchive::Entry* entry,
+            bool replay_latency)
+      : net::URLRequestJob(request, network_delegate),
+        archive_(archive),
+        entry_(entry),
+        replay_latency_(replay_latency),
+        read_offset_(0),
+        pending_buf_size_(0),
+        weak_factory_(this) {
+  }
+
+  // URLRequestJob implementation.
+  virtual void Start() OVERRIDE {
+    start_time_ = base::TimeTicks::Now();
+    // Headers can't be reported from within Start().
+    base::MessageLoop::current()->PostDelayedTask(
+        FROM_HERE,
+        base::Bind(&ReplayJob::StartAsync, weak_factory_.GetWeakPtr()),
+        replay_latency_ ? entry_->headers_delay : base::TimeDelta());
+  }
+
+  virtual void Kill() OVERRIDE {
+    weak_factory_.InvalidateWeakPtrs();
+    net::URLRequestJob::Kill();
+  }
+
+  virtual bool ReadRawData(net::IOBuffer* buf,
+                           int buf_size,
+                           int* bytes_read) OVERRIDE {
+    // The last bytes come when the recorded body ended.
+    base::TimeDelta wait = replay_latency_ ?
+        start_time_ + entry_->total_delay - base::TimeTicks::Now() :
+        base::TimeDelta();
+    if (wait > base::TimeDelta() &&
+        entry_->body.size() - read_offset_ <= static_cast<size_t>(buf_size)) {
+      pending_buf_ = buf;
+      pending_buf_size_ = buf_size;
+      SetStatus(net::URLRequestStatus(net::URLRequestStatus::IO_PENDING, 0));
+      base::MessageLoop::current()->PostDelayedTask(
+          FROM_HERE,
+          base::Bind(&ReplayJob::CompleteRead, weak_factory_.GetWeakPtr()),
+          wait);
+      return false;
+    }
+    *bytes_read = CopyBody(buf, buf_size);
+    return true;
+  }
+
+  virtual bool GetMimeType(std::string* mime_type) const OVERRIDE {
+    return entry_->headers->GetMimeType(mime_type);
+  }
+
+  virtual bool GetCharset(std::string* charset) OVERRIDE {
+    return entry_->headers->GetCharset(charset);
+  }
+
+  virtual void GetResponseInfo(net::HttpResponseInfo* info) OVERRIDE {
+    info->headers = entry_->headers;
+  }
+
+  virtual int GetResponseCode() const OVERRIDE {
+    return entry_->headers->response_code();
+  }
+
+  virtual bool IsRedirectResponse(GURL* location,
+                                  int* http_status_code) OVERRIDE {
+    std::string value;
+    if (!entry_->headers->IsRedirect(&value))
+      return false;
+    *location = request_->url().Resolve(value);
+    *http_status_code = entry_->headers->response_code();
+    return true;
+  }
+
+ private:
+  virtual ~ReplayJob() {}
+
+  void StartAsync() {
+    set_expected_content_size(entry_->body.size());
+    NotifyHeadersComplete();
+  }
+
+  void CompleteRead() {
+    int bytes_read = CopyBody(pending_buf_.get(), pending_buf_size_);
+    pending_buf_ = NULL;
+    SetStatus(net::URLRequestStatus());
+    NotifyReadComplete(bytes_read);
+  }
+
+  int CopyBody(net::IOBuffer* buf, int buf_size) {
+    size_t remaining = entry_->body.size() - read_offset_;
+    size_t count = std::min(remaining, static_cast<size_t>(buf_size));
+    memcpy(buf->data(), entry_->body.data() + read_offset_, count);
+    read_offset_ += count;
+    return static_cast<int>(count);
+  }
+
+  scoped_refptr<NetworkArchive> archive_;
+  const NetworkArchive::Entry* entry_;
+  bool replay_latency_;
+  base::TimeTicks start_time_;
+  size_t read_offset_;
+  scoped_refptr<net::IOBuffer> pending_buf_;
+  int pending_buf_size_;
+  base::WeakPtrFactory<ReplayJob> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReplayJob);
+};
+
+}  // namespace
+
+ReplayProtocolHandler::ReplayProtocolHandler(NetworkArchive* archive,
+                                             bool replay_latency)
+    : archive_(archive),
+      replay_latency_(replay_latency) {
+}
+
+ReplayProtocolHandler::~ReplayProtocolHandler() {
+}
+
+net::URLRequestJob* ReplayProtocolHandler::MaybeCreateJob(
+    net::URLRequest* request,
+    net::NetworkDelegate* network_delegate) const {
+  const NetworkArchive::Entry* entry =
+      archive_->Next(request->method(), request->url());
+  if (!entry) {
+    return new net::URLRequestErrorJob(request, network_delegate,
+                                       net::ERR_INTERNET_DISCONNECTED);
+  }
+  return new ReplayJob(request, network_delegate, archive_.get(), entry,
+                       replay_latency_);
+}
+
+}  // namespace cameo
@@ -0,0 +1,40 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_REPLAY_PROTOCOL_HANDLER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_REPLAY_PROTOCOL_HANDLER_H_
+
+#include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "net/url_request/url_request_job_factory.h"
+
+namespace cameo {
+
+class NetworkArchive;
+
+// Serves the requests of a scheme from the responses recorded in |archive|,
+// see NetworkArchive, without going to the network. A request which wasn't
+// recorded fails as if there were no connection. With |replay_latency|, the
+// headers and the end of each body come as late as they came when recorded.
+class ReplayProtocolHandler
+    : public net::URLRequestJobFactory::ProtocolHandler {
+ public:
+  ReplayProtocolHandler(NetworkArchive* archive, bool replay_latency);
+  virtual ~ReplayProtocolHandler();
+
+  // ProtocolHandler implementation.
+  virtual net::URLRequestJob* MaybeCreateJob(
+      net::URLRequest* request,
+      net::NetworkDelegate* network_delegate) const OVERRIDE;
+
+ private:
+  scoped_refptr<NetworkArchive> archive_;
+  bool replay_latency_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReplayProtocolHandler);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_REPLAY_PROTOCOL_HANDLER_H_
@@ -0,0 +1,192 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/request_scheduler.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/base/net_errors.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_status.h"
+
+namespace cameo {
+
+namespace {
+
+// A background render view polling the network keeps at most this many
+// requests in flight by default, out of the 6 connections a host gets.
+const size_t kDefaultBackgroundRequestLimit = 2;
+
+size_t GetBackgroundRequestLimit() {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (!command_line.HasSwitch(switches::kBackgroundRequestLimit))
+    return kDefaultBackgroundRequestLimit;
+
+  unsigned limit = 0;
+  if (!base::StringToUint(command_line.GetSwitchValueASCII(
+          switches::kBackgroundRequestLimit), &limit)) {
+    LOG(WARNING) << "Invalid --" << switches::kBackgroundRequestLimit;
+    return kDefaultBackgroundRequestLimit;
+  }
+  return limit;
+}
+
+net::RequestPriority RaisePriority(net::RequestPriority priority) {
+  return priority < net::HIGHEST ?
+      static_cast<net::RequestPriority>(priority + 1) : priority;
+}
+
+net::RequestPriority LowerPriority(net::RequestPriority priority) {
+  return priority > net::IDLE ?
+      static_cast<net::RequestPriority>(priority - 1) : priority;
+}
+
+}  // namespace
+
+RequestScheduler::RequestScheduler()
+    : background_request_limit_(GetBackgroundRequestLimit()),
+      foreground_view_(-1, -1),
+      weak_factory_(this) {
+}
+
+RequestScheduler::~RequestScheduler() {
+}
+
+void RequestScheduler::SetForegroundView(int render_process_id,
+                                         int render_view_id) {
+  foreground_view_ = ViewId(render_process_id, render_view_id);
+  // What the new foreground view held back can go now.
+  StartQueuedRequests(foreground_view_);
+}
+
+int RequestScheduler::OnBeforeURLRequest(
+    net::URLRequest* request,
+    const net::CompletionCallback& callback) {
+  // Already counted, e.g. when restarted.
+  if (started_requests_.count(request))
+    return net::OK;
+
+  ViewId view = GetViewId(*request);
+  if (view == ViewId(-1, -1))
+    return net::OK;
+
+  bool background = IsBackgroundView(view);
+  if (foreground_view_ != ViewId(-1, -1)) {
+    request->SetPriority(background ? LowerPriority(request->priority()) :
+                                      RaisePriority(request->priority()));
+  }
+
+  ViewState& state = views_[view];
+  if (background && background_request_limit_ &&
+      state.in_flight >= background_request_limit_) {
+    QueuedRequest queued = { request, callback };
+    state.queued.push_back(queued);
+    return net::ERR_IO_PENDING;
+  }
+
+  ++state.in_flight;
+  started_requests_[request].view = view;
+  return net::OK;
+}
+
+void RequestScheduler::OnRequestDone(const net::URLRequest& request) {
+  std::map<const net::URLRequest*, StartedRequest>::iterator started =
+      started_requests_.find(&request);
+  if (started != started_requests_.end()) {
+    ViewId view = started->second.view;
+    started_requests_.erase(started);
+    ViewState& state = views_[view];
+    --state.in_flight;
+    StartQueuedRequests(view);
+    if (!state.in_flight && state.queued.empty())
+      views_.erase(view);
+    return;
+  }
+
+  // Destroyed while held back.
+  ViewId view = GetViewId(request);
+  std::map<ViewId, ViewState>::iterator it = views_.find(view);
+  if (it == views_.end())
+    return;
+  std::deque<QueuedRequest>& queued = it->second.queued;
+  for (std::deque<QueuedRequest>::iterator request_it = queued.begin();
+       request_it != queued.end(); ++request_it) {
+    if (request_it->request == &request) {
+      queued.erase(request_it);
+      break;
+    }
+  }
+  if (!it->second.in_flight && queued.empty())
+    views_.erase(it);
+}
+
+bool RequestScheduler::IsBackgroundRequest(
+    const net::URLRequest& request) const {
+  ViewId view = GetViewId(request);
+  return view != ViewId(-1, -1) && IsBackgroundView(view);
+}
+
+// static
+RequestScheduler::ViewId RequestScheduler::GetViewId(
+    const net::URLRequest& request) {
+  int render_process_id = -1;
+  int render_view_id = -1;
+  if (!content::ResourceRequestInfo::GetRenderViewForRequest(
+          &request, &render_process_id, &render_view_id)) {
+    return ViewId(-1, -1);
+  }
+  return ViewId(render_process_id, render_view_id);
+}
+
+bool RequestScheduler::IsBackgroundView(const ViewId& view) const {
+  return foreground_view_ != ViewId(-1, -1) && view != foreground_view_;
+}
+
+void RequestScheduler::StartQueuedRequests(const ViewId& view) {
+  std::map<ViewId, ViewState>::iterator it = views_.find(view);
+  if (it == views_.end())
+    return;
+
+  ViewState& state = it->second;
+  bool limited = IsBackgroundView(view) && background_request_limit_;
+  while (!state.queued.empty() &&
+         (!limited || state.in_flight < background_request_limit_)) {
+    QueuedRequest queued = state.queued.front();
+    state.queued.pop_front();
+    ++state.in_flight;
+    StartedRequest& started = started_requests_[queued.request];
+    started.view = view;
+    started.callback = queued.callback;
+    // Not from within the notification of another request.
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&RequestScheduler::RunStartCallback,
+                   weak_factory_.GetWeakPtr(), queued.request));
+  }
+}
+
+void RequestScheduler::RunStartCallback(const net::URLRequest* request) {
+  std::map<const net::URLRequest*, StartedRequest>::iterator it =
+      started_requests_.find(request);
+  // Destroyed in the meantime.
+  if (it == started_requests_.end() || it->second.callback.is_null())
+    return;
+  // Cancelled in the meantime, it is only waiting to be destroyed.
+  if (!request->status().is_success())
+    return;
+
+  net::CompletionCallback callback = it->second.callback;
+  it->second.callback.Reset();
+  callback.Run(net::OK);
+}
+
+}  // namespace cameo
@@ -0,0 +1,100 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_REQUEST_SCHEDULER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_REQUEST_SCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/completion_callback.h"
+
+namespace net {
+class URLRequest;
+}
+
+namespace cameo {
+
+// RequestScheduler gives the Runtime in the foreground precedence on the
+// network. The requests of its render view get their priority raised, so
+// that they go first in the socket pools, and those of the other render
+// views get it lowered. Every background render view also has at most
+// switches::kBackgroundRequestLimit requests in flight, the others being
+// held back in RuntimeNetworkDelegate::OnBeforeURLRequest until one
+// completes, or until the view comes to the foreground.
+//
+// Requests of the browser process are left alone, and so is everything
+// while no Runtime has been in the foreground yet. Only lives on the IO
+// thread.
+class RequestScheduler {
+ public:
+  RequestScheduler();
+  ~RequestScheduler();
+
+  // The render view of the foreground Runtime. -1 for both if none is.
+  void SetForegroundView(int render_process_id, int render_view_id);
+
+  // Returns net::OK if |request| can start right away. Otherwise returns
+  // net::ERR_IO_PENDING, and runs |callback| when it can.
+  int OnBeforeURLRequest(net::URLRequest* request,
+                         const net::CompletionCallback& callback);
+
+  // Called when |request| completes or is destroyed, whichever comes first.
+  void OnRequestDone(const net::URLRequest& request);
+
+  // True if |request| belongs to a background render view.
+  bool IsBackgroundRequest(const net::URLRequest& request) const;
+
+  size_t background_request_limit() const {
+    return background_request_limit_;
+  }
+
+ private:
+  // A render process id and render view id, both -1 for the browser.
+  typedef std::pair<int, int> ViewId;
+
+  struct QueuedRequest {
+    net::URLRequest* request;
+    net::CompletionCallback callback;
+  };
+
+  struct ViewState {
+    ViewState() : in_flight(0) {}
+
+    size_t in_flight;
+    std::deque<QueuedRequest> queued;
+  };
+
+  // A request counted in the in-flight requests of its view. Its callback is
+  // set until it has been run for a request which was held back.
+  struct StartedRequest {
+    ViewId view;
+    net::CompletionCallback callback;
+  };
+
+  static ViewId GetViewId(const net::URLRequest& request);
+
+  bool IsBackgroundView(const ViewId& view) const;
+
+  // Starts as many of the held back requests of |view| as it is allowed.
+  void StartQueuedRequests(const ViewId& view);
+  void RunStartCallback(const net::URLRequest* request);
+
+  // 0 for no limit.
+  const size_t background_request_limit_;
+  ViewId foreground_view_;
+  std::map<ViewId, ViewState> views_;
+  std::map<const net::URLRequest*, StartedRequest> started_requests_;
+
+  base::WeakPtrFactory<RequestScheduler> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestScheduler);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_REQUEST_SCHEDULER_H_
@@ -0,0 +1,112 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/web_contents.h"
+#include "net/base/escape.h"
+
+using cameo::Runtime;
+
+namespace {
+
+// kBackgroundRuntimes Runtimes keep kPollConnections requests each in flight
+// to the test server, while the foreground one loads kImageCount images from
+// it, kRounds times.
+const int kBackgroundRuntimes = 4;
+const int kPollConnections = 6;
+const int kImageCount = 30;
+const int kRounds = 3;
+
+GURL GetTestPageURL(const char* page, const std::string& query) {
+  GURL url = cameo_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII(page));
+  GURL::Replacements replacements;
+  replacements.SetQueryStr(query);
+  return url.ReplaceComponents(replacements);
+}
+
+}  // namespace
+
+class RequestSchedulerTest : public InProcessBrowserTest {
+ public:
+  explicit RequestSchedulerTest(const char* limit) : limit_(limit) {}
+
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    command_line->AppendSwitchASCII(switches::kBackgroundRequestLimit, limit_);
+  }
+
+  // Reports the mean time the foreground Runtime takes to load its page
+  // while the background ones poll the same server.
+  void RunForegroundLoadBenchmark() {
+    EXPECT_TRUE(test_server()->Start());
+    std::string server = net::EscapeQueryParamValue(
+        test_server()->GetURL(std::string()).spec(), true);
+
+    std::vector<Runtime*> background_runtimes;
+    for (int i = 0; i < kBackgroundRuntimes; ++i) {
+      background_runtimes.push_back(Runtime::Create(
+          runtime()->runtime_context(),
+          GetTestPageURL("poll.html", base::StringPrintf(
+              "server=%s&connections=%d", server.c_str(),
+              kPollConnections))));
+    }
+    // New Runtimes come to the foreground, send the first one back there.
+    runtime()->OnWindowActivated();
+    cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(1));
+
+    GURL url = GetTestPageURL(
+        "load_images.html",
+        base::StringPrintf("server=%s&count=%d", server.c_str(), kImageCount));
+    base::TimeDelta total;
+    for (int round = 0; round < kRounds; ++round) {
+      base::TimeTicks start = base::TimeTicks::Now();
+      cameo_test_utils::NavigateToURL(runtime(), url);
+      total += base::TimeTicks::Now() - start;
+      EXPECT_EQ(ASCIIToUTF16("loaded"), runtime()->web_contents()->GetTitle());
+    }
+
+    for (size_t i = 0; i < background_runtimes.size(); ++i)
+      background_runtimes[i]->Close();
+
+    cameo_test_utils::PrintPerfResult(
+        "foreground_load",
+        base::StringPrintf("%d_background_limit_%s", kBackgroundRuntimes,
+                           limit_.c_str()),
+        total.InMillisecondsF() / kRounds, "ms");
+  }
+
+ private:
+  std::string limit_;
+};
+
+class ThrottledRequestSchedulerTest : public RequestSchedulerTest {
+ public:
+  ThrottledRequestSchedulerTest() : RequestSchedulerTest("2") {}
+};
+
+class UnthrottledRequestSchedulerTest : public RequestSchedulerTest {
+ public:
+  UnthrottledRequestSchedulerTest() : RequestSchedulerTest("0") {}
+};
+
+IN_PROC_BROWSER_TEST_F(ThrottledRequestSchedulerTest,
+                       ForegroundLoadBenchmark) {
+  RunForegroundLoadBenchmark();
+}
+
+IN_PROC_BROWSER_TEST_F(UnthrottledRequestSchedulerTest,
+                       ForegroundLoadBenchmark) {
+  RunForegroundLoadBenchmark();
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/request_scheduler.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop.h"
+#include "base/run_loop.h"
+#include "content/public/browser/resource_request_info.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/net_errors.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/glue/resource_type.h"
+
+using cameo::RequestScheduler;
+
+namespace {
+
+const int kRenderProcessId = 1;
+const int kForegroundViewId = 1;
+const int kBackgroundViewId = 2;
+
+// The requests are never started, the scheduler only looks at their render
+// view and priority.
+class RequestSchedulerTest : public testing::Test {
+ public:
+  RequestSchedulerTest() : message_loop_(base::MessageLoop::TYPE_IO) {}
+
+  net::URLRequest* CreateRequest(int render_view_id,
+                                 net::RequestPriority priority) {
+    net::URLRequest* request =
+        context_.CreateRequest(GURL("http://example.com/"), &delegate_);
+    content::ResourceRequestInfo::AllocateForTesting(
+        request, ResourceType::SUB_RESOURCE, NULL, kRenderProcessId,
+        render_view_id);
+    request->SetPriority(priority);
+    requests_.push_back(request);
+    return request;
+  }
+
+  // Returns what the scheduler answers for |request|, whose start callback
+  // appends what it is run with to |started_|.
+  int Schedule(net::URLRequest* request) {
+    return scheduler_.OnBeforeURLRequest(
+        request, base::Bind(&RequestSchedulerTest::OnStarted,
+                            base::Unretained(this)));
+  }
+
+  void RunPendingTasks() {
+    base::RunLoop().RunUntilIdle();
+  }
+
+ protected:
+  void OnStarted(int result) {
+    started_.push_back(result);
+  }
+
+  base::MessageLoop message_loop_;
+  net::TestURLRequestContext context_;
+  net::TestDelegate delegate_;
+  ScopedVector<net::URLRequest> requests_;
+  RequestScheduler scheduler_;
+  std::vector<int> started_;
+};
+
+}  // namespace
+
+TEST_F(RequestSchedulerTest, LeavesEverythingAloneWithoutForeground) {
+  ASSERT_EQ(2u, scheduler_.background_request_limit());
+  for (size_t i = 0; i < scheduler_.background_request_limit() + 1; ++i) {
+    net::URLRequest* request = CreateRequest(kBackgroundViewId, net::MEDIUM);
+    EXPECT_EQ(net::OK, Schedule(request));
+    EXPECT_EQ(net::MEDIUM, request->priority());
+    EXPECT_FALSE(scheduler_.IsBackgroundRequest(*request));
+  }
+}
+
+TEST_F(RequestSchedulerTest, ChangesPriorities) {
+  scheduler_.SetForegroundView(kRenderProcessId, kForegroundViewId);
+
+  net::URLRequest* foreground = CreateRequest(kForegroundViewId, net::MEDIUM);
+  EXPECT_EQ(net::OK, Schedule(foreground));
+  EXPECT_EQ(net::HIGHEST, foreground->priority());
+  EXPECT_FALSE(scheduler_.IsBackgroundRequest(*foreground));
+
+  net::URLRequest* background = CreateRequest(kBackgroundViewId, net::MEDIUM);
+  EXPECT_EQ(net::OK, Schedule(background));
+  EXPECT_EQ(net::LOW, background->priority());
+  EXPECT_TRUE(scheduler_.IsBackgroundRequest(*background));
+
+  // The priorities stay in range.
+  net::URLRequest* highest = CreateRequest(kForegroundViewId, net::HIGHEST);
+  EXPECT_EQ(net::OK, Schedule(highest));
+  EXPECT_EQ(net::HIGHEST, highest->priority());
+  net::URLRequest* idle = CreateRequest(kBackgroundViewId, net::IDLE);
+  Schedule(idle);
+  EXPECT_EQ(net::IDLE, idle->priority());
+}
+
+TEST_F(RequestSchedulerTest, LimitsBackgroundViews) {
+  scheduler_.SetForegroundView(kRenderProcessId, kForegroundViewId);
+  size_t limit = scheduler_.background_request_limit();
+
+  std::vector<net::URLRequest*> in_flight;
+  for (size_t i = 0; i < limit; ++i) {
+    in_flight.push_back(CreateRequest(kBackgroundViewId, net::MEDIUM));
+    EXPECT_EQ(net::OK, Schedule(in_flight.back()));
+  }
+  net::URLRequest* queued = CreateRequest(kBackgroundViewId, net::MEDIUM);
+  EXPECT_EQ(net::ERR_IO_PENDING, Schedule(queued));
+
+  // The foreground view has no limit.
+  for (size_t i = 0; i < limit + 1; ++i)
+    EXPECT_EQ(net::OK, Schedule(CreateRequest(kForegroundViewId, net::LOW)));
+
+  RunPendingTasks();
+  EXPECT_TRUE(started_.empty());
+
+  // The held back request goes once a slot is free, from a task of its own.
+  scheduler_.OnRequestDone(*in_flight[0]);
+  EXPECT_TRUE(started_.empty());
+  RunPendingTasks();
+  ASSERT_EQ(1u, started_.size());
+  EXPECT_EQ(net::OK, started_[0]);
+
+  // It takes the slot it was given.
+  EXPECT_EQ(net::ERR_IO_PENDING,
+            Schedule(CreateRequest(kBackgroundViewId, net::MEDIUM)));
+  // Restarting a request already counted doesn't count it twice.
+  EXPECT_EQ(net::OK, Schedule(queued));
+}
+
+TEST_F(RequestSchedulerTest, ReleasesViewComingToForeground) {
+  scheduler_.SetForegroundView(kRenderProcessId, kForegroundViewId);
+  size_t limit = scheduler_.background_request_limit();
+  for (size_t i = 0; i < limit; ++i)
+    Schedule(CreateRequest(kBackgroundViewId, net::MEDIUM));
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(net::ERR_IO_PENDING,
+              Schedule(CreateRequest(kBackgroundViewId, net::MEDIUM)));
+  }
+
+  scheduler_.SetForegroundView(kRenderProcessId, kBackgroundViewId);
+  RunPendingTasks();
+  EXPECT_EQ(3u, started_.size());
+}
+
+TEST_F(RequestSchedulerTest, ForgetsDestroyedQueuedRequests) {
+  scheduler_.SetForegroundView(kRenderProcessId, kForegroundViewId);
+  size_t limit = scheduler_.background_request_limit();
+  std::vector<net::URLRequest*> in_flight;
+  for (size_t i = 0; i < limit; ++i) {
+    in_flight.push_back(CreateRequest(kBackgroundViewId, net::MEDIUM));
+    Schedule(in_flight.back());
+  }
+  net::URLRequest* destroyed = CreateRequest(kBackgroundViewId, net::MEDIUM);
+  EXPECT_EQ(net::ERR_IO_PENDING, Schedule(destroyed));
+  scheduler_.OnRequestDone(*destroyed);
+
+  scheduler_.OnRequestDone(*in_flight[0]);
+  RunPendingTasks();
+  EXPECT_TRUE(started_.empty());
+}
@@ -8,10 +8,16 @@
 
 #include "base/command_line.h"
 #include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "cameo/src/runtime/browser/background_throttler.h"
 #include "cameo/src/runtime/browser/cameo_browser_main_parts.h"
 #include "cameo/src/runtime/browser/cameo_content_browser_client.h"
+#include "cameo/src/runtime/browser/frame_capturer.h"
 #include "cameo/src/runtime/browser/runtime_context.h"
 #include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/browser/ui/native_app_window_headless.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/runtime/common/frame_ring.h"
 #include "content/public/browser/navigation_controller.h"
 #include "content/public/browser/navigation_entry.h"
 #include "content/public/browser/notification_details.h"
@@ -50,35 +56,65 @@ Runtime* Runtime::CreateFromWebContents(WebContents* web_contents) {
   return new Runtime(web_contents);
 }
 
-Runtime::Runtime(content::WebContents* web_contents) : window_(NULL) {
+Runtime::Runtime(content::WebContents* web_contents)
+    : window_(NULL),
+      contents_deactivated_(false),
+      last_active_time_(base::TimeTicks::Now()),
+      is_hibernated_(false) {
   web_contents_.reset(web_contents);
   web_contents_->SetDelegate(this);
   runtime_context_ =
       static_cast<RuntimeContext*>(web_contents->GetBrowserContext());
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  background_throttler_.reset(new BackgroundThrottler(
+      web_contents,
+      BackgroundThrottler::Config::FromCommandLine(command_line)));
+  int hibernate_after = 0;
+  if (base::StringToInt(
+          command_line.GetSwitchValueASCII(switches::kHibernateAfter),
+          &hibernate_after) &&
+      hibernate_after > 0)
+    hibernate_delay_ = base::TimeDelta::FromSeconds(hibernate_after);
 
   NativeAppWindow::CreateParams params;
   params.runtime = this;
   params.bounds = gfx::Rect(0, 0, kDefaultWidth, kDefaultHeight);
   InitAppWindow(params);
 
-  registrar_.Add(this,
-      content::NOTIFICATION_WEB_CONTENTS_TITLE_UPDATED,
-      content::Source<content::WebContents>(web_contents));
+  ObserveWebContents();
 
   RuntimeRegistry::Get()->AddRuntime(this);
+  // A new window is the one the user looks at.
+  runtime_context_->SetForegroundRuntime(this);
 }
 
 
 Runtime::~Runtime() {
   RuntimeRegistry::Get()->RemoveRuntime(this);
+  if (runtime_context_->foreground_runtime() == this)
+    runtime_context_->SetForegroundRuntime(NULL);
 
   // Quit the app once the last Runtime instance is removed.
   if (RuntimeRegistry::Get()->runtimes().empty())
     MessageLoop::current()->PostTask(FROM_HERE, MessageLoop::QuitClosure());
 }
 
+void Runtime::ObserveWebContents() {
+  registrar_.Add(this,
+      content::NOTIFICATION_WEB_CONTENTS_TITLE_UPDATED,
+      content::Source<content::WebContents>(web_contents_.get()));
+  // Keeps the lookups of the registry by view and by process up to date.
+  registrar_.Add(this,
+      content::NOTIFICATION_RENDER_VIEW_HOST_CHANGED,
+      content::Source<content::NavigationController>(
+          &web_contents_->GetController()));
+}
+
 void Runtime::InitAppWindow(const NativeAppWindow::CreateParams& params) {
-  window_ = NativeAppWindow::Create(params);
+  if (CommandLine::ForCurrentProcess()->HasSwitch(switches::kHeadless))
+    window_ = new NativeAppWindowHeadless(params);
+  else
+    window_ = NativeAppWindow::Create(params);
   window_->Show();
 }
 
@@ -89,6 +125,14 @@ gfx::Image Runtime::app_icon() const {
 }
 
 void Runtime::LoadURL(const GURL& url) {
+  // The page kept while hibernated is replaced by this one.
+  if (is_hibernated_) {
+    is_hibernated_ = false;
+    RuntimeRegistry::Get()->OnRuntimeResumed(this);
+  }
+  // The subresources the page is known to load are fetched along with the
+  // document.
+  runtime_context_->PrefetchSubresources(url);
   content::NavigationController::LoadURLParams params(url);
   params.transition_type = content::PageTransitionFromInt(
       content::PAGE_TRANSITION_TYPED |
@@ -101,6 +145,91 @@ void Runtime::Close() {
   delete this;
 }
 
+void Runtime::OnWindowActivated() {
+  contents_deactivated_ = false;
+  OnWindowStateChanged();
+  runtime_context_->SetForegroundRuntime(this);
+}
+
+void Runtime::OnWindowStateChanged() {
+  // The window is still being created.
+  if (!window_)
+    return;
+  // It was in the foreground until now.
+  if (!background_throttler_->is_throttled())
+    last_active_time_ = base::TimeTicks::Now();
+  background_throttler_->Update(
+      window_->IsVisible() && !window_->IsMinimized(),
+      window_->IsActive() && !contents_deactivated_);
+
+  if (!background_throttler_->is_throttled()) {
+    hibernate_timer_.Stop();
+    Resume();
+  } else if (hibernate_delay_ > base::TimeDelta() && !is_hibernated_ &&
+             !hibernate_timer_.IsRunning()) {
+    hibernate_timer_.Start(FROM_HERE, hibernate_delay_, this,
+                           &Runtime::Hibernate);
+  }
+}
+
+void Runtime::Hibernate() {
+  // Nothing would bring it back from the foreground.
+  if (is_hibernated_ || !background_throttler_->is_throttled())
+    return;
+  hibernate_timer_.Stop();
+  // It watches the contents going away.
+  frame_capturer_.reset();
+
+  // The placeholder gets a copy of the navigation entries, along with the
+  // state of their pages, and doesn't load any of them until it resumes, so
+  // no renderer is started for it meanwhile.
+  WebContents::CreateParams params(runtime_context_, NULL);
+  params.routing_id = MSG_ROUTING_NONE;
+  params.initial_size = window_->GetBounds().size();
+  WebContents* placeholder = WebContents::Create(params);
+  placeholder->GetController().CopyStateFrom(web_contents_->GetController());
+
+  scoped_ptr<WebContents> hibernated(web_contents_.release());
+  hibernated->SetDelegate(NULL);
+  registrar_.RemoveAll();
+  web_contents_.reset(placeholder);
+  web_contents_->SetDelegate(this);
+  ObserveWebContents();
+  background_throttler_->SetWebContents(placeholder);
+  window_->UpdateWebContents();
+  is_hibernated_ = true;
+
+  RuntimeRegistry::Get()->OnRuntimeHibernated(this);
+  // The view of the foreground Runtime went away.
+  if (runtime_context_->foreground_runtime() == this)
+    runtime_context_->SetForegroundRuntime(this);
+  // |hibernated| and its renderer are destroyed here.
+}
+
+void Runtime::Resume() {
+  if (!is_hibernated_)
+    return;
+  is_hibernated_ = false;
+  web_contents_->GetController().LoadIfNecessary();
+  RuntimeRegistry::Get()->OnRuntimeResumed(this);
+}
+
+base::TimeTicks Runtime::last_active_time() const {
+  if (!background_throttler_->is_throttled())
+    return base::TimeTicks::Now();
+  return last_active_time_;
+}
+
+void Runtime::StartFrameCapture(scoped_ptr<FrameRing> ring,
+                                int max_frame_rate) {
+  frame_capturer_.reset(
+      new FrameCapturer(web_contents_.get(), ring.Pass(), max_frame_rate));
+}
+
+void Runtime::StopFrameCapture() {
+  frame_capturer_.reset();
+}
+
 NativeAppWindow* Runtime::window() const {
   return window_;
 }
@@ -166,6 +295,9 @@ void Runtime::WebContentsCreated(
 }
 
 void Runtime::DidNavigateMainFramePostCommit(content::WebContents* web_contents) {
+  // The navigation may have swapped the render view of the foreground Runtime.
+  if (runtime_context_->foreground_runtime() == this)
+    runtime_context_->SetForegroundRuntime(this);
 }
 
 content::JavaScriptDialogManager* Runtime::GetJavaScriptDialogManager() {
@@ -174,10 +306,15 @@ content::JavaScriptDialogManager* Runtime::GetJavaScriptDialogManager() {
 
 void Runtime::ActivateContents(content::WebContents* contents) {
   contents->GetRenderViewHost()->Focus();
+  contents_deactivated_ = false;
+  OnWindowStateChanged();
+  runtime_context_->SetForegroundRuntime(this);
 }
 
 void Runtime::DeactivateContents(content::WebContents* contents) {
   contents->GetRenderViewHost()->Blur();
+  contents_deactivated_ = true;
+  OnWindowStateChanged();
 }
 
 void Runtime::Observe(int type,
@@ -192,6 +329,8 @@ void Runtime::Observe(int type,
       string16 text = title->first->GetTitle();
       window_->UpdateTitle(text);
     }
+  } else if (type == content::NOTIFICATION_RENDER_VIEW_HOST_CHANGED) {
+    RuntimeRegistry::Get()->OnRenderViewHostChanged(this);
   }
 }
 
@@ -7,6 +7,8 @@
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time.h"
+#include "base/timer.h"
 #include "cameo/src/runtime/browser/ui/native_app_window.h"
 #include "content/public/browser/notification_observer.h"
 #include "content/public/browser/notification_registrar.h"
@@ -20,6 +22,9 @@ class WebContents;
 
 namespace cameo {
 
+class BackgroundThrottler;
+class FrameCapturer;
+class FrameRing;
 class NativeAppWindow;
 class RuntimeContext;
 
@@ -37,6 +42,43 @@ class Runtime : public content::WebContentsDelegate,
   void LoadURL(const GURL& url);
   void Close();
 
+  // Called by the window when it becomes the active one, which brings the
+  // Runtime to the foreground. See RuntimeContext::SetForegroundRuntime.
+  void OnWindowActivated();
+  // Called by the window when it is shown, hidden, minimized, restored or
+  // deactivated, which may send the Runtime to the background or bring it
+  // back. See BackgroundThrottler.
+  void OnWindowStateChanged();
+
+  // Frees the memory of a Runtime in the background: its WebContents and
+  // renderer are destroyed, and replaced by a placeholder WebContents that
+  // holds the navigation entries and page state of the previous one, without
+  // any renderer. The window and the registry keep the Runtime, and
+  // RuntimeRegistryObserver::OnRuntimeHibernated() is called. Any capture of
+  // the frames stops. Does nothing while the Runtime is in the foreground.
+  //
+  // Done after switches::kHibernateAfter seconds in the background, or
+  // earlier under memory pressure, see MemoryPressureCoordinator.
+  void Hibernate();
+  // Loads the page the Runtime was showing when it hibernated again. Done
+  // when the window comes back to the foreground.
+  void Resume();
+  bool is_hibernated() const { return is_hibernated_; }
+
+  // Copies the frames painted by the web contents into |ring|, at most
+  // |max_frame_rate| per second, 0 meaning as fast as they are painted.
+  // Replaces any capture already running.
+  void StartFrameCapture(scoped_ptr<FrameRing> ring, int max_frame_rate);
+  void StopFrameCapture();
+  FrameCapturer* frame_capturer() const { return frame_capturer_.get(); }
+
+  // When the Runtime was last in the foreground, now if it still is.
+  base::TimeTicks last_active_time() const;
+
+  BackgroundThrottler* background_throttler() const {
+    return background_throttler_.get();
+  }
+
   content::WebContents* web_contents() const { return web_contents_.get(); }
   NativeAppWindow* window() const;
   RuntimeContext* runtime_context() const { return runtime_context_; }
@@ -50,6 +92,9 @@ class Runtime : public content::WebContentsDelegate,
   // Initialize the app window.
   void InitAppWindow(const NativeAppWindow::CreateParams& params);
 
+  // Registers for the notifications of |web_contents_|.
+  void ObserveWebContents();
+
   // Overridden from content::WebContentsDelegate:
   virtual content::WebContents* OpenURLFromTab(
       content::WebContents* source,
@@ -98,6 +143,22 @@ class Runtime : public content::WebContentsDelegate,
   scoped_ptr<content::WebContents> web_contents_;
 
   NativeAppWindow* window_;
+
+  // Declared after |web_contents_| so that it stops watching it first.
+  scoped_ptr<FrameCapturer> frame_capturer_;
+
+  scoped_ptr<BackgroundThrottler> background_throttler_;
+  // Whether the page deactivated itself, e.g. with window.blur(), until the
+  // window or the page activates it again.
+  bool contents_deactivated_;
+  // When the Runtime went to the background last.
+  base::TimeTicks last_active_time_;
+
+  bool is_hibernated_;
+  // How long the Runtime stays in the background before it hibernates, zero
+  // for never.
+  base::TimeDelta hibernate_delay_;
+  base::OneShotTimer<Runtime> hibernate_timer_;
 };
 
 }  // namespace cameo
@@ -4,21 +4,185 @@
 
 #include "cameo/src/runtime/browser/runtime_context.h"
 
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
 #include "base/command_line.h"
+#include "base/debug/trace_event.h"
+#include "base/json/json_writer.h"
 #include "base/logging.h"
+#include "base/memory/linked_ptr.h"
 #include "base/path_service.h"
+#include "base/stl_util.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+#include "cameo/src/runtime/browser/app_protocol_handler.h"
+#include "cameo/src/runtime/browser/load_predictor.h"
+#include "cameo/src/runtime/browser/media_url_request_context_getter.h"
+#include "cameo/src/runtime/browser/network_archive.h"
+#include "cameo/src/runtime/browser/network_emulator.h"
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
+#include "cameo/src/runtime/browser/replay_protocol_handler.h"
+#include "cameo/src/runtime/browser/request_scheduler.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_network_delegate.h"
+#include "cameo/src/runtime/browser/runtime_registry.h"
 #include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/runtime/browser/tiered_http_cache.h"
+#include "cameo/src/runtime/common/app_package.h"
+#include "cameo/src/runtime/common/cameo_constants.h"
 #include "cameo/src/runtime/common/cameo_paths.h"
 #include "cameo/src/runtime/common/cameo_switches.h"
 #include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/render_view_host.h"
 #include "content/public/browser/resource_context.h"
 #include "content/public/browser/storage_partition.h"
+#include "content/public/browser/web_contents.h"
 #include "content/public/common/content_switches.h"
+#include "content/public/common/url_constants.h"
+#include "net/dns/host_cache.h"
+#include "net/dns/host_resolver.h"
 
 using content::BrowserThread;
 
 namespace cameo {
 
+namespace {
+
+// A render process id and render view id.
+typedef std::pair<int, int> ViewId;
+
+// The render view of |runtime|, -1 for both if |runtime| is NULL.
+ViewId GetViewId(Runtime* runtime) {
+  if (!runtime)
+    return ViewId(-1, -1);
+  content::RenderViewHost* render_view_host =
+      runtime->web_contents()->GetRenderViewHost();
+  return ViewId(render_view_host->GetProcess()->GetID(),
+                render_view_host->GetRoutingID());
+}
+
+void CollectNetworkTimingsOnIOThread(
+    scoped_refptr<RuntimeURLRequestContextGetter> getter,
+    base::ListValue* timings) {
+  // Nothing was recorded if the context hasn't been built.
+  RuntimeNetworkDelegate* network_delegate = getter->network_delegate();
+  if (!network_delegate)
+    return;
+  scoped_ptr<base::ListValue> recorded =
+      network_delegate->timing_recorder()->GetAsValue();
+  timings->Swap(recorded.get());
+
+  NetworkEmulator* emulator = network_delegate->network_emulator();
+  for (size_t i = 0; i < timings->GetSize(); ++i) {
+    base::DictionaryValue* owner = NULL;
+    int render_process_id = -1;
+    int render_view_id = -1;
+    if (!timings->GetDictionary(i, &owner) ||
+        !owner->GetInteger("render_process_id", &render_process_id) ||
+        !owner->GetInteger("render_view_id", &render_view_id))
+      continue;
+    owner->SetString(
+        "network_conditions",
+        emulator->GetConditions(render_process_id, render_view_id).ToString());
+  }
+}
+
+void OnNetworkTimingsCollected(
+    const base::Callback<void(const std::string&)>& callback,
+    base::ListValue* timings) {
+  for (size_t i = 0; i < timings->GetSize(); ++i) {
+    base::DictionaryValue* owner = NULL;
+    int render_process_id = -1;
+    int render_view_id = -1;
+    if (!timings->GetDictionary(i, &owner) ||
+        !owner->GetInteger("render_process_id", &render_process_id) ||
+        !owner->GetInteger("render_view_id", &render_view_id))
+      continue;
+    content::RenderViewHost* render_view_host =
+        content::RenderViewHost::FromID(render_process_id, render_view_id);
+    Runtime* runtime = render_view_host && RuntimeRegistry::Get() ?
+        RuntimeRegistry::Get()->GetRuntimeFromRenderViewHost(
+            render_view_host) : NULL;
+    if (runtime)
+      owner->SetString("runtime_url", runtime->web_contents()->GetURL().spec());
+  }
+
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      timings, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  callback.Run(json);
+}
+
+void SetForegroundViewOnIOThread(
+    scoped_refptr<RuntimeURLRequestContextGetter> getter,
+    int render_process_id,
+    int render_view_id) {
+  if (RuntimeNetworkDelegate* network_delegate = getter->network_delegate()) {
+    network_delegate->request_scheduler()->SetForegroundView(
+        render_process_id, render_view_id);
+  }
+}
+
+void SetNetworkConditionsOnIOThread(
+    scoped_refptr<RuntimeURLRequestContextGetter> getter,
+    int render_process_id,
+    int render_view_id,
+    const NetworkEmulator::Conditions& conditions) {
+  // Building the context here lets conditions set before the first request
+  // apply to it.
+  getter->GetURLRequestContext();
+  getter->network_emulator()->SetConditions(render_process_id, render_view_id,
+                                            conditions);
+}
+
+void PrefetchSubresourcesOnIOThread(
+    scoped_refptr<RuntimeURLRequestContextGetter> getter,
+    const GURL& url) {
+  getter->GetURLRequestContext();
+  if (LoadPredictor* load_predictor =
+          getter->network_delegate()->load_predictor())
+    load_predictor->Prefetch(url);
+}
+
+void CollectBytesReadOnIOThread(
+    scoped_refptr<RuntimeURLRequestContextGetter> getter,
+    NetworkTimingRecorder::ByteCountMap* bytes) {
+  // Nothing was read if the context hasn't been built.
+  if (RuntimeNetworkDelegate* network_delegate = getter->network_delegate())
+    network_delegate->timing_recorder()->GetBytesReadByOwner(bytes);
+}
+
+void OnBytesReadCollected(
+    const base::Callback<void(const NetworkTimingRecorder::ByteCountMap&)>&
+        callback,
+    NetworkTimingRecorder::ByteCountMap* bytes) {
+  callback.Run(*bytes);
+}
+
+typedef std::vector<scoped_refptr<RuntimeURLRequestContextGetter> >
+    GetterList;
+
+int64 PurgeMemoryCachesOnIOThread(const GetterList& getters) {
+  int64 bytes = 0;
+  for (size_t i = 0; i < getters.size(); ++i) {
+    // Nothing was cached if the context hasn't been built.
+    if (TieredHttpCache* http_cache = getters[i]->http_cache())
+      bytes += http_cache->PurgeMemoryTier();
+  }
+  // The partitions resolve their hosts with the default context.
+  if (!getters.empty() && getters[0]->http_cache()) {
+    if (net::HostCache* host_cache =
+            getters[0]->host_resolver()->GetHostCache())
+      host_cache->clear();
+  }
+  return bytes;
+}
+
+}  // namespace
+
 class RuntimeContext::RuntimeResourceContext : public content::ResourceContext {
  public:
   RuntimeResourceContext() : getter_(NULL) {}
@@ -45,7 +209,9 @@ class RuntimeContext::RuntimeResourceContext : public content::ResourceContext {
 };
 
 RuntimeContext::RuntimeContext()
-   : resource_context_ (new RuntimeResourceContext) {
+   : resource_context_ (new RuntimeResourceContext),
+     foreground_runtime_(NULL) {
+  TRACE_EVENT0("cameo.startup", "RuntimeContext::RuntimeContext");
   InitWhileIOAllowed();
 }
 
@@ -63,6 +229,14 @@ void RuntimeContext::InitWhileIOAllowed() {
         cmd_line->GetSwitchValuePath(switches::kCameoDataPath);
     PathService::OverrideAndCreateIfNeeded(cameo::DIR_DATA_PATH, path, true);
   }
+  if (cmd_line->HasSwitch(switches::kReplayNetwork)) {
+    base::FilePath path =
+        cmd_line->GetSwitchValuePath(switches::kReplayNetwork);
+    replay_archive_ = NetworkArchive::Load(path);
+    // CameoBrowserMainParts exits rather than silently go to the network.
+    if (!replay_archive_)
+      LOG(ERROR) << "Failed to read the network archive " << path.value();
+  }
 }
 
 base::FilePath RuntimeContext::GetPath() {
@@ -87,24 +261,39 @@ net::URLRequestContextGetter* RuntimeContext::GetRequestContext() {
 net::URLRequestContextGetter*
     RuntimeContext::GetRequestContextForRenderProcess(
         int renderer_child_id)  {
-  return GetRequestContext();
+  content::RenderProcessHost* render_process_host =
+      content::RenderProcessHost::FromID(renderer_child_id);
+  if (!render_process_host)
+    return GetRequestContext();
+  return render_process_host->GetStoragePartition()->GetURLRequestContext();
 }
 
 net::URLRequestContextGetter* RuntimeContext::GetMediaRequestContext()  {
-  return GetRequestContext();
+  GetRequestContext();
+  return GetMediaGetter(url_request_getter_.get(), GetPath(),
+                        IsNetworkArchived());
 }
 
 net::URLRequestContextGetter*
     RuntimeContext::GetMediaRequestContextForRenderProcess(
         int renderer_child_id)  {
-  return GetRequestContext();
+  content::RenderProcessHost* render_process_host =
+      content::RenderProcessHost::FromID(renderer_child_id);
+  if (!render_process_host)
+    return GetMediaRequestContext();
+  return render_process_host->GetStoragePartition()->
+      GetMediaURLRequestContext();
 }
 
 net::URLRequestContextGetter*
     RuntimeContext::GetMediaRequestContextForStoragePartition(
         const base::FilePath& partition_path,
         bool in_memory) {
-  return GetRequestContext();
+  PartitionGetterMap::iterator it = partition_getters_.find(partition_path);
+  if (it == partition_getters_.end())
+    return GetMediaRequestContext();
+  return GetMediaGetter(it->second.get(), partition_path,
+                        in_memory || IsNetworkArchived());
 }
 
 content::ResourceContext* RuntimeContext::GetResourceContext()  {
@@ -128,9 +317,12 @@ quota::SpecialStoragePolicy* RuntimeContext::GetSpecialStoragePolicy() {
 net::URLRequestContextGetter* RuntimeContext::CreateRequestContext(
     content::ProtocolHandlerMap* protocol_handlers) {
   DCHECK(!url_request_getter_);
+  AddProtocolHandlers(protocol_handlers);
   url_request_getter_ = new RuntimeURLRequestContextGetter(
       false, /* ignore_certificate_error = false */
       GetPath(),
+      IsNetworkArchived(),
+      NULL,
       BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::IO),
       BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::FILE),
       protocol_handlers);
@@ -138,12 +330,151 @@ net::URLRequestContextGetter* RuntimeContext::CreateRequestContext(
   return url_request_getter_.get();
 }
 
+void RuntimeContext::GetNetworkTimingsAsJSON(
+    const base::Callback<void(const std::string&)>& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  GetRequestContext();
+  base::ListValue* timings = new base::ListValue;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&CollectNetworkTimingsOnIOThread, url_request_getter_,
+                 timings),
+      base::Bind(&OnNetworkTimingsCollected, callback,
+                 base::Owned(timings)));
+}
+
+void RuntimeContext::GetBytesReadByView(
+    const base::Callback<void(const NetworkTimingRecorder::ByteCountMap&)>&
+        callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  GetRequestContext();
+  NetworkTimingRecorder::ByteCountMap* bytes =
+      new NetworkTimingRecorder::ByteCountMap;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&CollectBytesReadOnIOThread, url_request_getter_, bytes),
+      base::Bind(&OnBytesReadCollected, callback, base::Owned(bytes)));
+}
+
+void RuntimeContext::SetForegroundRuntime(Runtime* runtime) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  foreground_runtime_ = runtime;
+
+  ViewId view = GetViewId(runtime);
+  GetRequestContext();
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&SetForegroundViewOnIOThread, url_request_getter_,
+                 view.first, view.second));
+}
+
+void RuntimeContext::SetNetworkConditions(
+    Runtime* runtime,
+    const NetworkEmulator::Conditions& conditions) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  ViewId view = GetViewId(runtime);
+  GetRequestContext();
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&SetNetworkConditionsOnIOThread, url_request_getter_,
+                 view.first, view.second, conditions));
+}
+
+void RuntimeContext::PrefetchSubresources(const GURL& url) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  GetRequestContext();
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&PrefetchSubresourcesOnIOThread, url_request_getter_, url));
+}
+
+void RuntimeContext::PurgeMemoryCaches(
+    const base::Callback<void(int64)>& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  GetRequestContext();
+  GetterList getters;
+  getters.push_back(url_request_getter_);
+  for (PartitionGetterMap::const_iterator it = partition_getters_.begin();
+       it != partition_getters_.end(); ++it)
+    getters.push_back(it->second);
+  base::PostTaskAndReplyWithResult(
+      BrowserThread::GetMessageLoopProxyForThread(BrowserThread::IO),
+      FROM_HERE,
+      base::Bind(&PurgeMemoryCachesOnIOThread, getters),
+      callback);
+}
+
+void RuntimeContext::set_app_package(AppPackage* package) {
+  DCHECK(!url_request_getter_);
+  app_package_ = package;
+}
+
+void RuntimeContext::WarmUpRequestContext() {
+  // Creating the default storage partition creates |url_request_getter_|.
+  GetRequestContext();
+  DCHECK(url_request_getter_);
+  url_request_getter_->WarmUp();
+}
+
 net::URLRequestContextGetter*
     RuntimeContext::CreateRequestContextForStoragePartition(
         const base::FilePath& partition_path,
         bool in_memory,
         content::ProtocolHandlerMap* protocol_handlers) {
-  return NULL;
+  DCHECK(!ContainsKey(partition_getters_, partition_path));
+  // The partition shares the network session of the default one.
+  GetRequestContext();
+  DCHECK(url_request_getter_);
+  AddProtocolHandlers(protocol_handlers);
+  scoped_refptr<RuntimeURLRequestContextGetter> getter =
+      new RuntimeURLRequestContextGetter(
+          false, /* ignore_certificate_error = false */
+          partition_path,
+          in_memory || IsNetworkArchived(),
+          url_request_getter_.get(),
+          BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::IO),
+          BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::FILE),
+          protocol_handlers);
+  partition_getters_[partition_path] = getter;
+  return getter.get();
+}
+
+MediaURLRequestContextGetter* RuntimeContext::GetMediaGetter(
+    RuntimeURLRequestContextGetter* main_getter,
+    const base::FilePath& partition_path,
+    bool in_memory) {
+  scoped_refptr<MediaURLRequestContextGetter>& getter =
+      media_getters_[partition_path];
+  if (!getter)
+    getter = new MediaURLRequestContextGetter(
+        main_getter, partition_path, in_memory);
+  return getter.get();
+}
+
+void RuntimeContext::AddProtocolHandlers(
+    content::ProtocolHandlerMap* protocol_handlers) {
+  if (app_package_) {
+    (*protocol_handlers)[kAppScheme] =
+        linked_ptr<net::URLRequestJobFactory::ProtocolHandler>(
+            new AppProtocolHandler(app_package_.get()));
+  }
+  if (replay_archive_) {
+    bool replay_latency = CommandLine::ForCurrentProcess()->HasSwitch(
+        switches::kReplayNetworkLatency);
+    const char* schemes[] = { chrome::kHttpScheme, chrome::kHttpsScheme };
+    for (size_t i = 0; i < arraysize(schemes); ++i) {
+      (*protocol_handlers)[schemes[i]] =
+          linked_ptr<net::URLRequestJobFactory::ProtocolHandler>(
+              new ReplayProtocolHandler(replay_archive_.get(),
+                                        replay_latency));
+    }
+  }
+}
+
+bool RuntimeContext::IsNetworkArchived() const {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  return command_line.HasSwitch(switches::kRecordNetwork) ||
+         command_line.HasSwitch(switches::kReplayNetwork);
 }
 
 }  // namespace cameo
@@ -5,13 +5,21 @@
 #ifndef CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_CONTEXT_H_
 #define CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_CONTEXT_H_
 
+#include <map>
+#include <string>
+
+#include "base/callback_forward.h"
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "cameo/src/runtime/browser/network_emulator.h"
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/content_browser_client.h"
 
+class GURL;
+
 namespace net {
 class URLRequestContextGetter;
 }
@@ -22,6 +30,10 @@ class DownloadManagerDelegate;
 
 namespace cameo {
 
+class AppPackage;
+class MediaURLRequestContextGetter;
+class NetworkArchive;
+class Runtime;
 class RuntimeURLRequestContextGetter;
 
 class RuntimeContext : public content::BrowserContext {
@@ -58,15 +70,99 @@ class RuntimeContext : public content::BrowserContext {
       bool in_memory,
       content::ProtocolHandlerMap* protocol_handlers);
 
+  // Starts building the network stack of the default storage partition on
+  // the IO thread, ahead of the first request.
+  void WarmUpRequestContext();
+
+  RuntimeURLRequestContextGetter* url_request_context_getter() const {
+    return url_request_getter_.get();
+  }
+
+  // Collects the network timings of the default storage partition, see
+  // NetworkTimingRecorder, and runs |callback| with them as JSON on the UI
+  // thread. The entries of the render views of a Runtime also hold the URL
+  // the Runtime shows, and all of them the network conditions they were
+  // emulated under.
+  void GetNetworkTimingsAsJSON(
+      const base::Callback<void(const std::string&)>& callback);
+
+  // Runs |callback| on the UI thread with what the requests of every render
+  // view read so far, in all the storage partitions. See
+  // NetworkTimingRecorder::GetBytesReadByOwner().
+  void GetBytesReadByView(
+      const base::Callback<void(const NetworkTimingRecorder::ByteCountMap&)>&
+          callback);
+
+  // Gives the requests of |runtime| precedence over those of the other
+  // Runtimes, see RequestScheduler. NULL when it closes.
+  void SetForegroundRuntime(Runtime* runtime);
+  Runtime* foreground_runtime() const { return foreground_runtime_; }
+
+  // Emulates |conditions| on the requests of the current render view of
+  // |runtime|, or on those of all the Runtimes without conditions of their
+  // own for NULL, see NetworkEmulator.
+  void SetNetworkConditions(Runtime* runtime,
+                            const NetworkEmulator::Conditions& conditions);
+
+  // Starts fetching what the page at |url| loaded in the previous sessions
+  // into the HTTP cache of the default storage partition, see LoadPredictor.
+  void PrefetchSubresources(const GURL& url);
+
+  // Drops the entries of the HTTP memory caches of all the storage
+  // partitions, see TieredHttpCache::PurgeMemoryTier(), and the host cache,
+  // then runs |callback| on the UI thread with the bytes the HTTP cache
+  // entries dropped held. See MemoryPressureCoordinator.
+  void PurgeMemoryCaches(const base::Callback<void(int64)>& callback);
+
+  // The package served under app://, see AppProtocolHandler. Must be set
+  // before the request context is created.
+  void set_app_package(AppPackage* package);
+
+  // The archive served with --replay-network, NULL if there is none or it
+  // couldn't be read.
+  NetworkArchive* replay_archive() const { return replay_archive_.get(); }
+
  private:
   class RuntimeResourceContext;
 
+  typedef std::map<base::FilePath,
+                   scoped_refptr<RuntimeURLRequestContextGetter> >
+      PartitionGetterMap;
+  typedef std::map<base::FilePath,
+                   scoped_refptr<MediaURLRequestContextGetter> >
+      MediaGetterMap;
+
   // Performs initialization of the RuntimeContext while IO is still
   // allowed on the current thread.
   void InitWhileIOAllowed();
 
+  // Returns the media getter of the partition at |partition_path|, whose
+  // request context is |main_getter|, creating it on first use.
+  MediaURLRequestContextGetter* GetMediaGetter(
+      RuntimeURLRequestContextGetter* main_getter,
+      const base::FilePath& partition_path,
+      bool in_memory);
+
+  // Adds the handler of app:// to |protocol_handlers| if there is a package,
+  // and those of HTTP and HTTPS if the network is replayed.
+  void AddProtocolHandlers(content::ProtocolHandlerMap* protocol_handlers);
+
+  // Whether the network is recorded or replayed, in which case nothing is
+  // cached or stored on disk, so every run starts from the same state.
+  bool IsNetworkArchived() const;
+
   scoped_ptr<RuntimeResourceContext> resource_context_;
   scoped_refptr<RuntimeURLRequestContextGetter> url_request_getter_;
+  // The getters of the storage partitions other than the default one, by
+  // partition path. They share the network session of |url_request_getter_|.
+  PartitionGetterMap partition_getters_;
+  // The media getters of all the partitions, the default one included, by
+  // partition path.
+  MediaGetterMap media_getters_;
+  scoped_refptr<AppPackage> app_package_;
+  // The archive served with --replay-network.
+  scoped_refptr<NetworkArchive> replay_archive_;
+  Runtime* foreground_runtime_;
 
   DISALLOW_COPY_AND_ASSIGN(RuntimeContext);
 };
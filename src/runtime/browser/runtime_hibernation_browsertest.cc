@@ -0,0 +1,131 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <set>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/process_util.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/browser/ui/native_app_window.h"
+#include "cameo/src/test/base/cameo_headless_runtime_test.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+
+using cameo::Runtime;
+using cameo::RuntimeRegistry;
+
+namespace {
+
+const int kRuntimeCount = 5;
+
+// Counts the hibernations and resumptions of the Runtimes.
+class HibernationCounter : public cameo::RuntimeRegistryObserver {
+ public:
+  HibernationCounter() : hibernated_(0), resumed_(0) {}
+
+  virtual void OnRuntimeAdded(Runtime* runtime) OVERRIDE {}
+  virtual void OnRuntimeRemoved(Runtime* runtime) OVERRIDE {}
+  virtual void OnRuntimeHibernated(Runtime* runtime) OVERRIDE {
+    ++hibernated_;
+  }
+  virtual void OnRuntimeResumed(Runtime* runtime) OVERRIDE {
+    ++resumed_;
+  }
+
+  int hibernated() const { return hibernated_; }
+  int resumed() const { return resumed_; }
+
+ private:
+  int hibernated_;
+  int resumed_;
+};
+
+// The working set of the browser process and of the render processes
+// |runtimes| have, in bytes.
+size_t GetWorkingSetSize(const std::vector<Runtime*>& runtimes) {
+  std::set<base::ProcessHandle> handles;
+  handles.insert(base::GetCurrentProcessHandle());
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    // Not started for the hibernated ones.
+    base::ProcessHandle handle =
+        runtimes[i]->web_contents()->GetRenderProcessHost()->GetHandle();
+    if (handle != base::kNullProcessHandle)
+      handles.insert(handle);
+  }
+
+  size_t size = 0;
+  for (std::set<base::ProcessHandle>::iterator it = handles.begin();
+       it != handles.end(); ++it) {
+    scoped_ptr<base::ProcessMetrics> metrics(
+        base::ProcessMetrics::CreateProcessMetrics(*it));
+    size += metrics->GetWorkingSetSize();
+  }
+  return size;
+}
+
+}  // namespace
+
+typedef CameoHeadlessRuntimeTest RuntimeHibernationTest;
+
+IN_PROC_BROWSER_TEST_F(RuntimeHibernationTest, HibernateBenchmark) {
+  HibernationCounter counter;
+  RuntimeRegistry::Get()->AddObserver(&counter);
+  GURL url = cameo_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII("memory.html"));
+  string16 loaded = ASCIIToUTF16("loaded");
+
+  std::vector<Runtime*> runtimes;
+  for (int i = 0; i < kRuntimeCount; ++i) {
+    Runtime* runtime = Runtime::Create(runtime()->runtime_context(), url);
+    content::TitleWatcher title_watcher(runtime->web_contents(), loaded);
+    EXPECT_EQ(loaded, title_watcher.WaitAndGetTitle());
+    runtimes.push_back(runtime);
+  }
+  size_t awake_size = GetWorkingSetSize(runtimes);
+
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    // Only Runtimes in the background hibernate.
+    runtimes[i]->Hibernate();
+    EXPECT_FALSE(runtimes[i]->is_hibernated());
+    runtimes[i]->window()->Minimize();
+    runtimes[i]->Hibernate();
+    EXPECT_TRUE(runtimes[i]->is_hibernated());
+  }
+  EXPECT_EQ(kRuntimeCount, counter.hibernated());
+  // Lets the render processes exit.
+  cameo_test_utils::RunMessageLoopFor(base::TimeDelta::FromSeconds(2));
+  size_t hibernated_size = GetWorkingSetSize(runtimes);
+
+  base::TimeDelta resume_time;
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    content::TitleWatcher title_watcher(runtimes[i]->web_contents(), loaded);
+    base::TimeTicks start = base::TimeTicks::Now();
+    runtimes[i]->window()->Restore();
+    EXPECT_EQ(loaded, title_watcher.WaitAndGetTitle());
+    resume_time += base::TimeTicks::Now() - start;
+    EXPECT_FALSE(runtimes[i]->is_hibernated());
+    EXPECT_EQ(url, runtimes[i]->web_contents()->GetURL());
+  }
+  EXPECT_EQ(kRuntimeCount, counter.resumed());
+
+  RuntimeRegistry::Get()->RemoveObserver(&counter);
+  for (size_t i = 0; i < runtimes.size(); ++i)
+    runtimes[i]->Close();
+
+  double reclaimed =
+      static_cast<double>(awake_size) - static_cast<double>(hibernated_size);
+  cameo_test_utils::PrintPerfResult("hibernation", "reclaimed_per_runtime",
+                                    reclaimed / kRuntimeCount / 1024, "KB");
+  cameo_test_utils::PrintPerfResult("hibernation", "resume_time",
+                                    resume_time.InMillisecondsF() /
+                                        kRuntimeCount,
+                                    "ms");
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/runtime_index.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+using content::RenderViewHost;
+using content::WebContents;
+
+namespace cameo {
+
+RuntimeIndex::RuntimeIndex()
+    : next_sequence_(0),
+      runtimes_outdated_(false) {
+}
+
+RuntimeIndex::~RuntimeIndex() {
+}
+
+void RuntimeIndex::Add(Runtime* runtime,
+                       WebContents* web_contents,
+                       RenderViewHost* render_view_host,
+                       int render_process_id) {
+  DCHECK(!Contains(runtime));
+  Entry entry;
+  entry.sequence = next_sequence_++;
+  entry.web_contents = web_contents;
+  entry.render_view_host = render_view_host;
+  entry.render_process_id = render_process_id;
+  entries_[runtime] = entry;
+
+  by_sequence_[entry.sequence] = runtime;
+  if (!runtimes_outdated_)
+    runtimes_.push_back(runtime);
+  by_web_contents_[web_contents] = runtime;
+  if (render_view_host)
+    by_render_view_host_[render_view_host] = runtime;
+  AddToRenderProcess(runtime, render_process_id);
+}
+
+void RuntimeIndex::Remove(Runtime* runtime) {
+  base::hash_map<Runtime*, Entry>::iterator it = entries_.find(runtime);
+  if (it == entries_.end())
+    return;
+  const Entry& entry = it->second;
+
+  size_t erased = by_sequence_.erase(entry.sequence);
+  DCHECK_EQ(1u, erased);
+  runtimes_outdated_ = true;
+
+  by_web_contents_.erase(entry.web_contents);
+  if (entry.render_view_host)
+    by_render_view_host_.erase(entry.render_view_host);
+  RemoveFromRenderProcess(runtime, entry.render_process_id);
+  entries_.erase(it);
+}
+
+void RuntimeIndex::UpdateRenderViewHost(Runtime* runtime,
+                                        RenderViewHost* render_view_host,
+                                        int render_process_id) {
+  base::hash_map<Runtime*, Entry>::iterator it = entries_.find(runtime);
+  if (it == entries_.end())
+    return;
+  Entry& entry = it->second;
+
+  if (entry.render_view_host != render_view_host) {
+    // The view swapped out keeps living, it just isn't the runtime's anymore.
+    if (entry.render_view_host)
+      by_render_view_host_.erase(entry.render_view_host);
+    if (render_view_host)
+      by_render_view_host_[render_view_host] = runtime;
+    entry.render_view_host = render_view_host;
+  }
+  if (entry.render_process_id != render_process_id) {
+    RemoveFromRenderProcess(runtime, entry.render_process_id);
+    AddToRenderProcess(runtime, render_process_id);
+    entry.render_process_id = render_process_id;
+  }
+}
+
+void RuntimeIndex::UpdateWebContents(Runtime* runtime,
+                                     WebContents* web_contents) {
+  base::hash_map<Runtime*, Entry>::iterator it = entries_.find(runtime);
+  if (it == entries_.end())
+    return;
+  Entry& entry = it->second;
+  by_web_contents_.erase(entry.web_contents);
+  by_web_contents_[web_contents] = runtime;
+  entry.web_contents = web_contents;
+}
+
+const RuntimeList& RuntimeIndex::runtimes() const {
+  if (runtimes_outdated_) {
+    runtimes_.clear();
+    for (std::map<int64, Runtime*>::const_iterator it = by_sequence_.begin();
+         it != by_sequence_.end(); ++it)
+      runtimes_.push_back(it->second);
+    runtimes_outdated_ = false;
+  }
+  return runtimes_;
+}
+
+bool RuntimeIndex::Contains(Runtime* runtime) const {
+  return entries_.find(runtime) != entries_.end();
+}
+
+Runtime* RuntimeIndex::GetByRenderViewHost(
+    RenderViewHost* render_view_host) const {
+  base::hash_map<RenderViewHost*, Runtime*>::const_iterator it =
+      by_render_view_host_.find(render_view_host);
+  return it != by_render_view_host_.end() ? it->second : NULL;
+}
+
+Runtime* RuntimeIndex::GetByWebContents(WebContents* web_contents) const {
+  base::hash_map<WebContents*, Runtime*>::const_iterator it =
+      by_web_contents_.find(web_contents);
+  return it != by_web_contents_.end() ? it->second : NULL;
+}
+
+void RuntimeIndex::GetByRenderProcess(int render_process_id,
+                                      RuntimeList* runtimes) const {
+  base::hash_map<int, RuntimeList>::const_iterator it =
+      by_render_process_.find(render_process_id);
+  if (it != by_render_process_.end())
+    runtimes->insert(runtimes->end(), it->second.begin(), it->second.end());
+}
+
+void RuntimeIndex::AddToRenderProcess(Runtime* runtime,
+                                      int render_process_id) {
+  by_render_process_[render_process_id].push_back(runtime);
+}
+
+void RuntimeIndex::RemoveFromRenderProcess(Runtime* runtime,
+                                           int render_process_id) {
+  base::hash_map<int, RuntimeList>::iterator it =
+      by_render_process_.find(render_process_id);
+  if (it == by_render_process_.end())
+    return;
+  RuntimeList& runtimes = it->second;
+  RuntimeList::iterator position =
+      std::find(runtimes.begin(), runtimes.end(), runtime);
+  DCHECK(position != runtimes.end());
+  runtimes.erase(position);
+  if (runtimes.empty())
+    by_render_process_.erase(it);
+}
+
+}  // namespace cameo
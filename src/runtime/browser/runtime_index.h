@@ -0,0 +1,96 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_INDEX_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_INDEX_H_
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+
+namespace content {
+class RenderViewHost;
+class WebContents;
+}
+
+namespace cameo {
+
+class Runtime;
+
+typedef std::vector<Runtime*> RuntimeList;
+
+// RuntimeIndex keeps the runtimes in the order they were added, along with
+// hash indexes from their WebContents, their current RenderViewHost and the
+// render process of the latter, so that the lookups done for every IPC don't
+// walk all of them. It only deals with the pointers it is given, the caller
+// tells it when the render view host of a runtime changes.
+class RuntimeIndex {
+ public:
+  RuntimeIndex();
+  ~RuntimeIndex();
+
+  // Adds |runtime|, which shows |web_contents| in |render_view_host|, a view
+  // of the render process |render_process_id|.
+  void Add(Runtime* runtime,
+           content::WebContents* web_contents,
+           content::RenderViewHost* render_view_host,
+           int render_process_id);
+  void Remove(Runtime* runtime);
+
+  // Called when |runtime| moved to |render_view_host|, either a new one after
+  // a cross-process navigation or one it had swapped out before.
+  void UpdateRenderViewHost(Runtime* runtime,
+                            content::RenderViewHost* render_view_host,
+                            int render_process_id);
+
+  // Called when |runtime| replaced its WebContents with |web_contents|.
+  void UpdateWebContents(Runtime* runtime, content::WebContents* web_contents);
+
+  bool Contains(Runtime* runtime) const;
+  // Return NULL when no runtime matches.
+  Runtime* GetByRenderViewHost(
+      content::RenderViewHost* render_view_host) const;
+  Runtime* GetByWebContents(content::WebContents* web_contents) const;
+  // Appends the runtimes whose current view lives in the render process
+  // |render_process_id| to |runtimes|.
+  void GetByRenderProcess(int render_process_id, RuntimeList* runtimes) const;
+
+  // In the order they were added. Rebuilt on the first call after a
+  // removal, which spares every removal moving the runtimes after it.
+  const RuntimeList& runtimes() const;
+
+ private:
+  struct Entry {
+    // Increases with every runtime added, the key of |by_sequence_|.
+    int64 sequence;
+    content::WebContents* web_contents;
+    content::RenderViewHost* render_view_host;
+    int render_process_id;
+  };
+
+  void AddToRenderProcess(Runtime* runtime, int render_process_id);
+  void RemoveFromRenderProcess(Runtime* runtime, int render_process_id);
+
+  base::hash_map<Runtime*, Entry> entries_;
+
+  // The runtimes in the order they were added, which a removal takes one of
+  // in logarithmic time, and the list runtimes() returns, built from it.
+  std::map<int64, Runtime*> by_sequence_;
+  int64 next_sequence_;
+  mutable RuntimeList runtimes_;
+  mutable bool runtimes_outdated_;
+
+  base::hash_map<content::RenderViewHost*, Runtime*> by_render_view_host_;
+  base::hash_map<content::WebContents*, Runtime*> by_web_contents_;
+  // Few runtimes share a render process, their lists stay short.
+  base::hash_map<int, RuntimeList> by_render_process_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeIndex);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_INDEX_H_
@@ -0,0 +1,155 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/runtime_index.h"
+
+#include <string>
+#include <vector>
+
+#include "base/string_number_conversions.h"
+#include "base/time.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using cameo::Runtime;
+using cameo::RuntimeIndex;
+using cameo::RuntimeList;
+using content::RenderViewHost;
+using content::WebContents;
+
+namespace {
+
+// The index never looks at what its keys point to, so distinct addresses
+// stand for the runtimes, their contents and their views.
+class FakeRuntimes {
+ public:
+  explicit FakeRuntimes(size_t count) : storage_(count * 3) {}
+
+  Runtime* runtime(size_t i) {
+    return reinterpret_cast<Runtime*>(&storage_[i * 3]);
+  }
+  WebContents* web_contents(size_t i) {
+    return reinterpret_cast<WebContents*>(&storage_[i * 3 + 1]);
+  }
+  RenderViewHost* render_view_host(size_t i) {
+    return reinterpret_cast<RenderViewHost*>(&storage_[i * 3 + 2]);
+  }
+  // A few views share each render process, as in the dashboard host.
+  int render_process_id(size_t i) { return static_cast<int>(i / 4); }
+
+  void AddTo(RuntimeIndex* index, size_t i) {
+    index->Add(runtime(i), web_contents(i), render_view_host(i),
+               render_process_id(i));
+  }
+
+ private:
+  std::vector<char> storage_;
+};
+
+double MicrosecondsPerOperation(base::TimeTicks start, size_t count) {
+  return (base::TimeTicks::HighResNow() - start).InMicrosecondsF() / count;
+}
+
+}  // namespace
+
+TEST(RuntimeIndexTest, KeepsOrderAcrossRemovals) {
+  FakeRuntimes fakes(5);
+  RuntimeIndex index;
+  for (size_t i = 0; i < 5; ++i)
+    fakes.AddTo(&index, i);
+  index.Remove(fakes.runtime(1));
+  index.Remove(fakes.runtime(3));
+  fakes.AddTo(&index, 1);
+
+  const RuntimeList& runtimes = index.runtimes();
+  ASSERT_EQ(4u, runtimes.size());
+  EXPECT_EQ(fakes.runtime(0), runtimes[0]);
+  EXPECT_EQ(fakes.runtime(2), runtimes[1]);
+  EXPECT_EQ(fakes.runtime(4), runtimes[2]);
+  EXPECT_EQ(fakes.runtime(1), runtimes[3]);
+
+  EXPECT_FALSE(index.Contains(fakes.runtime(3)));
+  EXPECT_EQ(NULL, index.GetByWebContents(fakes.web_contents(3)));
+  EXPECT_EQ(NULL, index.GetByRenderViewHost(fakes.render_view_host(3)));
+  EXPECT_EQ(fakes.runtime(1), index.GetByWebContents(fakes.web_contents(1)));
+}
+
+TEST(RuntimeIndexTest, FollowsCrossProcessNavigations) {
+  FakeRuntimes fakes(3);
+  RuntimeIndex index;
+  fakes.AddTo(&index, 0);
+  fakes.AddTo(&index, 1);
+
+  // Runtime 0 navigates to another site, in the view of fake 2 and a render
+  // process of its own, swapping out its first view.
+  index.UpdateRenderViewHost(fakes.runtime(0), fakes.render_view_host(2), 7);
+  EXPECT_EQ(NULL, index.GetByRenderViewHost(fakes.render_view_host(0)));
+  EXPECT_EQ(fakes.runtime(0),
+            index.GetByRenderViewHost(fakes.render_view_host(2)));
+  RuntimeList in_process;
+  index.GetByRenderProcess(0, &in_process);
+  ASSERT_EQ(1u, in_process.size());
+  EXPECT_EQ(fakes.runtime(1), in_process[0]);
+  in_process.clear();
+  index.GetByRenderProcess(7, &in_process);
+  ASSERT_EQ(1u, in_process.size());
+  EXPECT_EQ(fakes.runtime(0), in_process[0]);
+
+  // And back to the swapped out view.
+  index.UpdateRenderViewHost(fakes.runtime(0), fakes.render_view_host(0), 0);
+  EXPECT_EQ(fakes.runtime(0),
+            index.GetByRenderViewHost(fakes.render_view_host(0)));
+  EXPECT_EQ(NULL, index.GetByRenderViewHost(fakes.render_view_host(2)));
+  in_process.clear();
+  index.GetByRenderProcess(7, &in_process);
+  EXPECT_TRUE(in_process.empty());
+
+  index.Remove(fakes.runtime(0));
+  index.Remove(fakes.runtime(1));
+  in_process.clear();
+  index.GetByRenderProcess(0, &in_process);
+  EXPECT_TRUE(in_process.empty());
+  EXPECT_TRUE(index.runtimes().empty());
+}
+
+// Adds the runtimes, looks each of them up by view and by contents, then
+// removes them oldest first. Each removal only takes its runtime out of the
+// map by sequence, and the list runtimes() returns is rebuilt once at the end.
+TEST(RuntimeIndexTest, AddRemoveLookupBenchmark) {
+  const size_t kCounts[] = { 10, 1000, 10000 };
+  for (size_t c = 0; c < arraysize(kCounts); ++c) {
+    size_t count = kCounts[c];
+    FakeRuntimes fakes(count);
+    RuntimeIndex index;
+
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (size_t i = 0; i < count; ++i)
+      fakes.AddTo(&index, i);
+    double add = MicrosecondsPerOperation(start, count);
+
+    start = base::TimeTicks::HighResNow();
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (index.GetByRenderViewHost(fakes.render_view_host(i)) ==
+              fakes.runtime(i) &&
+          index.GetByWebContents(fakes.web_contents(i)) == fakes.runtime(i))
+        ++found;
+    }
+    double lookup = MicrosecondsPerOperation(start, count * 2);
+    EXPECT_EQ(count, found);
+
+    start = base::TimeTicks::HighResNow();
+    for (size_t i = 0; i < count; ++i)
+      index.Remove(fakes.runtime(i));
+    double remove = MicrosecondsPerOperation(start, count);
+    EXPECT_TRUE(index.runtimes().empty());
+
+    std::string trace = base::Uint64ToString(count);
+    cameo_test_utils::PrintPerfResult("runtime_index_add", trace, add, "us");
+    cameo_test_utils::PrintPerfResult("runtime_index_lookup", trace, lookup,
+                                      "us");
+    cameo_test_utils::PrintPerfResult("runtime_index_remove", trace, remove,
+                                      "us");
+  }
+}
@@ -4,13 +4,23 @@
 
 #include "cameo/src/runtime/browser/runtime_network_delegate.h"
 
+#include "cameo/src/runtime/browser/load_predictor.h"
+#include "cameo/src/runtime/browser/network_emulator.h"
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
+#include "cameo/src/runtime/browser/request_scheduler.h"
+#include "cameo/src/runtime/browser/startup_predictor.h"
 #include "net/base/net_errors.h"
 #include "net/base/static_cookie_policy.h"
 #include "net/url_request/url_request.h"
 
 namespace cameo {
 
-RuntimeNetworkDelegate::RuntimeNetworkDelegate() {
+RuntimeNetworkDelegate::RuntimeNetworkDelegate()
+    : startup_predictor_(NULL),
+      load_predictor_(NULL),
+      timing_recorder_(new NetworkTimingRecorder),
+      request_scheduler_(new RequestScheduler),
+      network_emulator_(new NetworkEmulator) {
 }
 
 RuntimeNetworkDelegate::~RuntimeNetworkDelegate() {
@@ -20,7 +30,11 @@ int RuntimeNetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
-  return net::OK;
+  if (startup_predictor_)
+    startup_predictor_->LearnFromRequest(*request);
+  if (load_predictor_)
+    load_predictor_->LearnFromRequest(*request);
+  return request_scheduler_->OnBeforeURLRequest(request, callback);
 }
 
 int RuntimeNetworkDelegate::OnBeforeSendHeaders(
@@ -33,6 +47,7 @@ int RuntimeNetworkDelegate::OnBeforeSendHeaders(
 void RuntimeNetworkDelegate::OnSendHeaders(
     net::URLRequest* request,
     const net::HttpRequestHeaders& headers) {
+  network_emulator_->OnSendHeaders(*request);
 }
 
 int RuntimeNetworkDelegate::OnHeadersReceived(
@@ -48,17 +63,24 @@ void RuntimeNetworkDelegate::OnBeforeRedirect(net::URLRequest* request,
 }
 
 void RuntimeNetworkDelegate::OnResponseStarted(net::URLRequest* request) {
+  timing_recorder_->OnResponseStarted(*request);
 }
 
 void RuntimeNetworkDelegate::OnRawBytesRead(const net::URLRequest& request,
                                             int bytes_read) {
+  timing_recorder_->OnRawBytesRead(request, bytes_read);
 }
 
 void RuntimeNetworkDelegate::OnCompleted(net::URLRequest* request,
                                          bool started) {
+  if (started)
+    timing_recorder_->OnCompleted(*request);
+  request_scheduler_->OnRequestDone(*request);
 }
 
 void RuntimeNetworkDelegate::OnURLRequestDestroyed(net::URLRequest* request) {
+  timing_recorder_->OnURLRequestDestroyed(*request);
+  request_scheduler_->OnRequestDone(*request);
 }
 
 void RuntimeNetworkDelegate::OnPACScriptError(int line_number,
@@ -95,7 +117,9 @@ bool RuntimeNetworkDelegate::OnCanAccessFile(const net::URLRequest& request,
 
 bool RuntimeNetworkDelegate::OnCanThrottleRequest(
     const net::URLRequest& request) const {
-  return false;
+  // Let the throttler back off the background Runtimes hitting a server which
+  // fails, but never the one the user is looking at.
+  return request_scheduler_->IsBackgroundRequest(request);
 }
 
 int RuntimeNetworkDelegate::OnBeforeSocketStreamConnect(
@@ -9,15 +9,50 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
 #include "net/base/network_delegate.h"
 
 namespace cameo {
 
+class LoadPredictor;
+class NetworkEmulator;
+class NetworkTimingRecorder;
+class RequestScheduler;
+class StartupPredictor;
+
 class RuntimeNetworkDelegate : public net::NetworkDelegate {
  public:
   RuntimeNetworkDelegate();
   virtual ~RuntimeNetworkDelegate();
 
+  // Lets |predictor| learn from the requests of the startup page, NULL stops
+  // it. The predictor must outlive its registration.
+  void set_startup_predictor(StartupPredictor* predictor) {
+    startup_predictor_ = predictor;
+  }
+
+  // Lets |predictor| learn which subresources the pages load, NULL stops
+  // it. The predictor must outlive its registration.
+  void set_load_predictor(LoadPredictor* predictor) {
+    load_predictor_ = predictor;
+  }
+  LoadPredictor* load_predictor() const { return load_predictor_; }
+
+  // Decides when the requests of each Runtime start.
+  RequestScheduler* request_scheduler() const {
+    return request_scheduler_.get();
+  }
+
+  // The network conditions the requests are under.
+  NetworkEmulator* network_emulator() const {
+    return network_emulator_.get();
+  }
+
+  // The timings of every request going through this delegate.
+  NetworkTimingRecorder* timing_recorder() const {
+    return timing_recorder_.get();
+  }
+
  private:
   // net::NetworkDelegate implementation.
   virtual int OnBeforeURLRequest(net::URLRequest* request,
@@ -63,6 +98,12 @@ class RuntimeNetworkDelegate : public net::NetworkDelegate {
   virtual void OnRequestWaitStateChange(const net::URLRequest& request,
                                         RequestWaitState state) OVERRIDE;
 
+  StartupPredictor* startup_predictor_;
+  LoadPredictor* load_predictor_;
+  scoped_ptr<NetworkTimingRecorder> timing_recorder_;
+  scoped_ptr<RequestScheduler> request_scheduler_;
+  scoped_ptr<NetworkEmulator> network_emulator_;
+
   DISALLOW_COPY_AND_ASSIGN(RuntimeNetworkDelegate);
 };
 
@@ -7,15 +7,26 @@
 #include "cameo/src/runtime/browser/runtime.h"
 #include "cameo/src/runtime/common/cameo_notification_types.h"
 #include "content/public/browser/notification_service.h"
+#include "content/public/browser/render_process_host.h"
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/web_contents.h"
 
 using content::RenderViewHost;
+using content::WebContents;
 
 namespace cameo {
 
+namespace {
+
 // An application-wide runtime registry.
-static RuntimeRegistry* g_runtime_registry = NULL;
+RuntimeRegistry* g_runtime_registry = NULL;
+
+// The render process of the view, -1 when there is none.
+int GetRenderProcessId(RenderViewHost* render_view_host) {
+  return render_view_host ? render_view_host->GetProcess()->GetID() : -1;
+}
+
+}  // namespace
 
 RuntimeRegistry::RuntimeRegistry() {
   DCHECK(g_runtime_registry == NULL);
@@ -24,7 +35,7 @@ RuntimeRegistry::RuntimeRegistry() {
 
 RuntimeRegistry::~RuntimeRegistry() {
   DCHECK(g_runtime_registry);
-  DCHECK(runtime_list_.empty()) <<
+  DCHECK(runtime_index_.runtimes().empty()) <<
       "Runtime instances are not empty!";
   g_runtime_registry = NULL;
 }
@@ -43,7 +54,10 @@ void RuntimeRegistry::RemoveObserver(RuntimeRegistryObserver* obs) {
 }
 
 void RuntimeRegistry::AddRuntime(Runtime* runtime) {
-  runtime_list_.push_back(runtime);
+  WebContents* web_contents = runtime->web_contents();
+  RenderViewHost* render_view_host = web_contents->GetRenderViewHost();
+  runtime_index_.Add(runtime, web_contents, render_view_host,
+                     GetRenderProcessId(render_view_host));
 
   content::NotificationService::current()->Notify(
       cameo::NOTIFICATION_RUNTIME_OPENED,
@@ -55,10 +69,7 @@ void RuntimeRegistry::AddRuntime(Runtime* runtime) {
 }
 
 void RuntimeRegistry::RemoveRuntime(Runtime* runtime) {
-  RuntimeList::iterator it =
-      std::find(runtime_list_.begin(), runtime_list_.end(), runtime);
-  if (it != runtime_list_.end())
-    runtime_list_.erase(it);
+  runtime_index_.Remove(runtime);
 
   content::NotificationService::current()->Notify(
       cameo::NOTIFICATION_RUNTIME_CLOSED,
@@ -69,31 +80,66 @@ void RuntimeRegistry::RemoveRuntime(Runtime* runtime) {
                     OnRuntimeRemoved(runtime));
 }
 
+void RuntimeRegistry::OnRenderViewHostChanged(Runtime* runtime) {
+  RenderViewHost* render_view_host =
+      runtime->web_contents()->GetRenderViewHost();
+  runtime_index_.UpdateRenderViewHost(runtime, render_view_host,
+                                      GetRenderProcessId(render_view_host));
+}
+
+void RuntimeRegistry::OnRuntimeHibernated(Runtime* runtime) {
+  WebContents* web_contents = runtime->web_contents();
+  RenderViewHost* render_view_host = web_contents->GetRenderViewHost();
+  runtime_index_.UpdateWebContents(runtime, web_contents);
+  runtime_index_.UpdateRenderViewHost(runtime, render_view_host,
+                                      GetRenderProcessId(render_view_host));
+
+  content::NotificationService::current()->Notify(
+      cameo::NOTIFICATION_RUNTIME_HIBERNATED,
+      content::Source<Runtime>(runtime),
+      content::NotificationService::NoDetails());
+
+  FOR_EACH_OBSERVER(RuntimeRegistryObserver, observer_list_,
+                    OnRuntimeHibernated(runtime));
+}
+
+void RuntimeRegistry::OnRuntimeResumed(Runtime* runtime) {
+  OnRenderViewHostChanged(runtime);
+
+  content::NotificationService::current()->Notify(
+      cameo::NOTIFICATION_RUNTIME_RESUMED,
+      content::Source<Runtime>(runtime),
+      content::NotificationService::NoDetails());
+
+  FOR_EACH_OBSERVER(RuntimeRegistryObserver, observer_list_,
+                    OnRuntimeResumed(runtime));
+}
+
 Runtime* RuntimeRegistry::GetRuntimeFromRenderViewHost(
     RenderViewHost* render_view_host) const {
-  for (RuntimeList::const_iterator it = runtime_list_.begin();
-       it != runtime_list_.end(); ++it) {
-    if ((*it)->web_contents()->GetRenderViewHost() == render_view_host)
-      return (*it);
-  }
-  return NULL;
+  return runtime_index_.GetByRenderViewHost(render_view_host);
 }
 
-void RuntimeRegistry::CloseAll() {
-  RuntimeList cached_runtimes;
-
-  RuntimeList::iterator it = runtime_list_.begin();
-  for(; it != runtime_list_.end(); ++it) {
-    cached_runtimes.push_back(*it);
-  }
+Runtime* RuntimeRegistry::GetRuntimeFromWebContents(
+    WebContents* web_contents) const {
+  return runtime_index_.GetByWebContents(web_contents);
+}
 
-  for (it = cached_runtimes.begin(); it != cached_runtimes.end(); ++it)
-    (*it)->Close();
+void RuntimeRegistry::GetRuntimesFromRenderProcess(
+    int render_process_id, RuntimeList* runtimes) const {
+  runtime_index_.GetByRenderProcess(render_process_id, runtimes);
+}
 
+void RuntimeRegistry::CloseAll() {
   // If a Runtime is closed, it will be deleted by itself and also be removed
-  // from RuntimeRegistry. The runtime vector should be empty after all
-  // Runtime instances are closed.
-  DCHECK(runtime_list_.size() == 0) << runtime_list_.size();
+  // from RuntimeRegistry, so they are closed from a copy, in the order they
+  // were added.
+  RuntimeList cached_runtimes(runtimes());
+  for (RuntimeList::iterator it = cached_runtimes.begin();
+       it != cached_runtimes.end(); ++it)
+    (*it)->Close();
+  // The runtime list should be empty after all of them are closed.
+  DCHECK(runtimes().empty()) << runtimes().size();
 }
 
 }  // namespace cameo
@@ -6,9 +6,11 @@
 #define CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_REGISTRY_H_
 
 #include "base/observer_list.h"
+#include "cameo/src/runtime/browser/runtime_index.h"
 
 namespace content {
 class RenderViewHost;
+class WebContents;
 };
 
 namespace cameo {
@@ -24,12 +26,15 @@ class RuntimeRegistryObserver {
   // Called when a Runtime instance is removed.
   virtual void OnRuntimeRemoved(Runtime* runtime) = 0;
 
+  // Called when a Runtime instance hibernated, or resumed, see
+  // Runtime::Hibernate().
+  virtual void OnRuntimeHibernated(Runtime* runtime) {}
+  virtual void OnRuntimeResumed(Runtime* runtime) {}
+
  protected:
   virtual ~RuntimeRegistryObserver() {}
 };
 
-typedef std::vector<Runtime*> RuntimeList;
-
 // RuntimeRegistry maintains a list of Runtime created for running app.
 // It allows to retrieve all Runtime instances via RuntimeRegistry.
 class RuntimeRegistry {
@@ -44,10 +49,28 @@ class RuntimeRegistry {
   void AddRuntime(Runtime* runtime);
   void RemoveRuntime(Runtime* runtime);
 
-  // Find a runtime from a RenderViewHost
+  // Called by |runtime| when a navigation swapped its render view host, to
+  // keep the lookups below up to date.
+  void OnRenderViewHostChanged(Runtime* runtime);
+
+  // Called by |runtime| once it hibernated, with the WebContents it keeps
+  // until it resumes, and once it resumed.
+  void OnRuntimeHibernated(Runtime* runtime);
+  void OnRuntimeResumed(Runtime* runtime);
+
+  // Find a runtime from the current RenderViewHost of its WebContents.
   Runtime* GetRuntimeFromRenderViewHost(
       content::RenderViewHost* render_view_host) const;
-  const RuntimeList& runtimes() const { return runtime_list_; }
+  // Find a runtime from its WebContents.
+  Runtime* GetRuntimeFromWebContents(
+      content::WebContents* web_contents) const;
+  // Append the runtimes whose current view lives in the render process
+  // |render_process_id| to |runtimes|.
+  void GetRuntimesFromRenderProcess(int render_process_id,
+                                    RuntimeList* runtimes) const;
+
+  // In the order they were added.
+  const RuntimeList& runtimes() const { return runtime_index_.runtimes(); }
 
   // Close all running Runtime instances.
   void CloseAll();
@@ -57,7 +80,7 @@ class RuntimeRegistry {
   void RemoveObserver(RuntimeRegistryObserver* obs);
 
  private:
-  RuntimeList runtime_list_;
+  RuntimeIndex runtime_index_;
 
   ObserverList<RuntimeRegistryObserver> observer_list_;
 };
@@ -0,0 +1,358 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/runtime_resource_monitor.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/process_util.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/strings/string_split.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/render_view_host.h"
+#include "content/public/browser/web_contents.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// The application-wide monitor.
+RuntimeResourceMonitor* g_runtime_resource_monitor = NULL;
+
+const int kDefaultIntervalSeconds = 5;
+
+// Reads the memory of every process of |pids|. Does blocking IO.
+std::map<base::ProcessId, RuntimeResourceMonitor::ProcessMemory>
+ReadProcessesMemory(const std::vector<base::ProcessId>& pids) {
+  std::map<base::ProcessId, RuntimeResourceMonitor::ProcessMemory> memory;
+  for (size_t i = 0; i < pids.size(); ++i)
+    memory[pids[i]] = RuntimeResourceMonitor::ReadProcessMemory(pids[i]);
+  return memory;
+}
+
+void WriteSamplesOnFileThread(const base::FilePath& path,
+                              const std::string& json) {
+  // Written aside and renamed, so that the readers never see half of it.
+  if (!base::ImportantFileWriter::WriteFileAtomically(path, json))
+    LOG(WARNING) << "Failed to write the resource samples to "
+                 << path.value();
+}
+
+}  // namespace
+
+RuntimeResourceMonitor::Config::Config() {
+}
+
+// static
+RuntimeResourceMonitor::Config RuntimeResourceMonitor::Config::FromCommandLine(
+    const CommandLine& command_line) {
+  Config config;
+  config.output_path =
+      command_line.GetSwitchValuePath(switches::kResourceMonitorFile);
+  int interval = 0;
+  if (command_line.HasSwitch(switches::kResourceMonitorInterval) &&
+      (!base::StringToInt(command_line.GetSwitchValueASCII(
+                              switches::kResourceMonitorInterval),
+                          &interval) ||
+       interval <= 0)) {
+    LOG(WARNING) << "Invalid --" << switches::kResourceMonitorInterval
+                 << ", using the default interval.";
+    interval = 0;
+  }
+  // The file is only useful if it is kept up to date.
+  if (!interval && !config.output_path.empty())
+    interval = kDefaultIntervalSeconds;
+  config.interval = base::TimeDelta::FromSeconds(interval);
+  return config;
+}
+
+RuntimeResourceMonitor::ProcessMemory::ProcessMemory()
+    : private_bytes(0),
+      shared_bytes(0),
+      swap_bytes(0) {
+}
+
+RuntimeResourceMonitor::Sample::Sample()
+    : hibernated(false),
+      render_process_id(-1),
+      pid(base::kNullProcessId),
+      cpu_usage(0),
+      network_bytes_read(0) {
+}
+
+RuntimeResourceMonitor::Entry::Entry()
+    : view(-1, -1),
+      view_bytes_read(0),
+      previous_views_bytes_read(0),
+      sampled(false) {
+}
+
+RuntimeResourceMonitor::RuntimeResourceMonitor(
+    RuntimeContext* runtime_context,
+    const Config& config)
+    : runtime_context_(runtime_context),
+      config_(config),
+      sampling_(false),
+      weak_factory_(this) {
+  DCHECK(g_runtime_resource_monitor == NULL);
+  g_runtime_resource_monitor = this;
+  const RuntimeList& runtimes = RuntimeRegistry::Get()->runtimes();
+  for (size_t i = 0; i < runtimes.size(); ++i)
+    OnRuntimeAdded(runtimes[i]);
+  RuntimeRegistry::Get()->AddObserver(this);
+}
+
+RuntimeResourceMonitor::~RuntimeResourceMonitor() {
+  RuntimeRegistry::Get()->RemoveObserver(this);
+  DCHECK(g_runtime_resource_monitor);
+  g_runtime_resource_monitor = NULL;
+}
+
+// static
+RuntimeResourceMonitor* RuntimeResourceMonitor::Get() {
+  return g_runtime_resource_monitor;
+}
+
+// static
+RuntimeResourceMonitor::ProcessMemory
+RuntimeResourceMonitor::ReadProcessMemory(base::ProcessId pid) {
+  ProcessMemory memory;
+#if defined(OS_LINUX)
+  std::string smaps;
+  if (!file_util::ReadFileToString(
+          base::FilePath(base::StringPrintf("/proc/%d/smaps", pid)), &smaps))
+    return memory;
+  std::vector<std::string> lines;
+  base::SplitString(smaps, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    // The fields of every mapping, e.g. "Private_Dirty:       12 kB".
+    std::vector<std::string> tokens;
+    base::SplitStringAlongWhitespace(lines[i], &tokens);
+    int64 kbytes = 0;
+    if (tokens.size() != 3 || tokens[2] != "kB" ||
+        !base::StringToInt64(tokens[1], &kbytes))
+      continue;
+    const std::string& name = tokens[0];
+    if (name == "Private_Clean:" || name == "Private_Dirty:")
+      memory.private_bytes += kbytes * 1024;
+    else if (name == "Shared_Clean:" || name == "Shared_Dirty:")
+      memory.shared_bytes += kbytes * 1024;
+    else if (name == "Swap:")
+      memory.swap_bytes += kbytes * 1024;
+  }
+#endif
+  return memory;
+}
+
+void RuntimeResourceMonitor::Start() {
+  if (config_.interval <= base::TimeDelta())
+    return;
+  timer_.Start(FROM_HERE, config_.interval, this,
+               &RuntimeResourceMonitor::TakeSample);
+}
+
+void RuntimeResourceMonitor::SampleNow(const base::Closure& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (!callback.is_null())
+    callbacks_.push_back(callback);
+  // The callback is run along with the sample being taken.
+  if (sampling_)
+    return;
+  sampling_ = true;
+  runtime_context_->GetBytesReadByView(
+      base::Bind(&RuntimeResourceMonitor::OnBytesRead,
+                 weak_factory_.GetWeakPtr()));
+}
+
+bool RuntimeResourceMonitor::GetSample(Runtime* runtime,
+                                       Sample* sample) const {
+  std::map<Runtime*, Entry>::const_iterator it = entries_.find(runtime);
+  if (it == entries_.end() || !it->second.sampled)
+    return false;
+  *sample = it->second.sample;
+  return true;
+}
+
+scoped_ptr<base::ListValue> RuntimeResourceMonitor::GetSamplesAsValue() const {
+  scoped_ptr<base::ListValue> list(new base::ListValue);
+  // In the order the Runtimes were added.
+  const RuntimeList& runtimes = RuntimeRegistry::Get()->runtimes();
+  for (size_t i = 0; i < runtimes.size(); ++i) {
+    Sample sample;
+    if (!GetSample(runtimes[i], &sample))
+      continue;
+    base::DictionaryValue* value = new base::DictionaryValue;
+    value->SetDouble("time", sample.time.ToDoubleT());
+    value->SetString("url", sample.url.spec());
+    value->SetBoolean("hibernated", sample.hibernated);
+    value->SetInteger("render_process_id", sample.render_process_id);
+    value->SetInteger("pid", sample.pid);
+    value->SetDouble("cpu_usage", sample.cpu_usage);
+    value->SetDouble("private_bytes", sample.memory.private_bytes);
+    value->SetDouble("shared_bytes", sample.memory.shared_bytes);
+    value->SetDouble("swap_bytes", sample.memory.swap_bytes);
+    value->SetDouble("network_bytes_read", sample.network_bytes_read);
+    list->Append(value);
+  }
+  return list.Pass();
+}
+
+void RuntimeResourceMonitor::OnRuntimeAdded(Runtime* runtime) {
+  entries_[runtime] = Entry();
+}
+
+void RuntimeResourceMonitor::OnRuntimeRemoved(Runtime* runtime) {
+  entries_.erase(runtime);
+  pending_samples_.erase(runtime);
+}
+
+void RuntimeResourceMonitor::OnRuntimeHibernated(Runtime* runtime) {
+  std::map<Runtime*, Entry>::iterator it = entries_.find(runtime);
+  if (it == entries_.end() || !it->second.sampled)
+    return;
+  // Its renderer is gone, along with what it used.
+  Sample& sample = it->second.sample;
+  sample.hibernated = true;
+  sample.render_process_id = -1;
+  sample.pid = base::kNullProcessId;
+  sample.cpu_usage = 0;
+  sample.memory = ProcessMemory();
+}
+
+void RuntimeResourceMonitor::OnRuntimeResumed(Runtime* runtime) {
+  // The new renderer is in the next sample.
+  std::map<Runtime*, Entry>::iterator it = entries_.find(runtime);
+  if (it != entries_.end())
+    it->second.sample.hibernated = false;
+}
+
+void RuntimeResourceMonitor::TakeSample() {
+  SampleNow(base::Closure());
+}
+
+void RuntimeResourceMonitor::OnBytesRead(
+    const NetworkTimingRecorder::ByteCountMap& bytes) {
+  base::Time now = base::Time::Now();
+  // The processes sampled this time, the others exited or aren't used by any
+  // Runtime anymore.
+  ProcessMetricsMap metrics;
+  std::map<base::ProcessHandle, double> cpu_usages;
+  std::vector<base::ProcessId> pids;
+  for (std::map<Runtime*, Entry>::iterator it = entries_.begin();
+       it != entries_.end(); ++it) {
+    Runtime* runtime = it->first;
+    Entry& entry = it->second;
+    Sample sample;
+    sample.time = now;
+    sample.url = runtime->web_contents()->GetURL();
+    sample.hibernated = runtime->is_hibernated();
+
+    content::RenderViewHost* render_view_host =
+        runtime->web_contents()->GetRenderViewHost();
+    content::RenderProcessHost* render_process_host =
+        render_view_host ? render_view_host->GetProcess() : NULL;
+    NetworkTimingRecorder::OwnerId view(-1, -1);
+    if (render_view_host) {
+      view = NetworkTimingRecorder::OwnerId(render_process_host->GetID(),
+                                            render_view_host->GetRoutingID());
+    }
+    // What the views the Runtime left read stays counted.
+    if (view != entry.view) {
+      entry.previous_views_bytes_read += entry.view_bytes_read;
+      entry.view = view;
+      entry.view_bytes_read = 0;
+    }
+    // The browser's own requests aren't anybody's.
+    NetworkTimingRecorder::ByteCountMap::const_iterator view_bytes =
+        bytes.find(view);
+    if (view.first != -1 && view_bytes != bytes.end())
+      entry.view_bytes_read = view_bytes->second;
+    sample.network_bytes_read =
+        entry.previous_views_bytes_read + entry.view_bytes_read;
+
+    // Not started yet, or not anymore for a hibernated Runtime.
+    base::ProcessHandle handle = render_process_host ?
+        render_process_host->GetHandle() : base::kNullProcessHandle;
+    if (handle != base::kNullProcessHandle) {
+      // The Runtimes of a process share its usage.
+      if (!cpu_usages.count(handle)) {
+        linked_ptr<base::ProcessMetrics>& process_metrics =
+            process_metrics_[handle];
+        if (!process_metrics.get()) {
+          process_metrics.reset(
+              base::ProcessMetrics::CreateProcessMetrics(handle));
+        }
+        // Zero the first time, which only starts the measure.
+        cpu_usages[handle] = process_metrics->GetCPUUsage();
+        metrics[handle] = process_metrics;
+        pids.push_back(base::GetProcId(handle));
+      }
+      sample.render_process_id = render_process_host->GetID();
+      sample.pid = base::GetProcId(handle);
+      sample.cpu_usage = cpu_usages[handle];
+    }
+    pending_samples_[runtime] = sample;
+  }
+  process_metrics_.swap(metrics);
+
+  base::PostTaskAndReplyWithResult(
+      BrowserThread::GetMessageLoopProxyForThread(BrowserThread::FILE),
+      FROM_HERE,
+      base::Bind(&ReadProcessesMemory, pids),
+      base::Bind(&RuntimeResourceMonitor::OnMemoryRead,
+                 weak_factory_.GetWeakPtr()));
+}
+
+void RuntimeResourceMonitor::OnMemoryRead(const ProcessMemoryMap& memory) {
+  for (std::map<Runtime*, Sample>::iterator it = pending_samples_.begin();
+       it != pending_samples_.end(); ++it) {
+    std::map<Runtime*, Entry>::iterator entry = entries_.find(it->first);
+    if (entry == entries_.end())
+      continue;
+    Sample& sample = it->second;
+    ProcessMemoryMap::const_iterator process_memory =
+        memory.find(sample.pid);
+    if (process_memory != memory.end())
+      sample.memory = process_memory->second;
+    entry->second.sample = sample;
+    entry->second.sampled = true;
+  }
+  pending_samples_.clear();
+  sampling_ = false;
+
+  if (!config_.output_path.empty())
+    WriteSamples();
+
+  std::vector<base::Closure> callbacks;
+  callbacks.swap(callbacks_);
+  for (size_t i = 0; i < callbacks.size(); ++i)
+    callbacks[i].Run();
+}
+
+void RuntimeResourceMonitor::WriteSamples() const {
+  scoped_ptr<base::ListValue> samples = GetSamplesAsValue();
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      samples.get(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&WriteSamplesOnFileThread, config_.output_path, json));
+}
+
+}  // namespace cameo
@@ -0,0 +1,164 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_RESOURCE_MONITOR_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_RESOURCE_MONITOR_H_
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/process.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
+#include "cameo/src/runtime/browser/runtime_registry.h"
+#include "googleurl/src/gurl.h"
+
+class CommandLine;
+
+namespace base {
+class ListValue;
+class ProcessMetrics;
+}
+
+namespace cameo {
+
+class Runtime;
+class RuntimeContext;
+
+// RuntimeResourceMonitor samples what every Runtime uses of the machine: the
+// CPU and memory of its render process, and what its requests read, as
+// attributed by RuntimeNetworkDelegate. The Runtimes sharing a render process
+// report the same process figures.
+//
+// The samples are taken every Config::interval, or on demand with
+// SampleNow(), and can be written to a JSON file after each sample for
+// agents collecting them from outside.
+class RuntimeResourceMonitor : public RuntimeRegistryObserver {
+ public:
+  struct Config {
+    Config();
+
+    // Reads switches::kResourceMonitorInterval and kResourceMonitorFile.
+    static Config FromCommandLine(const CommandLine& command_line);
+
+    // Zero for no periodic sampling.
+    base::TimeDelta interval;
+    // Where the samples are written as JSON, if not empty.
+    base::FilePath output_path;
+  };
+
+  // The memory of a process, in bytes, from /proc/<pid>/smaps on Linux.
+  struct ProcessMemory {
+    ProcessMemory();
+
+    int64 private_bytes;
+    int64 shared_bytes;
+    int64 swap_bytes;
+  };
+
+  struct Sample {
+    Sample();
+
+    base::Time time;
+    GURL url;
+    bool hibernated;
+    // -1 and base::kNullProcessId while the Runtime has no render process,
+    // e.g. when hibernated, in which case the process figures are zero.
+    int render_process_id;
+    base::ProcessId pid;
+    // The CPU usage of the render process since the previous sample, in
+    // percent of one core.
+    double cpu_usage;
+    ProcessMemory memory;
+    // What the requests of the Runtime read since it was added, across the
+    // render views it went through.
+    int64 network_bytes_read;
+  };
+
+  // Listens to the registry, which must outlive the monitor.
+  RuntimeResourceMonitor(RuntimeContext* runtime_context,
+                         const Config& config);
+  virtual ~RuntimeResourceMonitor();
+
+  // The monitor of the application, NULL if there is none.
+  static RuntimeResourceMonitor* Get();
+
+  // Reads the memory of the process |pid|. Does blocking IO.
+  static ProcessMemory ReadProcessMemory(base::ProcessId pid);
+
+  // Starts sampling every Config::interval, if not zero.
+  void Start();
+
+  // Takes a sample of every Runtime, and runs |callback| on the UI thread
+  // once they are all available.
+  void SampleNow(const base::Closure& callback);
+
+  // Sets |sample| to the last sample of |runtime|. Returns false if it
+  // hasn't been sampled yet.
+  bool GetSample(Runtime* runtime, Sample* sample) const;
+
+  // Returns the last samples of all the Runtimes, as a list of dictionaries
+  // with "time", "url", "hibernated", "render_process_id", "pid",
+  // "cpu_usage", "private_bytes", "shared_bytes", "swap_bytes" and
+  // "network_bytes_read".
+  scoped_ptr<base::ListValue> GetSamplesAsValue() const;
+
+  // RuntimeRegistryObserver implementation.
+  virtual void OnRuntimeAdded(Runtime* runtime) OVERRIDE;
+  virtual void OnRuntimeRemoved(Runtime* runtime) OVERRIDE;
+  virtual void OnRuntimeHibernated(Runtime* runtime) OVERRIDE;
+  virtual void OnRuntimeResumed(Runtime* runtime) OVERRIDE;
+
+ private:
+  typedef std::map<base::ProcessId, ProcessMemory> ProcessMemoryMap;
+  typedef std::map<base::ProcessHandle, linked_ptr<base::ProcessMetrics> >
+      ProcessMetricsMap;
+
+  struct Entry {
+    Entry();
+
+    // The render view the network bytes are counted for, and what it read.
+    NetworkTimingRecorder::OwnerId view;
+    int64 view_bytes_read;
+    // What the views the Runtime left before read.
+    int64 previous_views_bytes_read;
+    bool sampled;
+    Sample sample;
+  };
+
+  void TakeSample();
+  void OnBytesRead(const NetworkTimingRecorder::ByteCountMap& bytes);
+  void OnMemoryRead(const ProcessMemoryMap& memory);
+  void WriteSamples() const;
+
+  RuntimeContext* runtime_context_;
+  Config config_;
+  base::RepeatingTimer<RuntimeResourceMonitor> timer_;
+
+  std::map<Runtime*, Entry> entries_;
+  // The metrics of the render processes in use, which remember when their
+  // CPU usage was sampled last.
+  ProcessMetricsMap process_metrics_;
+
+  // Whether a sample is being taken, the callbacks to run once it is done,
+  // and the samples waiting for the memory of their process.
+  bool sampling_;
+  std::vector<base::Closure> callbacks_;
+  std::map<Runtime*, Sample> pending_samples_;
+
+  base::WeakPtrFactory<RuntimeResourceMonitor> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeResourceMonitor);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_RUNTIME_RESOURCE_MONITOR_H_
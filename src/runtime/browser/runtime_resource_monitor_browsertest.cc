@@ -0,0 +1,109 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/run_loop.h"
+#include "base/time.h"
+#include "base/utf_string_conversions.h"
+#include "base/values.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_registry.h"
+#include "cameo/src/runtime/browser/runtime_resource_monitor.h"
+#include "cameo/src/runtime/browser/ui/native_app_window.h"
+#include "cameo/src/test/base/cameo_headless_runtime_test.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+
+using cameo::Runtime;
+using cameo::RuntimeRegistry;
+using cameo::RuntimeResourceMonitor;
+
+namespace {
+
+const int kRuntimeCount = 10;
+
+// memory.html holds on to 16 MB.
+const int64 kPageMemory = 16 * 1024 * 1024;
+
+}  // namespace
+
+class RuntimeResourceMonitorTest : public CameoHeadlessRuntimeTest {
+ public:
+  Runtime* CreateLoadedRuntime() {
+    GURL url = cameo_test_utils::GetTestURL(
+        base::FilePath(), base::FilePath().AppendASCII("memory.html"));
+    Runtime* runtime = Runtime::Create(runtime()->runtime_context(), url);
+    string16 loaded = ASCIIToUTF16("loaded");
+    content::TitleWatcher title_watcher(runtime->web_contents(), loaded);
+    EXPECT_EQ(loaded, title_watcher.WaitAndGetTitle());
+    return runtime;
+  }
+
+  void SampleNow() {
+    base::RunLoop run_loop;
+    RuntimeResourceMonitor::Get()->SampleNow(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(RuntimeResourceMonitorTest, SamplesRuntimes) {
+  RuntimeResourceMonitor* monitor = RuntimeResourceMonitor::Get();
+  ASSERT_TRUE(monitor);
+  Runtime* runtime = CreateLoadedRuntime();
+  RuntimeResourceMonitor::Sample sample;
+  EXPECT_FALSE(monitor->GetSample(runtime, &sample));
+
+  SampleNow();
+  ASSERT_TRUE(monitor->GetSample(runtime, &sample));
+  EXPECT_EQ(runtime->web_contents()->GetURL(), sample.url);
+  EXPECT_FALSE(sample.hibernated);
+  EXPECT_NE(-1, sample.render_process_id);
+  EXPECT_NE(base::kNullProcessId, sample.pid);
+  EXPECT_GE(sample.cpu_usage, 0);
+#if defined(OS_LINUX)
+  EXPECT_GT(sample.memory.private_bytes, kPageMemory);
+  EXPECT_GT(sample.memory.shared_bytes, 0);
+#endif
+  EXPECT_GT(sample.network_bytes_read, 0);
+  int64 bytes_read = sample.network_bytes_read;
+
+  scoped_ptr<base::ListValue> samples = monitor->GetSamplesAsValue();
+  EXPECT_EQ(RuntimeRegistry::Get()->runtimes().size(), samples->GetSize());
+
+  // What the hibernated Runtime read stays counted, its renderer is gone.
+  runtime->window()->Minimize();
+  runtime->Hibernate();
+  ASSERT_TRUE(monitor->GetSample(runtime, &sample));
+  EXPECT_TRUE(sample.hibernated);
+  EXPECT_EQ(-1, sample.render_process_id);
+  SampleNow();
+  ASSERT_TRUE(monitor->GetSample(runtime, &sample));
+  EXPECT_TRUE(sample.hibernated);
+  EXPECT_EQ(0, sample.memory.private_bytes);
+  EXPECT_EQ(bytes_read, sample.network_bytes_read);
+
+  runtime->Close();
+  EXPECT_FALSE(monitor->GetSample(runtime, &sample));
+}
+
+IN_PROC_BROWSER_TEST_F(RuntimeResourceMonitorTest, SampleBenchmark) {
+  std::vector<Runtime*> runtimes;
+  for (int i = 0; i < kRuntimeCount; ++i)
+    runtimes.push_back(CreateLoadedRuntime());
+
+  // The first sample creates the metrics of the processes.
+  SampleNow();
+  base::TimeTicks start = base::TimeTicks::Now();
+  SampleNow();
+  base::TimeDelta sample_time = base::TimeTicks::Now() - start;
+
+  for (size_t i = 0; i < runtimes.size(); ++i)
+    runtimes[i]->Close();
+  cameo_test_utils::PrintPerfResult("resource_monitor", "sample_time",
+                                    sample_time.InMillisecondsF(), "ms");
+}
@@ -4,21 +4,41 @@
 
 #include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
 
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/strings/string_split.h"
 #include "base/threading/worker_pool.h"
+#include "cameo/src/runtime/browser/load_predictor.h"
+#include "cameo/src/runtime/browser/network_emulator.h"
+#include "cameo/src/runtime/browser/network_recorder.h"
+#include "cameo/src/runtime/browser/network_state_store.h"
+#include "cameo/src/runtime/browser/persistent_server_bound_cert_store.h"
 #include "cameo/src/runtime/browser/runtime_network_delegate.h"
+#include "cameo/src/runtime/browser/sdch_dictionary_fetcher.h"
+#include "cameo/src/runtime/browser/tiered_http_cache.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
 #include "content/public/browser/browser_thread.h"
+#include "content/public/browser/cookie_store_factory.h"
 #include "content/public/common/content_switches.h"
 #include "content/public/common/url_constants.h"
+#include "net/base/host_mapping_rules.h"
+#include "net/base/net_errors.h"
+#include "net/base/prioritized_dispatcher.h"
+#include "net/base/request_priority.h"
+#include "net/base/sdch_manager.h"
 #include "net/cert/cert_verifier.h"
 #include "net/cookies/cookie_monster.h"
+#include "net/dns/host_cache.h"
 #include "net/dns/host_resolver.h"
+#include "net/dns/host_resolver_impl.h"
 #include "net/dns/mapped_host_resolver.h"
 #include "net/http/http_auth_handler_factory.h"
 #include "net/http/http_cache.h"
+#include "net/http/http_network_layer.h"
 #include "net/http/http_network_session.h"
 #include "net/http/http_server_properties_impl.h"
 #include "net/proxy/proxy_service.h"
@@ -37,6 +57,9 @@ namespace cameo {
 
 namespace {
 
+// Same as the resolver of net::HostResolver::CreateDefaultResolver().
+const size_t kMaxResolverThreads = 6;
+
 void InstallProtocolHandlers(net::URLRequestJobFactoryImpl* job_factory,
                              content::ProtocolHandlerMap* protocol_handlers) {
   for (content::ProtocolHandlerMap::iterator it =
@@ -50,23 +73,79 @@ void InstallProtocolHandlers(net::URLRequestJobFactoryImpl* job_factory,
   protocol_handlers->clear();
 }
 
+// Returns the host resolver of the default partition, see
+// switches::kAsyncDns and switches::kHostCacheSize, with the rules of
+// switches::kHostResolverRules on top.
+scoped_ptr<net::HostResolver> CreateHostResolver(
+    const CommandLine& command_line) {
+  scoped_ptr<net::HostResolver> host_resolver;
+  size_t cache_size = 0;
+  bool has_cache_size = false;
+  if (command_line.HasSwitch(switches::kHostCacheSize)) {
+    has_cache_size = base::StringToSizeT(
+        command_line.GetSwitchValueASCII(switches::kHostCacheSize),
+        &cache_size);
+    if (!has_cache_size) {
+      LOG(WARNING) << "Invalid --" << switches::kHostCacheSize
+                   << ", using the default.";
+    }
+  }
+  if (has_cache_size) {
+    host_resolver.reset(new net::HostResolverImpl(
+        scoped_ptr<net::HostCache>(
+            cache_size ? new net::HostCache(cache_size) : NULL),
+        net::PrioritizedDispatcher::Limits(net::NUM_PRIORITIES,
+                                           kMaxResolverThreads),
+        net::HostResolverImpl::ProcTaskParams(
+            NULL, net::HostResolver::kDefaultRetryAttempts),
+        NULL));
+  } else {
+    host_resolver = net::HostResolver::CreateDefaultResolver(NULL);
+  }
+
+  // The built-in client reads the system DNS configuration and sends the
+  // queries itself from the IO thread, instead of blocking a worker thread
+  // in getaddrinfo() for each of them. It falls back to getaddrinfo() when
+  // the configuration is one it doesn't support.
+  if (command_line.HasSwitch(switches::kAsyncDns))
+    host_resolver->SetDnsClientEnabled(true);
+
+  if (!command_line.HasSwitch(switches::kHostResolverRules))
+    return host_resolver.Pass();
+  scoped_ptr<net::MappedHostResolver> mapped_host_resolver(
+      new net::MappedHostResolver(host_resolver.Pass()));
+  mapped_host_resolver->SetRulesFromString(
+      command_line.GetSwitchValueASCII(switches::kHostResolverRules));
+  return mapped_host_resolver.PassAs<net::HostResolver>();
+}
+
 }  // namespace
 
 RuntimeURLRequestContextGetter::RuntimeURLRequestContextGetter(
     bool ignore_certificate_errors,
     const base::FilePath& base_path,
+    bool in_memory,
+    RuntimeURLRequestContextGetter* default_getter,
     MessageLoop* io_loop,
     MessageLoop* file_loop,
     content::ProtocolHandlerMap* protocol_handlers)
     : ignore_certificate_errors_(ignore_certificate_errors),
       base_path_(base_path),
+      in_memory_(in_memory),
+      default_getter_(default_getter),
       io_loop_(io_loop),
-      file_loop_(file_loop) {
+      file_loop_(file_loop),
+      http_cache_(NULL),
+      warm_up_cache_backend_(NULL) {
   // Must first be created on the UI thread.
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
 
   std::swap(protocol_handlers_, *protocol_handlers);
 
+  // The other partitions use the proxy service of the default one.
+  if (default_getter_)
+    return;
+
   // We must create the proxy config service on the UI loop on Linux because it
   // must synchronously run on the glib message loop. This will be passed to
   // the URLRequestContextStorage on the IO thread in GetURLRequestContext().
@@ -76,83 +155,199 @@ RuntimeURLRequestContextGetter::RuntimeURLRequestContextGetter(
 }
 
 RuntimeURLRequestContextGetter::~RuntimeURLRequestContextGetter() {
+  if (load_predictor_)
+    network_delegate_->set_load_predictor(NULL);
 }
 
 net::URLRequestContext* RuntimeURLRequestContextGetter::GetURLRequestContext() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
 
   if (!url_request_context_) {
-    url_request_context_.reset(new net::URLRequestContext());
-    network_delegate_.reset(new RuntimeNetworkDelegate);
-    url_request_context_->set_network_delegate(network_delegate_.get());
-    storage_.reset(
-        new net::URLRequestContextStorage(url_request_context_.get()));
-    storage_->set_cookie_store(new net::CookieMonster(NULL, NULL));
-    storage_->set_server_bound_cert_service(new net::ServerBoundCertService(
-        new net::DefaultServerBoundCertStore(NULL),
-        base::WorkerPool::GetTaskRunner(true)));
-    storage_->set_http_user_agent_settings(
-        new net::StaticHttpUserAgentSettings("en-us,en", EmptyString()));
-
-    scoped_ptr<net::HostResolver> host_resolver(
-        net::HostResolver::CreateDefaultResolver(NULL));
-
-    storage_->set_cert_verifier(net::CertVerifier::CreateDefault());
-    storage_->set_proxy_service(
-        net::ProxyService::CreateUsingSystemProxyResolver(
-        proxy_config_service_.release(),
-        0,
-        NULL));
-    storage_->set_ssl_config_service(new net::SSLConfigServiceDefaults);
-    storage_->set_http_auth_handler_factory(
-        net::HttpAuthHandlerFactory::CreateDefault(host_resolver.get()));
-    storage_->set_http_server_properties(new net::HttpServerPropertiesImpl);
-
-    base::FilePath cache_path = base_path_.Append(FILE_PATH_LITERAL("Cache"));
-    net::HttpCache::DefaultBackend* main_backend =
-        new net::HttpCache::DefaultBackend(
-            net::DISK_CACHE,
-            cache_path,
-            0,
-            BrowserThread::GetMessageLoopProxyForThread(
-                BrowserThread::CACHE));
-
-    net::HttpNetworkSession::Params network_session_params;
-    network_session_params.cert_verifier =
-        url_request_context_->cert_verifier();
-    network_session_params.server_bound_cert_service =
-        url_request_context_->server_bound_cert_service();
-    network_session_params.proxy_service =
-        url_request_context_->proxy_service();
-    network_session_params.ssl_config_service =
-        url_request_context_->ssl_config_service();
-    network_session_params.http_auth_handler_factory =
-        url_request_context_->http_auth_handler_factory();
-    network_session_params.network_delegate =
-        network_delegate_.get();
-    network_session_params.http_server_properties =
-        url_request_context_->http_server_properties();
-    network_session_params.ignore_certificate_errors =
-        ignore_certificate_errors_;
-
-    // Give |storage_| ownership at the end in case it's |mapped_host_resolver|.
-    storage_->set_host_resolver(host_resolver.Pass());
-    network_session_params.host_resolver =
-        url_request_context_->host_resolver();
-
-    net::HttpCache* main_cache = new net::HttpCache(
-        network_session_params, main_backend);
-    storage_->set_http_transaction_factory(main_cache);
-
-    scoped_ptr<net::URLRequestJobFactoryImpl> job_factory(
-        new net::URLRequestJobFactoryImpl());
-    InstallProtocolHandlers(job_factory.get(), &protocol_handlers_);
-    storage_->set_job_factory(job_factory.release());
+    TRACE_EVENT0("cameo.startup",
+                 "RuntimeURLRequestContextGetter::GetURLRequestContext");
+    if (default_getter_)
+      InitPartitionContext();
+    else
+      InitDefaultContext();
   }
 
   return url_request_context_.get();
 }
 
+void RuntimeURLRequestContextGetter::InitDefaultContext() {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(switches::kRecordNetwork)) {
+    network_recorder_.reset(new NetworkRecorder(
+        command_line.GetSwitchValuePath(switches::kRecordNetwork)));
+  }
+
+  url_request_context_.reset(new net::URLRequestContext());
+  network_delegate_.reset(new RuntimeNetworkDelegate);
+  url_request_context_->set_network_delegate(network_delegate_.get());
+  storage_.reset(
+      new net::URLRequestContextStorage(url_request_context_.get()));
+  storage_->set_cookie_store(CreateCookieStore());
+  // Channel IDs are kept across launches, so servers don't see new ones and
+  // they aren't generated again.
+  storage_->set_server_bound_cert_service(new net::ServerBoundCertService(
+      new net::DefaultServerBoundCertStore(in_memory_ ? NULL :
+          new PersistentServerBoundCertStore(
+              base_path_.Append(FILE_PATH_LITERAL("Origin Bound Certs")))),
+      base::WorkerPool::GetTaskRunner(true)));
+  storage_->set_http_user_agent_settings(
+      new net::StaticHttpUserAgentSettings("en-us,en", EmptyString()));
+
+  scoped_ptr<net::HostResolver> host_resolver(
+      CreateHostResolver(command_line));
+
+  storage_->set_cert_verifier(net::CertVerifier::CreateDefault());
+  storage_->set_proxy_service(
+      net::ProxyService::CreateUsingSystemProxyResolver(
+      proxy_config_service_.release(),
+      0,
+      NULL));
+  storage_->set_ssl_config_service(new net::SSLConfigServiceDefaults);
+  storage_->set_http_auth_handler_factory(
+      net::HttpAuthHandlerFactory::CreateDefault(host_resolver.get()));
+  net::HttpServerPropertiesImpl* http_server_properties =
+      new net::HttpServerPropertiesImpl;
+  storage_->set_http_server_properties(http_server_properties);
+
+  // So that the first requests of the next launch don't wait for DNS or
+  // for the protocol to be negotiated again.
+  if (!in_memory_) {
+    network_state_store_.reset(new NetworkStateStore(
+        base_path_.Append(FILE_PATH_LITERAL("Network State")),
+        http_server_properties, host_resolver->GetHostCache()));
+  }
+
+  net::HttpNetworkSession::Params network_session_params;
+  network_session_params.cert_verifier =
+      url_request_context_->cert_verifier();
+  network_session_params.server_bound_cert_service =
+      url_request_context_->server_bound_cert_service();
+  network_session_params.proxy_service =
+      url_request_context_->proxy_service();
+  network_session_params.ssl_config_service =
+      url_request_context_->ssl_config_service();
+  network_session_params.http_auth_handler_factory =
+      url_request_context_->http_auth_handler_factory();
+  network_session_params.network_delegate =
+      network_delegate_.get();
+  network_session_params.http_server_properties =
+      url_request_context_->http_server_properties();
+  network_session_params.ignore_certificate_errors =
+      ignore_certificate_errors_;
+  // Unlike kHostResolverRules, these can map the port too. They only change
+  // where the connections go, not the Host header.
+  if (command_line.HasSwitch(switches::kHostRules)) {
+    host_mapping_rules_.reset(new net::HostMappingRules);
+    host_mapping_rules_->SetRulesFromString(
+        command_line.GetSwitchValueASCII(switches::kHostRules));
+    network_session_params.host_mapping_rules = host_mapping_rules_.get();
+  }
+
+  // Give |storage_| ownership at the end in case it's |mapped_host_resolver|.
+  storage_->set_host_resolver(host_resolver.Pass());
+  network_session_params.host_resolver =
+      url_request_context_->host_resolver();
+
+  http_cache_ = CreateHttpCache(
+      new net::HttpNetworkSession(network_session_params));
+  storage_->set_http_transaction_factory(
+      network_delegate_->network_emulator()->WrapTransactionFactory(
+          http_cache_));
+
+  scoped_ptr<net::URLRequestJobFactoryImpl> job_factory(
+      new net::URLRequestJobFactoryImpl());
+  InstallProtocolHandlers(job_factory.get(), &protocol_handlers_);
+  storage_->set_job_factory(job_factory.release());
+
+  // Shared-dictionary compression, for the requests of all the partitions.
+  // URLRequestHttpJob advertises the dictionaries the manager holds and
+  // decodes the responses encoded with them.
+  if (!net::SdchManager::Global()) {
+    sdch_manager_.reset(new net::SdchManager);
+    sdch_manager_->set_sdch_fetcher(new SdchDictionaryFetcher(
+        in_memory_ ? base::FilePath() :
+            base_path_.Append(FILE_PATH_LITERAL("SDCH Dictionaries")),
+        url_request_context_.get()));
+  }
+
+  if (!in_memory_) {
+    load_predictor_.reset(new LoadPredictor(
+        base_path_.Append(FILE_PATH_LITERAL("Load Predictor")),
+        url_request_context_.get()));
+    network_delegate_->set_load_predictor(load_predictor_.get());
+  }
+}
+
+void RuntimeURLRequestContextGetter::InitPartitionContext() {
+  net::URLRequestContext* default_context =
+      default_getter_->GetURLRequestContext();
+
+  // Start from everything the default partition has, then replace what the
+  // partition keeps to itself.
+  url_request_context_.reset(new net::URLRequestContext());
+  url_request_context_->CopyFrom(default_context);
+  storage_.reset(
+      new net::URLRequestContextStorage(url_request_context_.get()));
+  storage_->set_cookie_store(CreateCookieStore());
+
+  // One network session, and so one set of socket pools and one SSL session
+  // cache, below the caches of all partitions.
+  http_cache_ = CreateHttpCache(
+      default_context->http_transaction_factory()->GetSession());
+  storage_->set_http_transaction_factory(
+      network_emulator()->WrapTransactionFactory(http_cache_));
+
+  scoped_ptr<net::URLRequestJobFactoryImpl> job_factory(
+      new net::URLRequestJobFactoryImpl());
+  InstallProtocolHandlers(job_factory.get(), &protocol_handlers_);
+  storage_->set_job_factory(job_factory.release());
+}
+
+net::CookieStore* RuntimeURLRequestContextGetter::CreateCookieStore() const {
+  if (in_memory_)
+    return new net::CookieMonster(NULL, NULL);
+
+  // The SQLite backed store commits in batches from the blocking pool, and
+  // loads the cookies of the first requested domain ahead of the others,
+  // so neither writes nor the initial load block the IO thread.
+  return content::CreatePersistentCookieStore(
+      base_path_.Append(FILE_PATH_LITERAL("Cookies")), false, NULL, NULL);
+}
+
+TieredHttpCache* RuntimeURLRequestContextGetter::CreateHttpCache(
+    net::HttpNetworkSession* session) {
+  TieredHttpCache::Config config = TieredHttpCache::Config::FromCommandLine(
+      *CommandLine::ForCurrentProcess());
+  if (in_memory_)
+    config.mode = TieredHttpCache::MODE_MEMORY;
+  // Only the default partition, which the app is loaded in, starts from the
+  // snapshot of its resources.
+  if (!default_getter_) {
+    config.snapshot_path = CommandLine::ForCurrentProcess()->
+        GetSwitchValuePath(switches::kHttpCacheSnapshot);
+  }
+  return new TieredHttpCache(
+      config, base_path_.Append(FILE_PATH_LITERAL("Cache")),
+      CreateNetworkLayer(session), NULL);
+}
+
+net::HttpTransactionFactory*
+    RuntimeURLRequestContextGetter::CreateNetworkLayer(
+        net::HttpNetworkSession* session) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  net::HttpTransactionFactory* network_layer =
+      new net::HttpNetworkLayer(session);
+  NetworkRecorder* recorder = default_getter_ ?
+      default_getter_->network_recorder_.get() : network_recorder_.get();
+  if (recorder)
+    network_layer = recorder->WrapNetworkLayer(network_layer);
+  return network_layer;
+}
+
 scoped_refptr<base::SingleThreadTaskRunner>
     RuntimeURLRequestContextGetter::GetNetworkTaskRunner() const {
   return BrowserThread::GetMessageLoopProxyForThread(BrowserThread::IO);
@@ -162,4 +357,45 @@ net::HostResolver* RuntimeURLRequestContextGetter::host_resolver() {
   return url_request_context_->host_resolver();
 }
 
+NetworkEmulator* RuntimeURLRequestContextGetter::network_emulator() const {
+  if (default_getter_)
+    return default_getter_->network_emulator();
+  return network_delegate_->network_emulator();
+}
+
+void RuntimeURLRequestContextGetter::WarmUp() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&RuntimeURLRequestContextGetter::WarmUpOnIOThread, this));
+}
+
+void RuntimeURLRequestContextGetter::WarmUpOnIOThread() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  TRACE_EVENT0("cameo.startup", "RuntimeURLRequestContextGetter::WarmUp");
+  GetURLRequestContext();
+
+  // Opening the backend reads the cache index on the CACHE thread; the first
+  // request would otherwise have to wait for it. The memory tier, if any,
+  // opens instantly.
+  net::HttpCache* cache = http_cache_->disk_cache();
+  if (!cache)
+    return;
+  TRACE_EVENT_ASYNC_BEGIN0("cameo.startup", "OpenHttpCacheBackend", this);
+  int rv = cache->GetBackend(
+      &warm_up_cache_backend_,
+      base::Bind(&RuntimeURLRequestContextGetter::OnCacheBackendReady, this));
+  if (rv != net::ERR_IO_PENDING)
+    OnCacheBackendReady(rv);
+}
+
+void RuntimeURLRequestContextGetter::OnCacheBackendReady(int rv) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  TRACE_EVENT_ASYNC_END1("cameo.startup", "OpenHttpCacheBackend", this,
+                         "result", rv);
+  if (rv != net::OK)
+    LOG(WARNING) << "Failed to open the HTTP cache backend: " << rv;
+  warm_up_cache_backend_ = NULL;
+}
+
 }  // namespace cameo
@@ -17,21 +17,46 @@ namespace base {
 class MessageLoop;
 }
 
+namespace disk_cache {
+class Backend;
+}
+
 namespace net {
+class CookieStore;
+class HostMappingRules;
 class HostResolver;
+class HttpNetworkSession;
+class HttpTransactionFactory;
 class MappedHostResolver;
 class NetworkDelegate;
 class ProxyConfigService;
+class SdchManager;
 class URLRequestContextStorage;
 }
 
 namespace cameo {
 
+class LoadPredictor;
+class NetworkEmulator;
+class NetworkRecorder;
+class NetworkStateStore;
+class RuntimeNetworkDelegate;
+class TieredHttpCache;
+
+// The request context of a storage partition. The default partition builds
+// the whole network stack. The others, given the getter of the default one,
+// only have their own cookie store, HTTP cache and protocol handlers, on top
+// of the network delegate, host resolver, cert verifier, proxy service and
+// HttpNetworkSession, with its socket pools and SSL session cache, of the
+// default partition. Unless it is in memory, the default partition keeps the
+// server properties, host cache and channel IDs it learns across launches.
 class RuntimeURLRequestContextGetter : public net::URLRequestContextGetter {
  public:
   RuntimeURLRequestContextGetter(
       bool ignore_certificate_errors,
       const base::FilePath& base_path,
+      bool in_memory,
+      RuntimeURLRequestContextGetter* default_getter,
       base::MessageLoop* io_loop,
       base::MessageLoop* file_loop,
       content::ProtocolHandlerMap* protocol_handlers);
@@ -44,18 +69,75 @@ class RuntimeURLRequestContextGetter : public net::URLRequestContextGetter {
 
   net::HostResolver* host_resolver();
 
+  // Only valid on the IO thread once the context has been built. NULL for a
+  // partition other than the default one, which uses the default one's.
+  RuntimeNetworkDelegate* network_delegate() const {
+    return network_delegate_.get();
+  }
+
+  // Only valid on the IO thread once the context has been built.
+  TieredHttpCache* http_cache() const { return http_cache_; }
+
+  // The emulator of the default partition's network delegate, which all the
+  // partitions share. Only valid on the IO thread once the default context
+  // has been built.
+  NetworkEmulator* network_emulator() const;
+
+  // Builds the URLRequestContext and opens the HTTP cache backend on the IO
+  // thread right away, instead of when the first request needs them, so that
+  // it overlaps with the window and renderer creation. Called on the UI
+  // thread.
+  void WarmUp();
+
+  // Returns a new network layer on |session|, to go below an HTTP cache of
+  // the context. It records what it gets from the network when the default
+  // partition was started with --record-network. IO thread only.
+  net::HttpTransactionFactory* CreateNetworkLayer(
+      net::HttpNetworkSession* session);
+
  private:
+  void InitDefaultContext();
+  void InitPartitionContext();
+  net::CookieStore* CreateCookieStore() const;
+  TieredHttpCache* CreateHttpCache(net::HttpNetworkSession* session);
+
+  void WarmUpOnIOThread();
+  void OnCacheBackendReady(int rv);
+
   bool ignore_certificate_errors_;
   base::FilePath base_path_;
+  bool in_memory_;
+  // NULL for the default partition.
+  scoped_refptr<RuntimeURLRequestContextGetter> default_getter_;
   base::MessageLoop* io_loop_;
   base::MessageLoop* file_loop_;
 
   scoped_ptr<net::ProxyConfigService> proxy_config_service_;
-  scoped_ptr<net::NetworkDelegate> network_delegate_;
+  scoped_ptr<RuntimeNetworkDelegate> network_delegate_;
+  // Only on the default partition, shared with the others.
+  scoped_ptr<NetworkRecorder> network_recorder_;
+  // Only on the default partition, with switches::kHostRules. Must outlive
+  // the network session.
+  scoped_ptr<net::HostMappingRules> host_mapping_rules_;
   scoped_ptr<net::URLRequestContextStorage> storage_;
   scoped_ptr<net::URLRequestContext> url_request_context_;
+  // Only on the default partition. Destroyed first, as it writes the state
+  // owned by |storage_| one last time.
+  scoped_ptr<NetworkStateStore> network_state_store_;
+  // Only on the default partition. Its prefetches use
+  // |url_request_context_|.
+  scoped_ptr<LoadPredictor> load_predictor_;
+  // Only on the first default partition built, as there is one per process.
+  // Its dictionary fetches use |url_request_context_|.
+  scoped_ptr<net::SdchManager> sdch_manager_;
   content::ProtocolHandlerMap protocol_handlers_;
 
+  // Owned by |storage_|.
+  TieredHttpCache* http_cache_;
+
+  // Receives the cache backend opened by WarmUp().
+  disk_cache::Backend* warm_up_cache_backend_;
+
   DISALLOW_COPY_AND_ASSIGN(RuntimeURLRequestContextGetter);
 };
 
@@ -0,0 +1,233 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/sdch_dictionary_fetcher.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/pickle.h"
+#include "base/string_number_conversions.h"
+#include "base/string_util.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/io_buffer.h"
+#include "net/base/load_flags.h"
+#include "net/base/request_priority.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_status.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// Enough for an origin to move from one deployment to the next while the
+// pages of the previous one are still around.
+const size_t kMaxDictionariesPerOrigin = 3;
+
+const int kReadBufferSize = 32 * 1024;
+
+typedef std::vector<SdchDictionaryFetcher::Dictionary> DictionaryList;
+
+// Returns the name of the file keeping the dictionaries of the origin of
+// |url|, e.g. "http_app.example.com_80".
+std::string GetOriginFileName(const GURL& url) {
+  std::string name = url.scheme() + "_" + url.host() + "_" +
+                     base::IntToString(url.EffectiveIntPort());
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (!IsAsciiAlpha(name[i]) && !IsAsciiDigit(name[i]) && name[i] != '.' &&
+        name[i] != '-')
+      name[i] = '_';
+  }
+  return name;
+}
+
+// Appends the dictionaries kept in |path| to |dictionaries|.
+void ReadOriginFile(const base::FilePath& path, DictionaryList* dictionaries) {
+  std::string data;
+  if (!file_util::ReadFileToString(path, &data))
+    return;
+  Pickle pickle(data.data(), static_cast<int>(data.size()));
+  PickleIterator iter(pickle);
+  int count = 0;
+  if (!pickle.ReadInt(&iter, &count))
+    return;
+  for (int i = 0; i < count; ++i) {
+    std::string url;
+    SdchDictionaryFetcher::Dictionary dictionary;
+    if (!pickle.ReadString(&iter, &url) ||
+        !pickle.ReadString(&iter, &dictionary.text))
+      return;
+    dictionary.url = GURL(url);
+    dictionaries->push_back(dictionary);
+  }
+}
+
+void ReadDictionaries(const base::FilePath& dir,
+                      DictionaryList* dictionaries) {
+  file_util::FileEnumerator enumerator(dir, false,
+                                       file_util::FileEnumerator::FILES);
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next())
+    ReadOriginFile(path, dictionaries);
+}
+
+// Adds |dictionary| to the file of its origin, replacing the one from the
+// same URL, and dropping the oldest ones past kMaxDictionariesPerOrigin.
+void SaveDictionary(const base::FilePath& dir,
+                    const SdchDictionaryFetcher::Dictionary& dictionary) {
+  if (!file_util::CreateDirectory(dir)) {
+    LOG(WARNING) << "Failed to create " << dir.value();
+    return;
+  }
+  base::FilePath path = dir.AppendASCII(GetOriginFileName(dictionary.url));
+  DictionaryList dictionaries;
+  ReadOriginFile(path, &dictionaries);
+  for (DictionaryList::iterator it = dictionaries.begin();
+       it != dictionaries.end(); ++it) {
+    if (it->url == dictionary.url) {
+      dictionaries.erase(it);
+      break;
+    }
+  }
+  dictionaries.push_back(dictionary);
+  if (dictionaries.size() > kMaxDictionariesPerOrigin) {
+    dictionaries.erase(dictionaries.begin(),
+                       dictionaries.end() - kMaxDictionariesPerOrigin);
+  }
+
+  Pickle pickle;
+  pickle.WriteInt(static_cast<int>(dictionaries.size()));
+  for (size_t i = 0; i < dictionaries.size(); ++i) {
+    pickle.WriteString(dictionaries[i].url.spec());
+    pickle.WriteString(dictionaries[i].text);
+  }
+  int size = static_cast<int>(pickle.size());
+  if (file_util::WriteFile(path, static_cast<const char*>(pickle.data()),
+                           size) != size)
+    LOG(WARNING) << "Failed to write " << path.value();
+}
+
+}  // namespace
+
+SdchDictionaryFetcher::SdchDictionaryFetcher(
+    const base::FilePath& dictionary_dir,
+    net::URLRequestContext* context)
+    : dictionary_dir_(dictionary_dir),
+      context_(context),
+      read_buffer_(new net::IOBuffer(kReadBufferSize)),
+      weak_factory_(this) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (dictionary_dir_.empty())
+    return;
+  DictionaryList* dictionaries = new DictionaryList;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&ReadDictionaries, dictionary_dir_, dictionaries),
+      base::Bind(&SdchDictionaryFetcher::OnDictionariesLoaded,
+                 weak_factory_.GetWeakPtr(), base::Owned(dictionaries)));
+}
+
+SdchDictionaryFetcher::~SdchDictionaryFetcher() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+}
+
+void SdchDictionaryFetcher::Schedule(const GURL& dictionary_url) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (!attempted_urls_.insert(dictionary_url).second)
+    return;
+  pending_urls_.push(dictionary_url);
+  // Called while the job of the response naming the dictionary is being
+  // destroyed, which is no time to start a request.
+  if (!request_) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&SdchDictionaryFetcher::StartNextFetch,
+                   weak_factory_.GetWeakPtr()));
+  }
+}
+
+void SdchDictionaryFetcher::OnResponseStarted(net::URLRequest* request) {
+  if (!request->status().is_success() || request->GetResponseCode() != 200) {
+    FinishFetch(false);
+    return;
+  }
+  ReadBody();
+}
+
+void SdchDictionaryFetcher::OnReadCompleted(net::URLRequest* request,
+                                            int bytes_read) {
+  if (bytes_read <= 0) {
+    FinishFetch(request->status().is_success());
+    return;
+  }
+  data_.append(read_buffer_->data(), bytes_read);
+  if (data_.size() > net::SdchManager::kMaxDictionarySize) {
+    FinishFetch(false);
+    return;
+  }
+  ReadBody();
+}
+
+void SdchDictionaryFetcher::OnDictionariesLoaded(
+    const std::vector<Dictionary>* dictionaries) {
+  net::SdchManager* sdch_manager = net::SdchManager::Global();
+  for (size_t i = 0; i < dictionaries->size(); ++i) {
+    const Dictionary& dictionary = (*dictionaries)[i];
+    attempted_urls_.insert(dictionary.url);
+    // The manager drops those which expired since.
+    sdch_manager->AddSdchDictionary(dictionary.text, dictionary.url);
+  }
+}
+
+void SdchDictionaryFetcher::StartNextFetch() {
+  if (request_ || pending_urls_.empty())
+    return;
+  request_.reset(context_->CreateRequest(pending_urls_.front(), this));
+  pending_urls_.pop();
+  request_->set_load_flags(net::LOAD_DO_NOT_SEND_COOKIES |
+                           net::LOAD_DO_NOT_SAVE_COOKIES);
+  // The pages don't wait for it.
+  request_->SetPriority(net::LOWEST);
+  request_->Start();
+}
+
+void SdchDictionaryFetcher::ReadBody() {
+  int bytes_read = 0;
+  while (request_->Read(read_buffer_, kReadBufferSize, &bytes_read)) {
+    if (bytes_read <= 0) {
+      FinishFetch(true);
+      return;
+    }
+    data_.append(read_buffer_->data(), bytes_read);
+    if (data_.size() > net::SdchManager::kMaxDictionarySize) {
+      FinishFetch(false);
+      return;
+    }
+  }
+  if (!request_->status().is_io_pending())
+    FinishFetch(false);
+}
+
+void SdchDictionaryFetcher::FinishFetch(bool success) {
+  Dictionary dictionary;
+  // The URL the manager was asked to fetch, which it checks again.
+  dictionary.url = request_->original_url();
+  dictionary.text.swap(data_);
+  request_.reset();
+
+  if (success &&
+      net::SdchManager::Global()->AddSdchDictionary(dictionary.text,
+                                                    dictionary.url) &&
+      !dictionary_dir_.empty()) {
+    BrowserThread::PostTask(
+        BrowserThread::FILE, FROM_HERE,
+        base::Bind(&SaveDictionary, dictionary_dir_, dictionary));
+  }
+  StartNextFetch();
+}
+
+}  // namespace cameo
@@ -0,0 +1,89 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_SDCH_DICTIONARY_FETCHER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_SDCH_DICTIONARY_FETCHER_H_
+
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/sdch_manager.h"
+#include "net/url_request/url_request.h"
+
+namespace net {
+class IOBuffer;
+class URLRequestContext;
+}
+
+namespace cameo {
+
+// SdchDictionaryFetcher downloads the shared dictionaries servers name in
+// their Get-Dictionary headers, one at a time, and hands them to
+// net::SdchManager, which then advertises them to the servers they apply to
+// and decodes the responses encoded with them.
+//
+// The dictionaries are also kept in the data path, one file per origin
+// holding the last few dictionaries it served, and given back to the
+// SdchManager on the next launch, so that the first requests of a launch
+// already get encoded responses. Which URLs a dictionary applies to is left
+// to the SdchManager, which only takes dictionaries of the origin that named
+// them. Only lives on the IO thread.
+class SdchDictionaryFetcher : public net::SdchFetcher,
+                              public net::URLRequest::Delegate {
+ public:
+  // A dictionary as it was downloaded, with its headers.
+  struct Dictionary {
+    GURL url;
+    std::string text;
+  };
+
+  // Keeps the dictionaries in |dictionary_dir|, or nowhere if it is empty.
+  // |context| must outlive the fetcher.
+  SdchDictionaryFetcher(const base::FilePath& dictionary_dir,
+                        net::URLRequestContext* context);
+  virtual ~SdchDictionaryFetcher();
+
+  // net::SdchFetcher implementation.
+  virtual void Schedule(const GURL& dictionary_url) OVERRIDE;
+
+  // net::URLRequest::Delegate implementation.
+  virtual void OnResponseStarted(net::URLRequest* request) OVERRIDE;
+  virtual void OnReadCompleted(net::URLRequest* request,
+                               int bytes_read) OVERRIDE;
+
+ private:
+  void OnDictionariesLoaded(const std::vector<Dictionary>* dictionaries);
+
+  void StartNextFetch();
+  void ReadBody();
+  void FinishFetch(bool success);
+
+  base::FilePath dictionary_dir_;
+  net::URLRequestContext* context_;
+
+  std::queue<GURL> pending_urls_;
+  // Every URL is only fetched once per launch, even if it failed.
+  std::set<GURL> attempted_urls_;
+
+  scoped_ptr<net::URLRequest> request_;
+  scoped_refptr<net::IOBuffer> read_buffer_;
+  std::string data_;
+
+  base::WeakPtrFactory<SdchDictionaryFetcher> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SdchDictionaryFetcher);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_SDCH_DICTIONARY_FETCHER_H_
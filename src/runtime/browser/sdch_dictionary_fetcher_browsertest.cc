@@ -0,0 +1,254 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <map>
+#include <string>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/run_loop.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "base/values.h"
+#include "cameo/src/runtime/browser/network_timing_recorder.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_network_delegate.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/common/content_switches.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/sdch_manager.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+
+using cameo::RuntimeURLRequestContextGetter;
+using content::BrowserThread;
+using net::test_server::BasicHttpResponse;
+using net::test_server::HttpRequest;
+using net::test_server::HttpResponse;
+
+namespace {
+
+// Mapped to the server by the host resolver rules. The dictionaries only
+// apply to domains under a registry, unlike 127.0.0.1.
+const char kAppHost[] = "app.sdch.example.com";
+
+// Appends |value| as a VCDIFF integer: base 128, most significant digit
+// first, all but the last digit with their top bit set.
+void AppendVarint(size_t value, std::string* out) {
+  char digits[10];
+  int count = 0;
+  digits[count++] = value & 0x7f;
+  for (value >>= 7; value; value >>= 7)
+    digits[count++] = 0x80 | (value & 0x7f);
+  while (count)
+    out->push_back(digits[--count]);
+}
+
+// Encodes |target|, which starts with |source|, as a VCDIFF delta (RFC
+// 3284) against |source|: a COPY of all of it, then an ADD of the rest. An
+// encoder of the app servers would find more, this is all the test needs.
+std::string EncodeDelta(const std::string& source, const std::string& target) {
+  std::string added = target.substr(source.size());
+  std::string instructions;
+  instructions.push_back(19);  // COPY, size follows, address mode SELF.
+  AppendVarint(source.size(), &instructions);
+  instructions.push_back(1);  // ADD, size follows.
+  AppendVarint(added.size(), &instructions);
+  std::string addresses;
+  AppendVarint(0, &addresses);
+
+  std::string delta;
+  AppendVarint(target.size(), &delta);
+  delta.push_back(0);  // Delta_Indicator, no compressed sections.
+  AppendVarint(added.size(), &delta);
+  AppendVarint(instructions.size(), &delta);
+  AppendVarint(addresses.size(), &delta);
+  delta += added + instructions + addresses;
+
+  std::string window(1, 0x01);  // VCD_SOURCE, the dictionary.
+  AppendVarint(source.size(), &window);
+  AppendVarint(0, &window);
+  AppendVarint(delta.size(), &window);
+  return std::string("\xd6\xc3\xc4\x00\x00", 5) + window + delta;
+}
+
+// The payload of a deployment: the payload of the one before, with a little
+// more at the end.
+std::string GetPayload(int deployment) {
+  std::string payload;
+  for (int i = 0; i < 2000; ++i) {
+    payload += base::StringPrintf("{\"id\": %d, \"name\": \"item %d\"}\n",
+                                  i, i);
+  }
+  for (int i = 1; i <= deployment; ++i)
+    payload += base::StringPrintf("{\"deployment\": %d}\n", i);
+  return payload;
+}
+
+void HasDictionary(const GURL& url, bool* has_dictionary,
+                   const base::Closure& done) {
+  std::string list;
+  net::SdchManager::Global()->GetAvailDictionaryList(url, &list);
+  *has_dictionary = !list.empty();
+  done.Run();
+}
+
+// The counters of the requests of the browser process, which the fetches of
+// the test are.
+void GetBrowserStats(RuntimeURLRequestContextGetter* getter,
+                     double* bytes_read,
+                     double* sdch_requests,
+                     double* sdch_bytes_read,
+                     const base::Closure& done) {
+  scoped_ptr<base::ListValue> owners =
+      getter->network_delegate()->timing_recorder()->GetAsValue();
+  for (size_t i = 0; i < owners->GetSize(); ++i) {
+    base::DictionaryValue* owner = NULL;
+    int render_process_id = 0;
+    if (owners->GetDictionary(i, &owner) &&
+        owner->GetInteger("render_process_id", &render_process_id) &&
+        render_process_id == -1) {
+      owner->GetDouble("bytes_read", bytes_read);
+      owner->GetDouble("sdch_requests", sdch_requests);
+      owner->GetDouble("sdch_bytes_read", sdch_bytes_read);
+    }
+  }
+  done.Run();
+}
+
+// Lets what was posted to the FILE thread so far run.
+void FlushFileThread() {
+  base::RunLoop run_loop;
+  BrowserThread::PostTaskAndReply(BrowserThread::FILE, FROM_HERE,
+                                  base::Bind(&base::DoNothing),
+                                  run_loop.QuitClosure());
+  run_loop.Run();
+}
+
+}  // namespace
+
+// Stands in for an app server: /app.js is the payload of the current
+// deployment, encoded against the payload of the previous one when the
+// client has it as a dictionary, and otherwise sent as is along with the
+// URL of the dictionary.
+class SdchTest : public InProcessBrowserTest {
+ public:
+  SdchTest() {
+    dictionary_ = base::StringPrintf("Domain: %s\nPath: /\n\n", kAppHost) +
+                  GetPayload(1);
+    net::SdchManager::GenerateHash(dictionary_, &client_hash_,
+                                   &server_hash_);
+  }
+
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    command_line->AppendSwitchASCII(
+        switches::kHostResolverRules,
+        base::StringPrintf("MAP %s 127.0.0.1", kAppHost));
+  }
+
+  scoped_ptr<HttpResponse> HandleRequest(const HttpRequest& request) {
+    scoped_ptr<BasicHttpResponse> response(new BasicHttpResponse);
+    response->set_code(net::test_server::SUCCESS);
+    response->AddCustomHeader("Cache-Control", "no-store");
+    if (request.relative_url == "/dictionary") {
+      response->set_content(dictionary_);
+      return response.PassAs<HttpResponse>();
+    }
+
+    response->set_content_type("application/json");
+    std::map<std::string, std::string>::const_iterator avail =
+        request.headers.find("Avail-Dictionary");
+    if (avail != request.headers.end() &&
+        avail->second.find(client_hash_) != std::string::npos) {
+      response->AddCustomHeader("Content-Encoding", "sdch");
+      response->set_content(server_hash_ + std::string(1, '\0') +
+                            EncodeDelta(GetPayload(1), GetPayload(2)));
+    } else {
+      response->AddCustomHeader("Get-Dictionary", "/dictionary");
+      response->set_content(GetPayload(2));
+    }
+    return response.PassAs<HttpResponse>();
+  }
+
+  GURL GetAppURL(const std::string& path) {
+    GURL::Replacements replacements;
+    std::string host = kAppHost;
+    replacements.SetHostStr(host);
+    return server_->GetURL(path).ReplaceComponents(replacements);
+  }
+
+  // Returns once the dictionary named by the first response is usable.
+  bool WaitForDictionary(const GURL& url) {
+    for (int i = 0; i < 50; ++i) {
+      bool has_dictionary = false;
+      cameo_test_utils::RunOnIOThreadAndWait(
+          base::Bind(&HasDictionary, url, &has_dictionary));
+      if (has_dictionary)
+        return true;
+      cameo_test_utils::RunMessageLoopFor(
+          base::TimeDelta::FromMilliseconds(100));
+    }
+    return false;
+  }
+
+  RuntimeURLRequestContextGetter* getter() {
+    return runtime()->runtime_context()->url_request_context_getter();
+  }
+
+ protected:
+  scoped_ptr<net::test_server::EmbeddedTestServer> server_;
+  std::string dictionary_;
+  std::string client_hash_;
+  std::string server_hash_;
+};
+
+IN_PROC_BROWSER_TEST_F(SdchTest, BytesSavedBenchmark) {
+  server_.reset(new net::test_server::EmbeddedTestServer(
+      BrowserThread::GetMessageLoopProxyForThread(BrowserThread::IO)));
+  ASSERT_TRUE(server_->InitializeAndWaitUntilReady());
+  server_->RegisterRequestHandler(
+      base::Bind(&SdchTest::HandleRequest, base::Unretained(this)));
+  GURL url = GetAppURL("/app.js");
+
+  double plain_bytes = 0;
+  double sdch_requests = 0;
+  double sdch_bytes = 0;
+  EXPECT_EQ(GetPayload(2), cameo_test_utils::FetchURL(getter(), url));
+  cameo_test_utils::RunOnIOThreadAndWait(base::Bind(
+      &GetBrowserStats, getter(), &plain_bytes, &sdch_requests, &sdch_bytes));
+  EXPECT_EQ(0, sdch_requests);
+
+  ASSERT_TRUE(WaitForDictionary(url));
+  double total_bytes = 0;
+  EXPECT_EQ(GetPayload(2), cameo_test_utils::FetchURL(getter(), url));
+  cameo_test_utils::RunOnIOThreadAndWait(base::Bind(
+      &GetBrowserStats, getter(), &total_bytes, &sdch_requests, &sdch_bytes));
+  EXPECT_EQ(1, sdch_requests);
+  EXPECT_LT(sdch_bytes, plain_bytes);
+
+  // The dictionary is kept for the next launch, under its origin.
+  FlushFileThread();
+  base::FilePath origin_file =
+      runtime()->runtime_context()->GetPath()
+          .Append(FILE_PATH_LITERAL("SDCH Dictionaries"))
+          .AppendASCII(base::StringPrintf("http_%s_%d", kAppHost,
+                                          url.EffectiveIntPort()));
+  EXPECT_TRUE(file_util::PathExists(origin_file));
+
+  cameo_test_utils::PrintPerfResult("sdch_response_bytes", "plain",
+                                    plain_bytes, "bytes");
+  cameo_test_utils::PrintPerfResult("sdch_response_bytes", "sdch",
+                                    sdch_bytes, "bytes");
+  cameo_test_utils::PrintPerfResult("sdch_response_bytes", "saved",
+                                    plain_bytes - sdch_bytes, "bytes");
+}
@@ -0,0 +1,276 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/startup_predictor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/json/json_file_value_serializer.h"
+#include "base/values.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_network_delegate.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/render_view_host.h"
+#include "content/public/browser/resource_request_info.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/common/content_client.h"
+#include "net/base/address_list.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_log.h"
+#include "net/dns/host_resolver.h"
+#include "net/http/http_network_session.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_request_info.h"
+#include "net/http/http_stream_factory.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/ssl/ssl_config_service.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_context.h"
+#include "webkit/glue/resource_type.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+const base::FilePath::CharType kPredictorFilename[] =
+    FILE_PATH_LITERAL("Startup Predictor");
+
+// Connections opened to the startup origin: one for the document and one for
+// the first subresource fetched in parallel.
+const int kStartupOriginConnections = 2;
+
+// At most this many learned origins are remembered per startup origin. The
+// first kMaxPreconnectedOrigins of them are preconnected, the others are only
+// resolved.
+const size_t kMaxLearnedOrigins = 8;
+const size_t kMaxPreconnectedOrigins = 4;
+
+// Subresource requests issued within this delay after startup are considered
+// part of the startup page.
+const int kLearningWindowInSeconds = 10;
+
+// Keeps the result of a speculative host resolution alive until it completes.
+struct PrefetchResolution {
+  net::AddressList addresses;
+  net::HostResolver::RequestHandle handle;
+};
+
+void OnPrefetchResolved(PrefetchResolution* resolution, int rv) {
+}
+
+bool IsHttpOrigin(const GURL& url) {
+  return url.is_valid() && url.SchemeIsHTTPOrHTTPS();
+}
+
+bool CompareByCount(const std::pair<GURL, int>& a,
+                    const std::pair<GURL, int>& b) {
+  return a.second > b.second;
+}
+
+}  // namespace
+
+StartupPredictor::StartupPredictor(const base::FilePath& data_path,
+                                   const GURL& startup_url)
+    : predictor_file_(data_path.Append(kPredictorFilename)),
+      startup_origin_(startup_url.GetOrigin()),
+      startup_view_(-1, -1) {
+}
+
+StartupPredictor::~StartupPredictor() {
+}
+
+void StartupPredictor::Start(RuntimeURLRequestContextGetter* getter) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (!IsHttpOrigin(startup_origin_))
+    return;
+
+  getter_ = getter;
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&StartupPredictor::LoadLearnedOrigins, this));
+}
+
+void StartupPredictor::SetStartupRuntime(Runtime* runtime) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  content::RenderViewHost* render_view_host =
+      runtime->web_contents()->GetRenderViewHost();
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&StartupPredictor::SetStartupViewOnIOThread, this,
+                 ViewId(render_view_host->GetProcess()->GetID(),
+                        render_view_host->GetRoutingID())));
+}
+
+void StartupPredictor::Shutdown() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&StartupPredictor::ShutdownOnIOThread, this));
+}
+
+void StartupPredictor::LearnFromRequest(const net::URLRequest& request) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (!learning_timer_.IsRunning())
+    return;
+
+  const content::ResourceRequestInfo* info =
+      content::ResourceRequestInfo::ForRequest(&request);
+  if (!info || info->GetResourceType() == ResourceType::MAIN_FRAME)
+    return;
+  // The other windows opened meanwhile don't load the startup page.
+  ViewId view;
+  if (!info->GetAssociatedRenderView(&view.first, &view.second) ||
+      view != startup_view_)
+    return;
+
+  GURL origin = request.url().GetOrigin();
+  if (!IsHttpOrigin(origin) || origin == startup_origin_)
+    return;
+  ++origin_counts_[origin];
+}
+
+void StartupPredictor::LoadLearnedOrigins() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  std::vector<GURL> learned_origins;
+
+  JSONFileValueSerializer serializer(predictor_file_);
+  scoped_ptr<base::Value> value(serializer.Deserialize(NULL, NULL));
+  base::DictionaryValue* dict = NULL;
+  base::ListValue* list = NULL;
+  if (value && value->GetAsDictionary(&dict) &&
+      dict->GetListWithoutPathExpansion(startup_origin_.spec(), &list)) {
+    for (size_t i = 0; i < list->GetSize() && i < kMaxLearnedOrigins; ++i) {
+      std::string spec;
+      if (list->GetString(i, &spec) && IsHttpOrigin(GURL(spec)))
+        learned_origins.push_back(GURL(spec));
+    }
+  }
+
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&StartupPredictor::PreconnectOnIOThread, this,
+                 learned_origins));
+}
+
+void StartupPredictor::SaveLearnedOrigins(const std::vector<GURL>& origins) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  JSONFileValueSerializer serializer(predictor_file_);
+  scoped_ptr<base::Value> value(serializer.Deserialize(NULL, NULL));
+  scoped_ptr<base::DictionaryValue> dict;
+  if (value && value->IsType(base::Value::TYPE_DICTIONARY))
+    dict.reset(static_cast<base::DictionaryValue*>(value.release()));
+  else
+    dict.reset(new base::DictionaryValue);
+
+  base::ListValue* list = new base::ListValue;
+  for (size_t i = 0; i < origins.size(); ++i)
+    list->AppendString(origins[i].spec());
+  dict->SetWithoutPathExpansion(startup_origin_.spec(), list);
+
+  if (!serializer.Serialize(*dict))
+    LOG(WARNING) << "Failed to save " << predictor_file_.value();
+}
+
+void StartupPredictor::SetStartupViewOnIOThread(const ViewId& view) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  startup_view_ = view;
+}
+
+void StartupPredictor::PreconnectOnIOThread(
+    const std::vector<GURL>& learned_origins) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (!getter_)
+    return;
+  TRACE_EVENT0("cameo.startup", "StartupPredictor::Preconnect");
+
+  net::URLRequestContext* context = getter_->GetURLRequestContext();
+  Preconnect(context, startup_origin_, kStartupOriginConnections);
+  for (size_t i = 0; i < learned_origins.size(); ++i) {
+    if (i < kMaxPreconnectedOrigins)
+      Preconnect(context, learned_origins[i], 1);
+    else
+      PrefetchHost(context, learned_origins[i]);
+  }
+
+  // Learn again from this session, so that the predictions follow the app.
+  getter_->network_delegate()->set_startup_predictor(this);
+  learning_timer_.Start(FROM_HERE,
+                        base::TimeDelta::FromSeconds(kLearningWindowInSeconds),
+                        this, &StartupPredictor::StopLearning);
+}
+
+void StartupPredictor::Preconnect(net::URLRequestContext* context,
+                                  const GURL& origin,
+                                  int count) {
+  net::HttpNetworkSession* session =
+      context->http_transaction_factory()->GetSession();
+  if (!session)
+    return;
+
+  net::HttpRequestInfo request_info;
+  request_info.url = origin;
+  request_info.method = "GET";
+  request_info.extra_headers.SetHeader(net::HttpRequestHeaders::kUserAgent,
+                                       content::GetUserAgent(origin));
+  request_info.motivation = net::HttpRequestInfo::PRECONNECT_MOTIVATED;
+
+  net::SSLConfig ssl_config;
+  session->ssl_config_service()->GetSSLConfig(&ssl_config);
+  session->http_stream_factory()->PreconnectStreams(
+      count, request_info, net::LOWEST, ssl_config, ssl_config);
+}
+
+void StartupPredictor::PrefetchHost(net::URLRequestContext* context,
+                                    const GURL& origin) {
+  net::HostResolver::RequestInfo request_info(
+      net::HostPortPair::FromURL(origin));
+  request_info.set_is_speculative(true);
+
+  // The resolution is owned by the callback, which the resolver drops once
+  // the request completes or is cancelled.
+  PrefetchResolution* resolution = new PrefetchResolution;
+  context->host_resolver()->Resolve(
+      request_info, &resolution->addresses,
+      base::Bind(&OnPrefetchResolved, base::Owned(resolution)),
+      &resolution->handle, net::BoundNetLog());
+}
+
+void StartupPredictor::StopLearning() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  learning_timer_.Stop();
+  if (getter_)
+    getter_->network_delegate()->set_startup_predictor(NULL);
+
+  // An empty session, e.g. offline, shouldn't wipe out what was learned.
+  if (origin_counts_.empty())
+    return;
+
+  std::vector<std::pair<GURL, int> > sorted(origin_counts_.begin(),
+                                            origin_counts_.end());
+  std::stable_sort(sorted.begin(), sorted.end(), CompareByCount);
+  std::vector<GURL> origins;
+  for (size_t i = 0; i < sorted.size() && i < kMaxLearnedOrigins; ++i)
+    origins.push_back(sorted[i].first);
+  origin_counts_.clear();
+
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&StartupPredictor::SaveLearnedOrigins, this, origins));
+}
+
+void StartupPredictor::ShutdownOnIOThread() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (learning_timer_.IsRunning())
+    StopLearning();
+  getter_ = NULL;
+}
+
+}  // namespace cameo
@@ -0,0 +1,94 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_STARTUP_PREDICTOR_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_STARTUP_PREDICTOR_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/timer.h"
+#include "googleurl/src/gurl.h"
+
+namespace net {
+class URLRequest;
+class URLRequestContext;
+}
+
+namespace cameo {
+
+class Runtime;
+class RuntimeURLRequestContextGetter;
+
+// StartupPredictor gets the network ready for the startup URL while the
+// window and the renderer are still being created. It preconnects (and for
+// https, handshakes) to the startup origin from the IO thread. It also learns
+// which origins the first page pulls subresources from, keeps them in the data
+// path, and on later launches preconnects to them, or at least resolves their
+// hosts.
+class StartupPredictor : public base::RefCountedThreadSafe<StartupPredictor> {
+ public:
+  StartupPredictor(const base::FilePath& data_path, const GURL& startup_url);
+
+  // Loads what the previous session learned and starts preconnecting. Called
+  // on the UI thread.
+  void Start(RuntimeURLRequestContextGetter* getter);
+
+  // Only the requests of the render view of |runtime|, which loads the
+  // startup page, are learned from. Called on the UI thread right after the
+  // Runtime is created, before it issues any request.
+  void SetStartupRuntime(Runtime* runtime);
+
+  // Stops learning and detaches from the network stack. Called on the UI
+  // thread before the request context goes away.
+  void Shutdown();
+
+  // Records the origin of a subresource request of the startup page. Called on
+  // the IO thread by RuntimeNetworkDelegate.
+  void LearnFromRequest(const net::URLRequest& request);
+
+ private:
+  friend class base::RefCountedThreadSafe<StartupPredictor>;
+
+  // A render process id and render view id.
+  typedef std::pair<int, int> ViewId;
+
+  ~StartupPredictor();
+
+  // Runs on the FILE thread.
+  void LoadLearnedOrigins();
+  void SaveLearnedOrigins(const std::vector<GURL>& origins);
+
+  // Runs on the IO thread.
+  void SetStartupViewOnIOThread(const ViewId& view);
+  void PreconnectOnIOThread(const std::vector<GURL>& learned_origins);
+  void Preconnect(net::URLRequestContext* context, const GURL& origin,
+                  int count);
+  void PrefetchHost(net::URLRequestContext* context, const GURL& origin);
+  void StopLearning();
+  void ShutdownOnIOThread();
+
+  const base::FilePath predictor_file_;
+  const GURL startup_origin_;
+
+  // Set on the UI thread by Start() before it posts any task, then only
+  // accessed on the IO thread.
+  scoped_refptr<RuntimeURLRequestContextGetter> getter_;
+
+  // Only accessed on the IO thread.
+  ViewId startup_view_;
+  std::map<GURL, int> origin_counts_;
+  base::OneShotTimer<StartupPredictor> learning_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupPredictor);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_STARTUP_PREDICTOR_H_
@@ -0,0 +1,191 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/startup_tracer.h"
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/debug/trace_event.h"
+#include "base/debug/trace_event_impl.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/threading/thread_restrictions.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/browser/web_contents_observer.h"
+
+using base::debug::CategoryFilter;
+using base::debug::TraceLog;
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// The application-wide startup tracer, NULL if tracing is disabled.
+StartupTracer* g_startup_tracer = NULL;
+
+// Write the trace anyway if the startup Runtime hasn't painted after this.
+const int kTimeoutInSeconds = 30;
+
+void WriteTraceFile(const base::FilePath& path, const std::string& data) {
+  int written = file_util::WriteFile(path, data.data(), data.size());
+  if (written != static_cast<int>(data.size()))
+    LOG(ERROR) << "Failed to write the startup trace to " << path.value();
+}
+
+}  // namespace
+
+class StartupTracer::StartupWebContentsObserver
+    : public content::WebContentsObserver {
+ public:
+  StartupWebContentsObserver(StartupTracer* tracer,
+                             content::WebContents* web_contents)
+      : content::WebContentsObserver(web_contents),
+        tracer_(tracer),
+        committed_(false) {
+  }
+
+  // content::WebContentsObserver implementation.
+  virtual void DidCommitProvisionalLoadForFrame(
+      int64 frame_id,
+      bool is_main_frame,
+      const GURL& url,
+      content::PageTransition transition_type,
+      content::RenderViewHost* render_view_host) OVERRIDE {
+    if (!is_main_frame || committed_)
+      return;
+    committed_ = true;
+    TRACE_EVENT_INSTANT1("cameo.startup", "FirstNavigationCommit",
+                         TRACE_EVENT_SCOPE_THREAD, "url", url.spec());
+  }
+
+  virtual void DidFirstVisuallyNonEmptyPaint(int32 page_id) OVERRIDE {
+    TRACE_EVENT_INSTANT0("cameo.startup", "FirstPaint",
+                         TRACE_EVENT_SCOPE_THREAD);
+    tracer_->OnFirstPaint();
+  }
+
+  virtual void WebContentsDestroyed(
+      content::WebContents* web_contents) OVERRIDE {
+    tracer_->Finish();
+  }
+
+ private:
+  StartupTracer* tracer_;
+  bool committed_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupWebContentsObserver);
+};
+
+// static
+StartupTracer* StartupTracer::Get() {
+  return g_startup_tracer;
+}
+
+// static
+scoped_ptr<StartupTracer> StartupTracer::CreateIfEnabled(
+    const CommandLine& command_line) {
+  if (!command_line.HasSwitch(switches::kTraceStartupTimeline))
+    return scoped_ptr<StartupTracer>();
+
+  base::FilePath trace_file =
+      command_line.GetSwitchValuePath(switches::kTraceStartupTimeline);
+  if (trace_file.empty()) {
+    LOG(ERROR) << "--" << switches::kTraceStartupTimeline
+               << " requires a file name.";
+    return scoped_ptr<StartupTracer>();
+  }
+  return scoped_ptr<StartupTracer>(new StartupTracer(trace_file));
+}
+
+StartupTracer::StartupTracer(const base::FilePath& trace_file)
+    : trace_file_(trace_file),
+      recording_(true) {
+  DCHECK(!g_startup_tracer);
+  g_startup_tracer = this;
+
+  // Record the content and net categories along with our own milestones, so
+  // that the gaps between the milestones can be explained.
+  TraceLog::GetInstance()->SetEnabled(
+      CategoryFilter(CategoryFilter::kDefaultCategoryFilterString),
+      TraceLog::RECORD_UNTIL_FULL);
+  TRACE_EVENT_INSTANT0("cameo.startup", "StartupTracingStarted",
+                       TRACE_EVENT_SCOPE_THREAD);
+}
+
+StartupTracer::~StartupTracer() {
+  DCHECK_EQ(this, g_startup_tracer);
+  // The browser is shutting down before the startup Runtime painted.
+  if (recording_) {
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    recording_ = false;
+    WriteTraceFile(trace_file_, StopAndCollectTraceData());
+  }
+  g_startup_tracer = NULL;
+}
+
+void StartupTracer::StartTimeout() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (!recording_)
+    return;
+  timeout_timer_.Start(FROM_HERE,
+                       base::TimeDelta::FromSeconds(kTimeoutInSeconds),
+                       this, &StartupTracer::Finish);
+}
+
+void StartupTracer::ObserveStartupWebContents(
+    content::WebContents* web_contents) {
+  if (!recording_ || web_contents_observer_)
+    return;
+  web_contents_observer_.reset(
+      new StartupWebContentsObserver(this, web_contents));
+}
+
+void StartupTracer::OnFirstPaint() {
+  Finish();
+}
+
+void StartupTracer::Finish() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (!recording_)
+    return;
+  recording_ = false;
+  timeout_timer_.Stop();
+
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&WriteTraceFile, trace_file_, StopAndCollectTraceData()));
+
+  // Stop watching the startup Runtime, this may be called from within the
+  // observer so delete it once the current task is done.
+  if (web_contents_observer_) {
+    BrowserThread::DeleteSoon(BrowserThread::UI, FROM_HERE,
+                              web_contents_observer_.release());
+  }
+}
+
+std::string StartupTracer::StopAndCollectTraceData() {
+  TraceLog::GetInstance()->SetDisabled();
+  trace_data_.clear();
+  TraceLog::GetInstance()->Flush(
+      base::Bind(&StartupTracer::OnTraceDataCollected,
+                 base::Unretained(this)));
+  std::string json = "{\"traceEvents\":[" + trace_data_ + "]}";
+  trace_data_.clear();
+  return json;
+}
+
+void StartupTracer::OnTraceDataCollected(
+    const scoped_refptr<base::RefCountedString>& events_str) {
+  if (events_str->data().empty())
+    return;
+  // Each chunk is a comma separated list of events without the brackets.
+  if (!trace_data_.empty())
+    trace_data_.append(",");
+  trace_data_.append(events_str->data());
+}
+
+}  // namespace cameo
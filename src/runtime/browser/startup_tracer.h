@@ -0,0 +1,76 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_STARTUP_TRACER_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_STARTUP_TRACER_H_
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/timer.h"
+
+class CommandLine;
+
+namespace content {
+class WebContents;
+}
+
+namespace cameo {
+
+// StartupTracer records the startup timeline of the browser process, from
+// CameoMainDelegate::BasicStartupComplete to the first paint of the startup
+// Runtime, and writes it out as a Chrome trace JSON file which can be loaded
+// in about:tracing. It only exists when switches::kTraceStartupTimeline is
+// given. Cameo's own milestones are recorded in the "cameo.startup" category.
+class StartupTracer {
+ public:
+  // Returns NULL if startup tracing is not enabled.
+  static StartupTracer* Get();
+
+  // Creates and starts the tracer if |command_line| asks for it.
+  static scoped_ptr<StartupTracer> CreateIfEnabled(
+      const CommandLine& command_line);
+
+  ~StartupTracer();
+
+  // Starts the timeout after which the trace is written even if the startup
+  // Runtime never paints. Must be called on the UI thread once the main
+  // message loop exists.
+  void StartTimeout();
+
+  // Watches |web_contents| of the startup Runtime for its first navigation
+  // commit and its first paint.
+  void ObserveStartupWebContents(content::WebContents* web_contents);
+
+  // Stops recording and writes the trace file. Safe to call more than once.
+  void Finish();
+
+ private:
+  class StartupWebContentsObserver;
+
+  explicit StartupTracer(const base::FilePath& trace_file);
+
+  void OnFirstPaint();
+
+  // Stops the TraceLog and returns everything it recorded as trace JSON.
+  std::string StopAndCollectTraceData();
+  void OnTraceDataCollected(
+      const scoped_refptr<base::RefCountedString>& events_str);
+
+  base::FilePath trace_file_;
+  bool recording_;
+  std::string trace_data_;
+  base::OneShotTimer<StartupTracer> timeout_timer_;
+  scoped_ptr<StartupWebContentsObserver> web_contents_observer_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupTracer);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_STARTUP_TRACER_H_
@@ -0,0 +1,144 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/process_util.h"
+#include "base/stringprintf.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/storage_partition.h"
+#include "googleurl/src/gurl.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_context_getter.h"
+
+namespace {
+
+const int kPartitionCount = 20;
+
+// What the request contexts of a partition are made of, only read on the IO
+// thread.
+struct ContextParts {
+  ContextParts()
+      : session(NULL),
+        host_resolver(NULL),
+        cert_verifier(NULL),
+        cookie_store(NULL),
+        http_cache(NULL) {
+  }
+
+  const void* session;
+  const void* host_resolver;
+  const void* cert_verifier;
+  const void* cookie_store;
+  const void* http_cache;
+};
+
+void GetContextParts(net::URLRequestContextGetter* getter,
+                     ContextParts* parts,
+                     const base::Closure& done) {
+  net::URLRequestContext* context = getter->GetURLRequestContext();
+  parts->session = context->http_transaction_factory()->GetSession();
+  parts->host_resolver = context->host_resolver();
+  parts->cert_verifier = context->cert_verifier();
+  parts->cookie_store = context->cookie_store();
+  parts->http_cache = context->http_transaction_factory();
+  done.Run();
+}
+
+size_t GetWorkingSetSize() {
+  scoped_ptr<base::ProcessMetrics> metrics(
+      base::ProcessMetrics::CreateProcessMetrics(
+          base::GetCurrentProcessHandle()));
+  return metrics->GetWorkingSetSize();
+}
+
+}  // namespace
+
+class StoragePartitionTest : public InProcessBrowserTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    command_line->AppendSwitch(switches::kIsolateSiteStorage);
+  }
+
+  content::StoragePartition* GetPartition(int index) {
+    return content::BrowserContext::GetStoragePartitionForSite(
+        runtime()->runtime_context(),
+        GURL(base::StringPrintf("http://site%d.test/", index)));
+  }
+
+  ContextParts GetParts(net::URLRequestContextGetter* getter) {
+    ContextParts parts;
+    cameo_test_utils::RunOnIOThreadAndWait(
+        base::Bind(&GetContextParts, getter, &parts));
+    return parts;
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(StoragePartitionTest, SharesNetworkSession) {
+  content::StoragePartition* first = GetPartition(0);
+  content::StoragePartition* second = GetPartition(1);
+  ASSERT_NE(first, second);
+  EXPECT_EQ(first, GetPartition(0));
+
+  ContextParts default_parts = GetParts(
+      runtime()->runtime_context()->GetRequestContext());
+  ContextParts first_parts = GetParts(first->GetURLRequestContext());
+  ContextParts second_parts = GetParts(second->GetURLRequestContext());
+
+  EXPECT_EQ(default_parts.session, first_parts.session);
+  EXPECT_EQ(default_parts.session, second_parts.session);
+  EXPECT_EQ(default_parts.host_resolver, first_parts.host_resolver);
+  EXPECT_EQ(default_parts.cert_verifier, first_parts.cert_verifier);
+
+  EXPECT_NE(default_parts.cookie_store, first_parts.cookie_store);
+  EXPECT_NE(first_parts.cookie_store, second_parts.cookie_store);
+  EXPECT_NE(default_parts.http_cache, first_parts.http_cache);
+  EXPECT_NE(first_parts.http_cache, second_parts.http_cache);
+}
+
+// Compares the memory of kPartitionCount partitions in this process with an
+// estimate of kPartitionCount browser processes of one partition each. The
+// estimate counts every process at the working set this one has before any
+// partition is created, so it leaves out the renderers either way.
+IN_PROC_BROWSER_TEST_F(StoragePartitionTest, MemoryBenchmark) {
+  ASSERT_TRUE(test_server()->Start());
+  GURL url = test_server()->GetURL("title.html");
+
+  // Build the default network stack before measuring.
+  cameo_test_utils::FetchURL(
+      runtime()->runtime_context()->GetRequestContext(), url);
+  size_t process_size = GetWorkingSetSize();
+
+  std::vector<content::StoragePartition*> partitions;
+  for (int i = 0; i < kPartitionCount; ++i) {
+    partitions.push_back(GetPartition(i));
+    // Fetching builds the request context of the partition.
+    cameo_test_utils::FetchURL(partitions.back()->GetURLRequestContext(),
+                               url);
+  }
+  size_t partitions_size = GetWorkingSetSize();
+
+  double added_kb = partitions_size > process_size ?
+      (partitions_size - process_size) / 1024.0 : 0;
+  std::string trace = base::StringPrintf("%d_partitions", kPartitionCount);
+  cameo_test_utils::PrintPerfResult("storage_partition_memory", trace,
+                                    partitions_size / 1024.0, "KB");
+  cameo_test_utils::PrintPerfResult("storage_partition_memory",
+                                    "per_partition",
+                                    added_kb / kPartitionCount, "KB");
+  cameo_test_utils::PrintPerfResult(
+      "storage_partition_memory",
+      base::StringPrintf("%d_processes_estimate", kPartitionCount),
+      kPartitionCount * (process_size / 1024.0), "KB");
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/tiered_http_cache.h"
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/string_number_conversions.h"
+#include "cameo/src/runtime/browser/http_cache_snapshot.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/completion_callback.h"
+#include "net/base/net_errors.h"
+#include "net/disk_cache/disk_cache.h"
+#include "net/http/http_cache.h"
+#include "net/http/http_transaction.h"
+
+using content::BrowserThread;
+
+namespace cameo {
+
+namespace {
+
+// The streams of the entries of the memory backend: the headers, the body,
+// and what the HTTP cache keeps for the renderer.
+const int kMemoryEntryStreams = 3;
+
+int GetSizeSwitch(const CommandLine& command_line, const char* name) {
+  int size = 0;
+  if (command_line.HasSwitch(name) &&
+      (!base::StringToInt(command_line.GetSwitchValueASCII(name), &size) ||
+       size < 0)) {
+    LOG(WARNING) << "Invalid --" << name << ", using the default size.";
+    size = 0;
+  }
+  return size;
+}
+
+net::HttpCache::BackendFactory* CreateDiskBackend(
+    const base::FilePath& cache_path,
+    const TieredHttpCache::Config& config) {
+  net::HttpCache::BackendFactory* backend =
+      new net::HttpCache::DefaultBackend(
+          net::DISK_CACHE,
+          cache_path,
+          config.disk_cache_size,
+          BrowserThread::GetMessageLoopProxyForThread(BrowserThread::CACHE));
+  if (!config.snapshot_path.empty())
+    backend = new HttpCacheSnapshot(config.snapshot_path, backend);
+  return backend;
+}
+
+}  // namespace
+
+// Forwards to the next layer down, counting the transactions it creates. The
+// caches only create a transaction on their network layer when they can't
+// answer from their own backend.
+class TieredHttpCache::CountingLayer : public net::HttpTransactionFactory {
+ public:
+  explicit CountingLayer(net::HttpTransactionFactory* next)
+      : next_(next),
+        count_(0) {
+  }
+
+  int64 count() const { return count_; }
+
+  // net::HttpTransactionFactory implementation.
+  virtual int CreateTransaction(
+      net::RequestPriority priority,
+      scoped_ptr<net::HttpTransaction>* trans,
+      net::HttpTransactionDelegate* delegate) OVERRIDE {
+    ++count_;
+    return next_->CreateTransaction(priority, trans, delegate);
+  }
+  virtual net::HttpCache* GetCache() OVERRIDE {
+    return next_->GetCache();
+  }
+  virtual net::HttpNetworkSession* GetSession() OVERRIDE {
+    return next_->GetSession();
+  }
+
+ private:
+  scoped_ptr<net::HttpTransactionFactory> next_;
+  int64 count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingLayer);
+};
+
+TieredHttpCache::Config::Config()
+    : mode(MODE_DISK),
+      disk_cache_size(0),
+      memory_cache_size(0) {
+}
+
+// static
+TieredHttpCache::Config TieredHttpCache::Config::FromCommandLine(
+    const CommandLine& command_line) {
+  Config config;
+  if (command_line.HasSwitch(switches::kHttpCacheMode)) {
+    std::string mode =
+        command_line.GetSwitchValueASCII(switches::kHttpCacheMode);
+    if (mode == "memory")
+      config.mode = MODE_MEMORY;
+    else if (mode == "hybrid")
+      config.mode = MODE_HYBRID;
+    else if (mode != "disk")
+      LOG(WARNING) << "Unknown HTTP cache mode " << mode << ", using disk.";
+  }
+  config.disk_cache_size =
+      GetSizeSwitch(command_line, switches::kDiskCacheSize);
+  config.memory_cache_size =
+      GetSizeSwitch(command_line, switches::kMemoryCacheSize);
+  return config;
+}
+
+TieredHttpCache::Stats::Stats()
+    : memory_hits(0),
+      memory_misses(0),
+      disk_hits(0),
+      disk_misses(0) {
+}
+
+TieredHttpCache::TieredHttpCache(
+    const Config& config,
+    const base::FilePath& cache_path,
+    net::HttpTransactionFactory* network_layer,
+    net::NetLog* net_log)
+    : memory_cache_(NULL),
+      disk_cache_(NULL),
+      below_memory_(NULL),
+      below_disk_(NULL),
+      lookups_(0) {
+  if (config.mode != MODE_MEMORY) {
+    below_disk_ = new CountingLayer(network_layer);
+    disk_cache_ = new net::HttpCache(
+        below_disk_, net_log,
+        CreateDiskBackend(cache_path, config));
+  }
+
+  if (config.mode == MODE_DISK) {
+    cache_.reset(disk_cache_);
+    return;
+  }
+
+  below_memory_ = new CountingLayer(
+      disk_cache_ ? static_cast<net::HttpTransactionFactory*>(disk_cache_) :
+                    network_layer);
+  memory_cache_ = new net::HttpCache(
+      below_memory_, net_log,
+      net::HttpCache::DefaultBackend::InMemory(config.memory_cache_size));
+  cache_.reset(memory_cache_);
+}
+
+TieredHttpCache::~TieredHttpCache() {
+}
+
+TieredHttpCache::Stats TieredHttpCache::GetStats() const {
+  Stats stats;
+  int64 disk_lookups = lookups_;
+  if (below_memory_) {
+    stats.memory_misses = below_memory_->count();
+    stats.memory_hits = lookups_ - stats.memory_misses;
+    disk_lookups = stats.memory_misses;
+  }
+  if (below_disk_) {
+    stats.disk_misses = below_disk_->count();
+    stats.disk_hits = disk_lookups - stats.disk_misses;
+  }
+  return stats;
+}
+
+int64 TieredHttpCache::PurgeMemoryTier() {
+  // The backend is only created along with the first transaction.
+  disk_cache::Backend* backend =
+      memory_cache_ ? memory_cache_->GetCurrentBackend() : NULL;
+  if (!backend)
+    return 0;
+
+  // The memory backend opens its entries synchronously. The children
+  // holding the sparse data of media aren't enumerated, nor counted.
+  int64 bytes = 0;
+  void* iter = NULL;
+  disk_cache::Entry* entry = NULL;
+  while (backend->OpenNextEntry(&iter, &entry, net::CompletionCallback()) ==
+             net::OK) {
+    bytes += entry->GetKey().size();
+    for (int i = 0; i < kMemoryEntryStreams; ++i)
+      bytes += entry->GetDataSize(i);
+    entry->Close();
+  }
+  backend->EndEnumeration(&iter);
+
+  // The memory backend dooms its entries right away, those still in use are
+  // freed once their transactions are done.
+  backend->DoomAllEntries(net::CompletionCallback());
+  return bytes;
+}
+
+int TieredHttpCache::CreateTransaction(
+    net::RequestPriority priority,
+    scoped_ptr<net::HttpTransaction>* trans,
+    net::HttpTransactionDelegate* delegate) {
+  ++lookups_;
+  return cache_->CreateTransaction(priority, trans, delegate);
+}
+
+net::HttpCache* TieredHttpCache::GetCache() {
+  return cache_.get();
+}
+
+net::HttpNetworkSession* TieredHttpCache::GetSession() {
+  return cache_->GetSession();
+}
+
+}  // namespace cameo
@@ -0,0 +1,109 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_TIERED_HTTP_CACHE_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_TIERED_HTTP_CACHE_H_
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/http/http_transaction_factory.h"
+
+class CommandLine;
+
+namespace net {
+class HttpCache;
+class NetLog;
+}
+
+namespace cameo {
+
+// TieredHttpCache is the HTTP transaction factory of a Runtime request
+// context. Depending on its Config it caches on disk, in memory only, or in a
+// bounded memory tier stacked in front of the disk tier. In the hybrid mode
+// the memory HttpCache uses the disk HttpCache as its network layer, so hot
+// entries are served from memory, and whatever misses there is looked up on
+// disk before going to the network. Lookups reaching each tier are counted.
+// The network session below the tiers may be shared with other caches.
+class TieredHttpCache : public net::HttpTransactionFactory {
+ public:
+  enum Mode {
+    MODE_DISK,
+    MODE_MEMORY,
+    MODE_HYBRID,
+  };
+
+  struct Config {
+    Config();
+
+    // Reads switches::kHttpCacheMode, kDiskCacheSize and kMemoryCacheSize.
+    static Config FromCommandLine(const CommandLine& command_line);
+
+    Mode mode;
+    // Maximum sizes in bytes, 0 lets the backends pick their defaults.
+    int disk_cache_size;
+    int memory_cache_size;
+    // The HttpCacheSnapshot a new disk tier starts from, if not empty. Only
+    // the default partition sets it, from switches::kHttpCacheSnapshot.
+    base::FilePath snapshot_path;
+  };
+
+  // Lookups served by each tier, and lookups it passed down. A revalidation
+  // counts as a miss of the tier which had the stale entry.
+  struct Stats {
+    Stats();
+
+    int64 memory_hits;
+    int64 memory_misses;
+    int64 disk_hits;
+    int64 disk_misses;
+  };
+
+  // Takes ownership of |network_layer|, which the lowest tier goes to on a
+  // miss.
+  TieredHttpCache(const Config& config,
+                  const base::FilePath& cache_path,
+                  net::HttpTransactionFactory* network_layer,
+                  net::NetLog* net_log);
+  virtual ~TieredHttpCache();
+
+  // The disk tier, NULL in the memory only mode.
+  net::HttpCache* disk_cache() const { return disk_cache_; }
+
+  Stats GetStats() const;
+
+  // Drops the entries of the memory tier, or of the whole cache in the
+  // memory only mode, to give their memory back under memory pressure. The
+  // disk tier keeps its entries. Returns the bytes the entries dropped held,
+  // 0 in the disk only mode, which has no memory tier.
+  int64 PurgeMemoryTier();
+
+  // net::HttpTransactionFactory implementation.
+  virtual int CreateTransaction(
+      net::RequestPriority priority,
+      scoped_ptr<net::HttpTransaction>* trans,
+      net::HttpTransactionDelegate* delegate) OVERRIDE;
+  virtual net::HttpCache* GetCache() OVERRIDE;
+  virtual net::HttpNetworkSession* GetSession() OVERRIDE;
+
+ private:
+  class CountingLayer;
+
+  // The top tier, owns the lower tiers through its network layer.
+  scoped_ptr<net::HttpCache> cache_;
+  net::HttpCache* memory_cache_;
+  net::HttpCache* disk_cache_;
+
+  // The layers below the memory and disk tiers, counting their misses.
+  CountingLayer* below_memory_;
+  CountingLayer* below_disk_;
+  int64 lookups_;
+
+  DISALLOW_COPY_AND_ASSIGN(TieredHttpCache);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_TIERED_HTTP_CACHE_H_
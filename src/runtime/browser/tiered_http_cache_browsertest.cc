@@ -0,0 +1,126 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "cameo/src/runtime/browser/runtime_context.h"
+#include "cameo/src/runtime/browser/runtime_url_request_context_getter.h"
+#include "cameo/src/runtime/browser/tiered_http_cache.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/cameo_test_utils.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+
+using cameo::RuntimeURLRequestContextGetter;
+using cameo::TieredHttpCache;
+
+namespace {
+
+// The replayed requests: kUrlCount cacheable URLs, requested kRounds times.
+const int kUrlCount = 50;
+const int kRounds = 3;
+
+void GetCacheStats(RuntimeURLRequestContextGetter* getter,
+                   TieredHttpCache::Stats* stats,
+                   const base::Closure& done) {
+  *stats = getter->http_cache()->GetStats();
+  done.Run();
+}
+
+}  // namespace
+
+class TieredHttpCacheTest : public InProcessBrowserTest {
+ public:
+  explicit TieredHttpCacheTest(const char* mode) : mode_(mode) {}
+
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    command_line->AppendSwitchASCII(switches::kHttpCacheMode, mode_);
+  }
+
+  TieredHttpCache::Stats GetStats() {
+    TieredHttpCache::Stats stats;
+    cameo_test_utils::RunOnIOThreadAndWait(base::Bind(
+        &GetCacheStats,
+        runtime()->runtime_context()->url_request_context_getter(),
+        &stats));
+    return stats;
+  }
+
+  // Replays the requests, reports how long each round took, and returns the
+  // counters of the cache tiers.
+  TieredHttpCache::Stats ReplayRequests() {
+    EXPECT_TRUE(test_server()->Start());
+    std::vector<GURL> urls;
+    for (int i = 0; i < kUrlCount; ++i) {
+      // The /cachetime handler answers with max-age=60 whatever the query.
+      urls.push_back(test_server()->GetURL(
+          base::StringPrintf("cachetime?%d", i)));
+    }
+
+    for (int round = 0; round < kRounds; ++round) {
+      base::TimeTicks start = base::TimeTicks::Now();
+      for (size_t i = 0; i < urls.size(); ++i)
+        cameo_test_utils::FetchURL(
+            runtime()->runtime_context()->url_request_context_getter(),
+            urls[i]);
+      cameo_test_utils::PrintPerfResult(
+          "http_cache_replay_" + mode_, base::StringPrintf("round%d", round),
+          (base::TimeTicks::Now() - start).InMillisecondsF(), "ms");
+    }
+
+    TieredHttpCache::Stats stats = GetStats();
+    cameo_test_utils::PrintPerfResult("http_cache_hits_" + mode_, "memory",
+                                      stats.memory_hits, "count");
+    cameo_test_utils::PrintPerfResult("http_cache_hits_" + mode_, "disk",
+                                      stats.disk_hits, "count");
+    return stats;
+  }
+
+ private:
+  std::string mode_;
+};
+
+class DiskHttpCacheTest : public TieredHttpCacheTest {
+ public:
+  DiskHttpCacheTest() : TieredHttpCacheTest("disk") {}
+};
+
+class MemoryHttpCacheTest : public TieredHttpCacheTest {
+ public:
+  MemoryHttpCacheTest() : TieredHttpCacheTest("memory") {}
+};
+
+class HybridHttpCacheTest : public TieredHttpCacheTest {
+ public:
+  HybridHttpCacheTest() : TieredHttpCacheTest("hybrid") {}
+};
+
+IN_PROC_BROWSER_TEST_F(DiskHttpCacheTest, ReplayBenchmark) {
+  TieredHttpCache::Stats stats = ReplayRequests();
+  EXPECT_EQ(kUrlCount, stats.disk_misses);
+  EXPECT_EQ(kUrlCount * (kRounds - 1), stats.disk_hits);
+  EXPECT_EQ(0, stats.memory_hits + stats.memory_misses);
+}
+
+IN_PROC_BROWSER_TEST_F(MemoryHttpCacheTest, ReplayBenchmark) {
+  TieredHttpCache::Stats stats = ReplayRequests();
+  EXPECT_EQ(kUrlCount, stats.memory_misses);
+  EXPECT_EQ(kUrlCount * (kRounds - 1), stats.memory_hits);
+  EXPECT_EQ(0, stats.disk_hits + stats.disk_misses);
+}
+
+IN_PROC_BROWSER_TEST_F(HybridHttpCacheTest, ReplayBenchmark) {
+  TieredHttpCache::Stats stats = ReplayRequests();
+  // Every entry stays hot in the memory tier, the disk tier only sees the
+  // first round.
+  EXPECT_EQ(kUrlCount, stats.memory_misses);
+  EXPECT_EQ(kUrlCount * (kRounds - 1), stats.memory_hits);
+  EXPECT_EQ(kUrlCount, stats.disk_misses);
+  EXPECT_EQ(0, stats.disk_hits);
+}
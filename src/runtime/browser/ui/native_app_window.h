@@ -51,6 +51,9 @@ class NativeAppWindow {
   virtual void UpdateIcon() = 0;
   // Called when the title of the window changes.
   virtual void UpdateTitle(const string16& title) = 0;
+  // Called when the Runtime replaced its WebContents, whose view the window
+  // shows from then on.
+  virtual void UpdateWebContents() = 0;
   // Returns the nonmaximized bounds of the window (even if the window is
   // currently maximized or minimized) in terms of the screen coordinates.
   virtual gfx::Rect GetRestoredBounds() const = 0;
@@ -85,6 +88,8 @@ class NativeAppWindow {
   virtual bool IsMaximized() const = 0;
   virtual bool IsMinimized() const = 0;
   virtual bool IsFullscreen() const = 0;
+  // Returns true if the window is shown, even if minimized.
+  virtual bool IsVisible() const = 0;
 };
 
 }  // namespace cameo
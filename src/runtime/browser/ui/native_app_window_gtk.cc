@@ -6,6 +6,7 @@
 
 #include <gdk/gdk.h>
 
+#include "base/debug/trace_event.h"
 #include "base/utf_string_conversions.h"
 #include "cameo/src/runtime/browser/runtime.h"
 #include "content/public/browser/render_view_host.h"
@@ -94,6 +95,15 @@ void NativeAppWindowGtk::UpdateTitle(const string16& title) {
   gtk_window_set_title(GTK_WINDOW(window_), title_utf8.c_str());
 }
 
+void NativeAppWindowGtk::UpdateWebContents() {
+  // The view of the previous contents goes away along with them.
+  gfx::NativeView native_view =
+      runtime_->web_contents()->GetView()->GetNativeView();
+  gtk_widget_show(native_view);
+  gtk_container_add(GTK_CONTAINER(vbox_), native_view);
+  SetWebKitColorStyle(window_);
+}
+
 gfx::Rect NativeAppWindowGtk::GetRestoredBounds() const {
   // TODO(hmin): Need to implement get restored bounds of native window.
   return GetBounds();
@@ -124,10 +134,12 @@ void NativeAppWindowGtk::Focus() {
 
 void NativeAppWindowGtk::Show() {
   gtk_widget_show(GTK_WIDGET(window_));
+  runtime_->OnWindowStateChanged();
 }
 
 void NativeAppWindowGtk::Hide() {
   gtk_widget_hide(GTK_WIDGET(window_));
+  runtime_->OnWindowStateChanged();
 }
 
 void NativeAppWindowGtk::Maximize() {
@@ -165,7 +177,12 @@ void NativeAppWindowGtk::ActiveWindowChanged(GdkWindow* active_window) {
   if (!window_)
     return;
 
+  bool was_active = is_active_;
   is_active_ = gtk_widget_get_window(GTK_WIDGET(window_)) == active_window;
+  if (is_active_ && !was_active)
+    runtime_->OnWindowActivated();
+  else if (was_active && !is_active_)
+    runtime_->OnWindowStateChanged();
 }
 
 void NativeAppWindowGtk::Close() {
@@ -192,6 +209,10 @@ bool NativeAppWindowGtk::IsFullscreen() const {
   return (state_ & GDK_WINDOW_STATE_FULLSCREEN);
 }
 
+bool NativeAppWindowGtk::IsVisible() const {
+  return gtk_widget_get_visible(GTK_WIDGET(window_));
+}
+
 void NativeAppWindowGtk::SetWebKitColorStyle(GtkWindow* window) {
   // Set WebKit's styles according to current GTK theme.
   content::RendererPreferences* prefs =
@@ -228,6 +249,8 @@ gboolean NativeAppWindowGtk::OnWindowState(GtkWidget* window,
     if (rvh)
       rvh->ExitFullscreen();
   }
+  // Minimized or restored.
+  runtime_->OnWindowStateChanged();
   return FALSE;
 }
 
@@ -316,6 +339,7 @@ void NativeAppWindowGtk::SetWindowSize(GtkWindow* window,
 
 NativeAppWindow* NativeAppWindow::Create(
     const NativeAppWindow::CreateParams& params) {
+  TRACE_EVENT0("cameo.startup", "NativeAppWindow::Create");
   return new NativeAppWindowGtk(params);
 }
 
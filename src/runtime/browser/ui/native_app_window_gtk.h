@@ -26,6 +26,7 @@ class NativeAppWindowGtk : public NativeAppWindow,
   virtual gfx::NativeWindow GetNativeWindow() const OVERRIDE { return window_; }
   virtual void UpdateIcon() OVERRIDE;
   virtual void UpdateTitle(const string16& title) OVERRIDE;
+  virtual void UpdateWebContents() OVERRIDE;
   virtual gfx::Rect GetRestoredBounds() const OVERRIDE;
   virtual gfx::Rect GetBounds() const OVERRIDE;
   virtual void SetBounds(const gfx::Rect& bounds) OVERRIDE;
@@ -42,6 +43,7 @@ class NativeAppWindowGtk : public NativeAppWindow,
   virtual bool IsMaximized() const OVERRIDE;
   virtual bool IsMinimized() const OVERRIDE;
   virtual bool IsFullscreen() const OVERRIDE;
+  virtual bool IsVisible() const OVERRIDE;
 
   // ActiveWindowWatcherXObserver implementation.
   virtual void ActiveWindowChanged(GdkWindow* active_window) OVERRIDE;
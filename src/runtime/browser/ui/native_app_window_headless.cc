@@ -0,0 +1,136 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/browser/ui/native_app_window_headless.h"
+
+#include "base/debug/trace_event.h"
+#include "cameo/src/runtime/browser/runtime.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/browser/web_contents_view.h"
+
+namespace cameo {
+
+NativeAppWindowHeadless::NativeAppWindowHeadless(
+    const NativeAppWindow::CreateParams& params)
+    : runtime_(params.runtime),
+      minimum_size_(params.minimum_size),
+      maximum_size_(params.maximum_size),
+      state_(ui::SHOW_STATE_NORMAL),
+      is_visible_(false),
+      is_active_(false) {
+  TRACE_EVENT0("cameo.startup", "NativeAppWindowHeadless::Create");
+  SetBounds(params.bounds);
+}
+
+NativeAppWindowHeadless::~NativeAppWindowHeadless() {
+}
+
+gfx::NativeWindow NativeAppWindowHeadless::GetNativeWindow() const {
+  return NULL;
+}
+
+void NativeAppWindowHeadless::UpdateIcon() {
+}
+
+void NativeAppWindowHeadless::UpdateTitle(const string16& title) {
+  title_ = title;
+}
+
+void NativeAppWindowHeadless::UpdateWebContents() {
+  runtime_->web_contents()->GetView()->SizeContents(bounds_.size());
+}
+
+gfx::Rect NativeAppWindowHeadless::GetRestoredBounds() const {
+  return bounds_;
+}
+
+gfx::Rect NativeAppWindowHeadless::GetBounds() const {
+  // There is no screen to maximize or fullscreen the window to, so the
+  // bounds never change with the window state.
+  return bounds_;
+}
+
+void NativeAppWindowHeadless::SetBounds(const gfx::Rect& bounds) {
+  gfx::Size size = bounds.size();
+  size.SetToMax(minimum_size_);
+  if (!maximum_size_.IsEmpty())
+    size.SetToMin(maximum_size_);
+  bounds_ = gfx::Rect(bounds.origin(), size);
+
+  runtime_->web_contents()->GetView()->SizeContents(size);
+}
+
+void NativeAppWindowHeadless::Focus() {
+  is_active_ = true;
+  runtime_->web_contents()->GetView()->Focus();
+  runtime_->OnWindowActivated();
+}
+
+void NativeAppWindowHeadless::Show() {
+  is_visible_ = true;
+  if (state_ == ui::SHOW_STATE_MINIMIZED)
+    state_ = ui::SHOW_STATE_NORMAL;
+  runtime_->OnWindowStateChanged();
+}
+
+void NativeAppWindowHeadless::Hide() {
+  is_visible_ = false;
+  is_active_ = false;
+  runtime_->OnWindowStateChanged();
+}
+
+void NativeAppWindowHeadless::Maximize() {
+  state_ = ui::SHOW_STATE_MAXIMIZED;
+  runtime_->OnWindowStateChanged();
+}
+
+void NativeAppWindowHeadless::Minimize() {
+  state_ = ui::SHOW_STATE_MINIMIZED;
+  is_active_ = false;
+  runtime_->OnWindowStateChanged();
+}
+
+void NativeAppWindowHeadless::SetFullscreen(bool fullscreen) {
+  if (IsFullscreen() == fullscreen)
+    return;
+
+  state_ = fullscreen ? ui::SHOW_STATE_FULLSCREEN : ui::SHOW_STATE_NORMAL;
+  runtime_->OnWindowStateChanged();
+}
+
+void NativeAppWindowHeadless::Restore() {
+  state_ = ui::SHOW_STATE_NORMAL;
+  runtime_->OnWindowStateChanged();
+}
+
+void NativeAppWindowHeadless::FlashFrame(bool flash) {
+}
+
+void NativeAppWindowHeadless::Close() {
+  // Mirrors the native windows, which close their Runtime when destroyed.
+  runtime_->Close();
+  delete this;
+}
+
+bool NativeAppWindowHeadless::IsActive() const {
+  return is_active_;
+}
+
+bool NativeAppWindowHeadless::IsMaximized() const {
+  return state_ == ui::SHOW_STATE_MAXIMIZED;
+}
+
+bool NativeAppWindowHeadless::IsMinimized() const {
+  return state_ == ui::SHOW_STATE_MINIMIZED;
+}
+
+bool NativeAppWindowHeadless::IsFullscreen() const {
+  return state_ == ui::SHOW_STATE_FULLSCREEN;
+}
+
+bool NativeAppWindowHeadless::IsVisible() const {
+  return is_visible_;
+}
+
+}  // namespace cameo
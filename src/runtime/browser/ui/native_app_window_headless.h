@@ -0,0 +1,67 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_BROWSER_UI_NATIVE_APP_WINDOW_HEADLESS_H_
+#define CAMEO_SRC_RUNTIME_BROWSER_UI_NATIVE_APP_WINDOW_HEADLESS_H_
+
+#include "base/basictypes.h"
+#include "cameo/src/runtime/browser/ui/native_app_window.h"
+
+namespace cameo {
+
+// A NativeAppWindow without any native window behind it, used when
+// switches::kHeadless is given. Bounds, title and window state are only kept
+// in memory. The view of the WebContents is never attached to a toplevel
+// window, so it stays offscreen and no windowing system resources are
+// allocated for it; it is only resized to follow the bounds of the window.
+class NativeAppWindowHeadless : public NativeAppWindow {
+ public:
+  explicit NativeAppWindowHeadless(const NativeAppWindow::CreateParams& params);
+  virtual ~NativeAppWindowHeadless();
+
+  const string16& title() const { return title_; }
+
+  // NativeAppWindow implementation.
+  virtual gfx::NativeWindow GetNativeWindow() const OVERRIDE;
+  virtual void UpdateIcon() OVERRIDE;
+  virtual void UpdateTitle(const string16& title) OVERRIDE;
+  virtual void UpdateWebContents() OVERRIDE;
+  virtual gfx::Rect GetRestoredBounds() const OVERRIDE;
+  virtual gfx::Rect GetBounds() const OVERRIDE;
+  virtual void SetBounds(const gfx::Rect& bounds) OVERRIDE;
+  virtual void Focus() OVERRIDE;
+  virtual void Show() OVERRIDE;
+  virtual void Hide() OVERRIDE;
+  virtual void Maximize() OVERRIDE;
+  virtual void Minimize() OVERRIDE;
+  virtual void SetFullscreen(bool fullscreen) OVERRIDE;
+  virtual void Restore() OVERRIDE;
+  virtual void FlashFrame(bool flash) OVERRIDE;
+  virtual void Close() OVERRIDE;
+  virtual bool IsActive() const OVERRIDE;
+  virtual bool IsMaximized() const OVERRIDE;
+  virtual bool IsMinimized() const OVERRIDE;
+  virtual bool IsFullscreen() const OVERRIDE;
+  virtual bool IsVisible() const OVERRIDE;
+
+ private:
+  // Weak reference of the associated Runtime instance.
+  Runtime* runtime_;
+
+  string16 title_;
+
+  gfx::Size minimum_size_;
+  gfx::Size maximum_size_;
+
+  gfx::Rect bounds_;
+  ui::WindowShowState state_;
+  bool is_visible_;
+  bool is_active_;
+
+  DISALLOW_COPY_AND_ASSIGN(NativeAppWindowHeadless);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_BROWSER_UI_NATIVE_APP_WINDOW_HEADLESS_H_
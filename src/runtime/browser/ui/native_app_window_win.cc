@@ -4,6 +4,7 @@
 
 #include "cameo/src/runtime/browser/ui/native_app_window_win.h"
 
+#include "base/debug/trace_event.h"
 #include "cameo/src/runtime/browser/runtime.h"
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/render_widget_host_view.h"
@@ -60,6 +61,10 @@ void NativeAppWindowWin::UpdateTitle(const string16& title) {
   window_->UpdateWindowTitle();
 }
 
+void NativeAppWindowWin::UpdateWebContents() {
+  web_view_->SetWebContents(runtime_->web_contents());
+}
+
 gfx::Rect NativeAppWindowWin::GetRestoredBounds() const {
   return window_->GetRestoredBounds();
 }
@@ -78,10 +83,12 @@ void NativeAppWindowWin::Focus() {
 
 void NativeAppWindowWin::Show() {
   window_->Show();
+  runtime_->OnWindowStateChanged();
 }
 
 void NativeAppWindowWin::Hide() {
   window_->Hide();
+  runtime_->OnWindowStateChanged();
 }
 
 void NativeAppWindowWin::Maximize() {
@@ -127,6 +134,10 @@ bool NativeAppWindowWin::IsFullscreen() const {
   return is_fullscreen_;
 }
 
+bool NativeAppWindowWin::IsVisible() const {
+  return window_->IsVisible();
+}
+
 ////////////////////////////////////////////////////////////
 // WidgetDelegate implementation
 ////////////////////////////////////////////////////////////
@@ -236,11 +247,21 @@ void NativeAppWindowWin::OnWidgetDestroyed(views::Widget* widget) {
 }
 void NativeAppWindowWin::OnWidgetBoundsChanged(views::Widget* widget,
     const gfx::Rect& new_bounds) {
+  // Minimizing and restoring the window change its bounds.
+  runtime_->OnWindowStateChanged();
+}
+void NativeAppWindowWin::OnWidgetActivationChanged(views::Widget* widget,
+    bool active) {
+  if (active)
+    runtime_->OnWindowActivated();
+  else
+    runtime_->OnWindowStateChanged();
 }
 
 // static
 NativeAppWindow* NativeAppWindow::Create(
     const NativeAppWindow::CreateParams& create_params) {
+  TRACE_EVENT0("cameo.startup", "NativeAppWindow::Create");
   return new NativeAppWindowWin(create_params);
 }
 
@@ -31,6 +31,7 @@ class NativeAppWindowWin : public NativeAppWindow,
   virtual gfx::NativeWindow GetNativeWindow() const OVERRIDE;
   virtual void UpdateIcon() OVERRIDE;
   virtual void UpdateTitle(const string16& title) OVERRIDE;
+  virtual void UpdateWebContents() OVERRIDE;
   virtual gfx::Rect GetRestoredBounds() const OVERRIDE;
   virtual gfx::Rect GetBounds() const OVERRIDE;
   virtual void SetBounds(const gfx::Rect& bounds) OVERRIDE;
@@ -47,6 +48,7 @@ class NativeAppWindowWin : public NativeAppWindow,
   virtual bool IsMaximized() const OVERRIDE;
   virtual bool IsMinimized() const OVERRIDE;
   virtual bool IsFullscreen() const OVERRIDE;
+  virtual bool IsVisible() const OVERRIDE;
 
  protected:
   // WidgetDelegate implementation.
@@ -83,6 +85,8 @@ class NativeAppWindowWin : public NativeAppWindow,
   virtual void OnWidgetDestroyed(views::Widget* widget) OVERRIDE;
   virtual void OnWidgetBoundsChanged(
       views::Widget* widget, const gfx::Rect& new_bounds) OVERRIDE;
+  virtual void OnWidgetActivationChanged(
+      views::Widget* widget, bool active) OVERRIDE;
 
   // Weak reference of the associated Runtime instance.
   Runtime* runtime_;
@@ -0,0 +1,225 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/common/app_package.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/utf_string_conversions.h"
+#include "net/base/mime_util.h"
+
+namespace cameo {
+
+namespace {
+
+const uint32 kAppPackageMagic = 0x4b504143;  // "CAPK"
+const uint32 kAppPackageVersion = 1;
+
+const char kDefaultMimeType[] = "application/octet-stream";
+
+struct PackageHeader {
+  uint32 magic;
+  uint32 version;
+  uint32 entry_count;
+  uint32 reserved;
+};
+
+// The data of every resource starts at this alignment in the package, which
+// keeps the copies out of the mapping on the fast path.
+const size_t kDataAlignment = 16;
+
+size_t AlignUp(size_t offset) {
+  return (offset + kDataAlignment - 1) & ~(kDataAlignment - 1);
+}
+
+struct PendingResource {
+  std::string path;
+  std::string mime_type;
+  base::FilePath file;
+
+  bool operator<(const PendingResource& other) const {
+    return path < other.path;
+  }
+};
+
+}  // namespace
+
+struct AppPackage::Entry {
+  uint32 path_offset;
+  uint32 path_length;
+  uint32 mime_type_offset;
+  uint32 mime_type_length;
+  uint32 data_offset;
+  uint32 data_length;
+};
+
+namespace {
+
+// Orders the index entries of |package| against a path, for std::lower_bound.
+class EntryPathLess {
+ public:
+  explicit EntryPathLess(const uint8* package) : package_(package) {}
+
+  template <typename Entry>
+  bool operator()(const Entry& entry, const base::StringPiece& path) const {
+    base::StringPiece entry_path(
+        reinterpret_cast<const char*>(package_ + entry.path_offset),
+        entry.path_length);
+    return entry_path < path;
+  }
+
+ private:
+  const uint8* package_;
+};
+
+}  // namespace
+
+// static
+scoped_refptr<AppPackage> AppPackage::Open(const base::FilePath& path) {
+  scoped_refptr<AppPackage> package(new AppPackage);
+  if (!package->Initialize(path)) {
+    LOG(ERROR) << "Invalid app package " << path.value();
+    return NULL;
+  }
+  return package;
+}
+
+// static
+bool AppPackage::Build(const base::FilePath& source_dir,
+                       const base::FilePath& package_path) {
+  std::vector<PendingResource> resources;
+  file_util::FileEnumerator enumerator(source_dir, true,
+                                       file_util::FileEnumerator::FILES);
+  for (base::FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    base::FilePath relative_path;
+    if (!source_dir.AppendRelativePath(file, &relative_path))
+      continue;
+
+    PendingResource resource;
+#if defined(OS_WIN)
+    resource.path = UTF16ToUTF8(relative_path.value());
+    std::replace(resource.path.begin(), resource.path.end(), '\\', '/');
+#else
+    resource.path = relative_path.value();
+#endif
+    if (!net::GetMimeTypeFromFile(file, &resource.mime_type))
+      resource.mime_type = kDefaultMimeType;
+    resource.file = file;
+    resources.push_back(resource);
+  }
+  std::sort(resources.begin(), resources.end());
+
+  // Lay out the header, the index and the strings, then the data.
+  std::vector<Entry> entries(resources.size());
+  std::string strings;
+  size_t strings_offset =
+      sizeof(PackageHeader) + resources.size() * sizeof(Entry);
+  for (size_t i = 0; i < resources.size(); ++i) {
+    entries[i].path_offset = strings_offset + strings.size();
+    entries[i].path_length = resources[i].path.size();
+    strings.append(resources[i].path);
+    entries[i].mime_type_offset = strings_offset + strings.size();
+    entries[i].mime_type_length = resources[i].mime_type.size();
+    strings.append(resources[i].mime_type);
+  }
+
+  std::string package(AlignUp(strings_offset + strings.size()), '\0');
+  for (size_t i = 0; i < resources.size(); ++i) {
+    std::string data;
+    if (!file_util::ReadFileToString(resources[i].file, &data)) {
+      LOG(ERROR) << "Failed to read " << resources[i].file.value();
+      return false;
+    }
+    package.resize(AlignUp(package.size()), '\0');
+    entries[i].data_offset = package.size();
+    entries[i].data_length = data.size();
+    package.append(data);
+    if (package.size() > kuint32max) {
+      LOG(ERROR) << "The app package is larger than 4GB";
+      return false;
+    }
+  }
+
+  PackageHeader header = {
+    kAppPackageMagic, kAppPackageVersion, resources.size(), 0 };
+  package.replace(0, sizeof(header), reinterpret_cast<const char*>(&header),
+                  sizeof(header));
+  if (!entries.empty()) {
+    package.replace(sizeof(header), entries.size() * sizeof(Entry),
+                    reinterpret_cast<const char*>(&entries[0]),
+                    entries.size() * sizeof(Entry));
+  }
+  package.replace(strings_offset, strings.size(), strings);
+
+  int size = static_cast<int>(package.size());
+  return file_util::WriteFile(package_path, package.data(), size) == size;
+}
+
+bool AppPackage::Find(const base::StringPiece& path,
+                      Resource* resource) const {
+  const Entry* end = entries_ + entry_count_;
+  const Entry* entry =
+      std::lower_bound(entries_, end, path, EntryPathLess(file_.data()));
+  if (entry == end || GetString(entry->path_offset, entry->path_length) != path)
+    return false;
+
+  resource->data = GetString(entry->data_offset, entry->data_length);
+  resource->mime_type =
+      GetString(entry->mime_type_offset, entry->mime_type_length);
+  return true;
+}
+
+AppPackage::AppPackage()
+    : entries_(NULL),
+      entry_count_(0) {
+}
+
+AppPackage::~AppPackage() {
+}
+
+bool AppPackage::Initialize(const base::FilePath& path) {
+  if (!file_.Initialize(path) || file_.length() < sizeof(PackageHeader))
+    return false;
+
+  // The package is little-endian, as are all the platforms Cameo runs on.
+  const PackageHeader* header =
+      reinterpret_cast<const PackageHeader*>(file_.data());
+  if (header->magic != kAppPackageMagic ||
+      header->version != kAppPackageVersion)
+    return false;
+
+  size_t index_size = header->entry_count * sizeof(Entry);
+  if (header->entry_count > file_.length() / sizeof(Entry) ||
+      sizeof(PackageHeader) + index_size > file_.length())
+    return false;
+  entries_ = reinterpret_cast<const Entry*>(file_.data() + sizeof(*header));
+  entry_count_ = header->entry_count;
+
+  // Check every range once here, so that Find() doesn't have to.
+  const uint64 length = file_.length();
+  for (size_t i = 0; i < entry_count_; ++i) {
+    const Entry& entry = entries_[i];
+    if (uint64(entry.path_offset) + entry.path_length > length ||
+        uint64(entry.mime_type_offset) + entry.mime_type_length > length ||
+        uint64(entry.data_offset) + entry.data_length > length)
+      return false;
+    if (i > 0 && !(GetString(entries_[i - 1].path_offset,
+                             entries_[i - 1].path_length) <
+                   GetString(entry.path_offset, entry.path_length)))
+      return false;
+  }
+  return true;
+}
+
+base::StringPiece AppPackage::GetString(uint32 offset, uint32 length) const {
+  return base::StringPiece(
+      reinterpret_cast<const char*>(file_.data() + offset), length);
+}
+
+}  // namespace cameo
@@ -0,0 +1,64 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_COMMON_APP_PACKAGE_H_
+#define CAMEO_SRC_RUNTIME_COMMON_APP_PACKAGE_H_
+
+#include "base/basictypes.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/ref_counted.h"
+#include "base/string_piece.h"
+
+namespace cameo {
+
+// AppPackage is the read-only archive the resources of an app are shipped
+// in. Once the file is mapped, finding a resource is a binary search in the
+// index and its data is served straight from the mapping, without any file
+// system call. The layout, in little-endian, is
+//   header | index entries sorted by path | paths and MIME types | data
+// where every entry holds the offsets and lengths of its path, MIME type and
+// data. The MIME types are worked out when the package is built.
+class AppPackage : public base::RefCountedThreadSafe<AppPackage> {
+ public:
+  struct Resource {
+    base::StringPiece data;
+    base::StringPiece mime_type;
+  };
+
+  // Maps the package at |path|. Returns NULL if it can't be read or is
+  // malformed.
+  static scoped_refptr<AppPackage> Open(const base::FilePath& path);
+
+  // Packs every file under |source_dir| into a new package at
+  // |package_path|.
+  static bool Build(const base::FilePath& source_dir,
+                    const base::FilePath& package_path);
+
+  // Looks up the resource at |path|, relative to the package root and
+  // separated by slashes, e.g. "js/app.js". Can be called on any thread.
+  bool Find(const base::StringPiece& path, Resource* resource) const;
+
+  size_t resource_count() const { return entry_count_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<AppPackage>;
+  struct Entry;
+
+  AppPackage();
+  ~AppPackage();
+
+  bool Initialize(const base::FilePath& path);
+  base::StringPiece GetString(uint32 offset, uint32 length) const;
+
+  base::MemoryMappedFile file_;
+  const Entry* entries_;
+  size_t entry_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(AppPackage);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_COMMON_APP_PACKAGE_H_
@@ -0,0 +1,15 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/common/cameo_constants.h"
+
+namespace cameo {
+
+const char kAppScheme[] = "app";
+const char kAppPackageHost[] = "package";
+
+const base::FilePath::CharType kAppPackageExtension[] =
+    FILE_PATH_LITERAL(".capk");
+
+}  // namespace cameo
@@ -0,0 +1,22 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_COMMON_CAMEO_CONSTANTS_H_
+#define CAMEO_SRC_RUNTIME_COMMON_CAMEO_CONSTANTS_H_
+
+#include "base/files/file_path.h"
+
+namespace cameo {
+
+// The scheme serving the resources of the app package Cameo was started with,
+// e.g. app://package/index.html.
+extern const char kAppScheme[];
+extern const char kAppPackageHost[];
+
+// The extension of app package files, see AppPackage.
+extern const base::FilePath::CharType kAppPackageExtension[];
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_COMMON_CAMEO_CONSTANTS_H_
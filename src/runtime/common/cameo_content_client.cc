@@ -7,6 +7,7 @@
 #include "base/command_line.h"
 #include "base/string_piece.h"
 #include "base/utf_string_conversions.h"
+#include "cameo/src/runtime/common/cameo_constants.h"
 #include "content/public/common/content_switches.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/resource/resource_bundle.h"
@@ -49,4 +50,12 @@ gfx::Image& CameoContentClient::GetNativeImageNamed(int resource_id) const {
   return ResourceBundle::GetSharedInstance().GetNativeImageNamed(resource_id);
 }
 
+void CameoContentClient::AddAdditionalSchemes(
+    std::vector<std::string>* standard_schemes,
+    std::vector<std::string>* savable_schemes) {
+  // app:// URLs have a host, and resolve relative URLs like http:// ones do.
+  standard_schemes->push_back(kAppScheme);
+  savable_schemes->push_back(kAppScheme);
+}
+
 }  // namespace cameo
@@ -26,6 +26,9 @@ class CameoContentClient : public content::ContentClient {
   virtual base::RefCountedStaticMemory* GetDataResourceBytes(
       int resource_id) const OVERRIDE;
   virtual gfx::Image& GetNativeImageNamed(int resource_id) const OVERRIDE;
+  virtual void AddAdditionalSchemes(
+      std::vector<std::string>* standard_schemes,
+      std::vector<std::string>* savable_schemes) OVERRIDE;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(CameoContentClient);
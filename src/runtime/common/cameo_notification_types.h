@@ -21,6 +21,15 @@ enum NotificationType {
   // containing the affected Runtime. No details is provided.
   NOTIFICATION_RUNTIME_CLOSED,
 
+  // Notify that a Runtime instance hibernated, see Runtime::Hibernate(). The
+  // source is a Source<Runtime> containing the affected Runtime. No details is
+  // provided.
+  NOTIFICATION_RUNTIME_HIBERNATED,
+
+  // Notify that a hibernated Runtime instance resumed. The source is a
+  // Source<Runtime> containing the affected Runtime. No details is provided.
+  NOTIFICATION_RUNTIME_RESUMED,
+
   NOTIFICATION_CAMEO_END,
 };
 
@@ -6,8 +6,130 @@
 
 namespace switches {
 
+// Resolves host names with the built-in asynchronous DNS client rather than
+// getaddrinfo() on worker threads. The client caches the answers for as long
+// as their TTL says, instead of a minute for every host.
+const char kAsyncDns[] = "async-dns";
+
+// Maximum number of requests a Runtime in the background has in flight, 0
+// for no limit. See RequestScheduler.
+const char kBackgroundRequestLimit[] = "background-request-limit";
+
 // Specifies the data path directory, which cameo runtime will look for its
 // state, e.g. cache, localStorage etc.
 const char kCameoDataPath[] = "data-path";
 
+// Maximum size of the HTTP disk cache in bytes.
+const char kDiskCacheSize[] = "disk-cache-size";
+
+// Writes the network timings of every Runtime to the given file as JSON on
+// exit, see NetworkTimingRecorder. Given along with kProcessSingleton on Linux
+// to a later launch, it is handed to the running browser process, which dumps
+// its timings right away without opening any Runtime.
+const char kDumpNetworkTimings[] = "dump-network-timings";
+
+// Emulates a slower network, given either as a profile, "2g" or "3g", or as
+// e.g. "latency=100,down=750,up=250,loss=1", with the latency in ms, the
+// bandwidths in kbit/s and the loss in percent of the transactions. See
+// NetworkEmulator.
+const char kEmulateNetwork[] = "emulate-network";
+
+// Copies the frames of the startup Runtime into the frame ring of the given
+// name, see FrameRing. The ring is created beforehand by the consumer.
+const char kFrameCaptureRing[] = "frame-capture-ring";
+
+// Caps the frame rate of kFrameCaptureRing, in frames per second.
+const char kFrameCaptureMaxFps[] = "frame-capture-max-fps";
+
+// Runs every Runtime in a NativeAppWindowHeadless instead of a native
+// window: the window bounds and state are only kept in memory, and the views
+// of the web contents are never attached to a toplevel window. The browser
+// still initializes GTK on Linux, so it needs a display, e.g. Xvfb.
+const char kHeadless[] = "headless";
+
+// Hibernates a Runtime once it has been in the background for the given
+// number of seconds, see Runtime::Hibernate(). It resumes when its window
+// comes back.
+const char kHibernateAfter[] = "hibernate-after";
+
+// Maximum number of host names the host resolver caches, 0 for none.
+const char kHostCacheSize[] = "host-cache-size";
+
+// Maps hosts and ports to others for all the connections, e.g.
+// "MAP *.example.com 127.0.0.1:8080, EXCLUDE www.example.com". Unlike
+// --host-resolver-rules, the port can be mapped too. Only the endpoint the
+// connections go to changes, the URLs and the Host header sent are left
+// alone. See net::HostMappingRules.
+const char kHostRules[] = "host-rules";
+
+// Where the HTTP cache keeps its entries: "disk" (the default), "memory" for
+// nothing to be written to disk, or "hybrid" for a memory tier in front of the
+// disk cache, serving the hot entries.
+const char kHttpCacheMode[] = "http-cache-mode";
+
+// Fills a new, empty HTTP disk cache with the responses of the given snapshot
+// before the first request, so that the first launch of an app doesn't have
+// to download them. Snapshots are built by cameo_cache_snapshot_builder from
+// a session recorded with kRecordNetwork. See HttpCacheSnapshot.
+const char kHttpCacheSnapshot[] = "http-cache-snapshot";
+
+// Gives every site a storage partition of its own, with separate cookies,
+// HTTP cache and DOM storage. The partitions share one network session.
+const char kIsolateSiteStorage[] = "isolate-site-storage";
+
+// Maximum size in bytes of the cache of audio and video, which is kept apart
+// from the HTTP cache. See MediaURLRequestContextGetter.
+const char kMediaCacheSize[] = "media-cache-size";
+
+// Maximum size of the HTTP memory cache in bytes, in the memory and hybrid
+// modes.
+const char kMemoryCacheSize[] = "memory-cache-size";
+
+// Enables the MemoryPressureCoordinator, which hibernates, and under critical
+// pressure closes, background Runtimes when memory runs low. Takes e.g.
+// "moderate=15,critical=5,interval=5", the defaults: the pressure is
+// moderate, or critical, below the given percents of the memory available,
+// sampled every given number of seconds.
+const char kMemoryPressure[] = "memory-pressure";
+
+// Pauses the audio and video elements of a Runtime while it is in the
+// background, and resumes them when it comes back. See BackgroundThrottler.
+const char kPauseBackgroundMedia[] = "pause-background-media";
+
+#if defined(OS_LINUX)
+// Shares one browser process between all launches using the same data path.
+// A later launch hands its command line to the running process and exits.
+const char kProcessSingleton[] = "process-singleton";
+#endif
+
+// Records every response coming from the network, with its headers, body
+// and timing, into the given archive file. See NetworkRecorder.
+const char kRecordNetwork[] = "record-network";
+
+// Serves the HTTP and HTTPS requests from the responses recorded in the given
+// archive file by kRecordNetwork, without any network access. See
+// ReplayProtocolHandler.
+const char kReplayNetwork[] = "replay-network";
+
+// Along with kReplayNetwork, delays the replayed responses as much as they
+// were delayed when recorded.
+const char kReplayNetworkLatency[] = "replay-network-latency";
+
+// Writes the resources every Runtime uses to the given file as JSON, after
+// each sample taken every kResourceMonitorInterval. See
+// RuntimeResourceMonitor.
+const char kResourceMonitorFile[] = "resource-monitor-file";
+
+// Samples the CPU, memory and network use of every Runtime every given number
+// of seconds, 5 by default along with kResourceMonitorFile.
+const char kResourceMonitorInterval[] = "resource-monitor-interval";
+
+// Throttles the Runtimes whose window is shown but not active, like those
+// minimised or hidden. See BackgroundThrottler.
+const char kThrottleInactiveWindows[] = "throttle-inactive-windows";
+
+// Records the startup timeline of the browser process until the first paint
+// of the startup page, and writes it to the given file as Chrome trace JSON.
+const char kTraceStartupTimeline[] = "trace-startup-timeline";
+
 }  // namespace switches
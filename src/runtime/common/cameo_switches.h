@@ -5,10 +5,40 @@
 #ifndef CAMEO_SRC_RUNTIME_COMMON_CAMEO_SWITCHES_H_
 #define CAMEO_SRC_RUNTIME_COMMON_CAMEO_SWITCHES_H_
 
+#include "build/build_config.h"
+
 // Defines all command line switches for Cameo.
 namespace switches {
 
+extern const char kAsyncDns[];
+extern const char kBackgroundRequestLimit[];
 extern const char kCameoDataPath[];
+extern const char kDiskCacheSize[];
+extern const char kDumpNetworkTimings[];
+extern const char kEmulateNetwork[];
+extern const char kFrameCaptureMaxFps[];
+extern const char kFrameCaptureRing[];
+extern const char kHeadless[];
+extern const char kHibernateAfter[];
+extern const char kHostCacheSize[];
+extern const char kHostRules[];
+extern const char kHttpCacheMode[];
+extern const char kHttpCacheSnapshot[];
+extern const char kIsolateSiteStorage[];
+extern const char kMediaCacheSize[];
+extern const char kMemoryCacheSize[];
+extern const char kMemoryPressure[];
+extern const char kPauseBackgroundMedia[];
+#if defined(OS_LINUX)
+extern const char kProcessSingleton[];
+#endif
+extern const char kRecordNetwork[];
+extern const char kReplayNetwork[];
+extern const char kReplayNetworkLatency[];
+extern const char kResourceMonitorFile[];
+extern const char kResourceMonitorInterval[];
+extern const char kThrottleInactiveWindows[];
+extern const char kTraceStartupTimeline[];
 
 }  // namespace switches
 
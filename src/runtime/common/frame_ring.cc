@@ -0,0 +1,260 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cameo/src/runtime/common/frame_ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+
+#if defined(OS_POSIX)
+#include <sys/stat.h>
+#endif
+
+using base::subtle::Atomic32;
+
+namespace cameo {
+
+namespace {
+
+const uint32 kFrameRingMagic = 0x43414d46;  // "CAMF"
+const uint32 kFrameRingVersion = 1;
+
+// Both headers are padded to a cache line, so that the pixels of every slot
+// start 64-byte aligned.
+const size_t kHeaderSize = 64;
+
+// The first bytes of the shared memory.
+struct RingHeader {
+  uint32 magic;
+  uint32 version;
+  uint32 slot_count;
+  // Size of a slot including its SlotHeader.
+  uint32 slot_size;
+  volatile Atomic32 latest_sequence;
+  volatile Atomic32 dropped_frames;
+};
+
+// The first bytes of every slot, followed by the pixels.
+struct SlotHeader {
+  // 0 while the slot is being written.
+  volatile Atomic32 sequence;
+  uint32 format;
+  int32 width;
+  int32 height;
+  int32 stride;
+  uint32 size;
+  int64 timestamp;
+};
+
+COMPILE_ASSERT(sizeof(RingHeader) <= kHeaderSize, ring_header_too_big);
+COMPILE_ASSERT(sizeof(SlotHeader) <= kHeaderSize, slot_header_too_big);
+
+RingHeader* GetHeader(base::SharedMemory* memory) {
+  return static_cast<RingHeader*>(memory->memory());
+}
+
+// Sets |total_size| to the size of a ring of |slot_count| slots of
+// |slot_size| bytes. Returns false if the layout is invalid or its size
+// overflows.
+bool GetTotalSize(size_t slot_count, size_t slot_size, size_t* total_size) {
+  if (slot_count == 0 || slot_size < kHeaderSize ||
+      slot_size > std::numeric_limits<uint32>::max() ||
+      slot_count > std::numeric_limits<uint32>::max())
+    return false;
+  size_t max_size = std::numeric_limits<size_t>::max();
+  if (slot_count > (max_size - kHeaderSize) / slot_size)
+    return false;
+  *total_size = kHeaderSize + slot_count * slot_size;
+  return true;
+}
+
+}  // namespace
+
+FrameRing::FrameInfo::FrameInfo()
+    : sequence(0),
+      width(0),
+      height(0),
+      stride(0),
+      format(PIXEL_FORMAT_BGRA) {
+}
+
+// static
+scoped_ptr<FrameRing> FrameRing::Create(const std::string& name,
+                                        size_t slot_count,
+                                        size_t max_frame_bytes) {
+  size_t slot_size = kHeaderSize + max_frame_bytes;
+  size_t total_size = 0;
+  if (slot_size < max_frame_bytes ||
+      !GetTotalSize(slot_count, slot_size, &total_size)) {
+    LOG(ERROR) << "Invalid frame ring size for " << name;
+    return scoped_ptr<FrameRing>();
+  }
+
+  scoped_ptr<base::SharedMemory> memory(new base::SharedMemory);
+  // Remove a ring left behind by a consumer which crashed.
+  memory->Delete(name);
+  if (!memory->CreateNamed(name, false, total_size) ||
+      !memory->Map(total_size)) {
+    LOG(ERROR) << "Failed to create the frame ring " << name;
+    return scoped_ptr<FrameRing>();
+  }
+
+  memset(memory->memory(), 0, total_size);
+  RingHeader* header = GetHeader(memory.get());
+  header->magic = kFrameRingMagic;
+  header->version = kFrameRingVersion;
+  header->slot_count = slot_count;
+  header->slot_size = slot_size;
+  return scoped_ptr<FrameRing>(
+      new FrameRing(name, memory.Pass(), true, slot_count, slot_size));
+}
+
+// static
+scoped_ptr<FrameRing> FrameRing::Open(const std::string& name) {
+  scoped_ptr<base::SharedMemory> memory(new base::SharedMemory);
+  if (!memory->Open(name, false) || !memory->Map(kHeaderSize)) {
+    LOG(ERROR) << "Failed to open the frame ring " << name;
+    return scoped_ptr<FrameRing>();
+  }
+
+  const RingHeader* header = GetHeader(memory.get());
+  if (header->magic != kFrameRingMagic ||
+      header->version != kFrameRingVersion) {
+    LOG(ERROR) << name << " isn't a frame ring";
+    return scoped_ptr<FrameRing>();
+  }
+
+  // The header comes from another process, its layout is checked, and read
+  // once so that later changes to it can't make the slots go out of bounds.
+  size_t slot_count = header->slot_count;
+  size_t slot_size = header->slot_size;
+  size_t total_size = 0;
+  if (!GetTotalSize(slot_count, slot_size, &total_size)) {
+    LOG(ERROR) << name << " has an invalid layout";
+    return scoped_ptr<FrameRing>();
+  }
+#if defined(OS_POSIX)
+  // Touching the pages past the end of the shared memory would fault.
+  struct stat st;
+  if (fstat(memory->handle().fd, &st) < 0 ||
+      static_cast<uint64>(st.st_size) < total_size) {
+    LOG(ERROR) << name << " is smaller than its layout";
+    return scoped_ptr<FrameRing>();
+  }
+#endif
+  memory->Unmap();
+  if (!memory->Map(total_size)) {
+    LOG(ERROR) << "Failed to map the frame ring " << name;
+    return scoped_ptr<FrameRing>();
+  }
+  return scoped_ptr<FrameRing>(
+      new FrameRing(name, memory.Pass(), false, slot_count, slot_size));
+}
+
+FrameRing::FrameRing(const std::string& name,
+                     scoped_ptr<base::SharedMemory> memory,
+                     bool owns_memory,
+                     size_t slot_count,
+                     size_t slot_size)
+    : name_(name),
+      memory_(memory.Pass()),
+      owns_memory_(owns_memory),
+      slot_count_(slot_count),
+      slot_size_(slot_size) {
+}
+
+FrameRing::~FrameRing() {
+  if (owns_memory_)
+    memory_->Delete(name_);
+}
+
+size_t FrameRing::max_frame_bytes() const {
+  return slot_size_ - kHeaderSize;
+}
+
+bool FrameRing::WriteFrame(const void* pixels, int width, int height,
+                           int stride, PixelFormat format,
+                           base::TimeTicks timestamp) {
+  RingHeader* header = GetHeader(memory_.get());
+  size_t size = static_cast<size_t>(stride) * height;
+  if (size > max_frame_bytes()) {
+    base::subtle::NoBarrier_AtomicIncrement(&header->dropped_frames, 1);
+    return false;
+  }
+
+  uint32 sequence = GetLatestSequence() + 1;
+  if (sequence == 0)
+    sequence = 1;
+  uint8* slot = GetSlot(sequence);
+  SlotHeader* slot_header = reinterpret_cast<SlotHeader*>(slot);
+
+  // Invalidate the slot before touching its content, a reader which copied
+  // part of the old frame will see the sequence change.
+  base::subtle::NoBarrier_Store(&slot_header->sequence, 0);
+  base::subtle::MemoryBarrier();
+
+  memcpy(slot + kHeaderSize, pixels, size);
+  slot_header->format = format;
+  slot_header->width = width;
+  slot_header->height = height;
+  slot_header->stride = stride;
+  slot_header->size = size;
+  slot_header->timestamp = timestamp.ToInternalValue();
+
+  base::subtle::Release_Store(&slot_header->sequence, sequence);
+  base::subtle::Release_Store(&header->latest_sequence, sequence);
+  return true;
+}
+
+uint32 FrameRing::GetLatestSequence() const {
+  return base::subtle::Acquire_Load(
+      &GetHeader(memory_.get())->latest_sequence);
+}
+
+uint32 FrameRing::GetDroppedFrameCount() const {
+  return base::subtle::NoBarrier_Load(
+      &GetHeader(memory_.get())->dropped_frames);
+}
+
+bool FrameRing::ReadFrame(uint32 sequence, FrameInfo* info,
+                          std::vector<uint8>* pixels) const {
+  if (sequence == 0)
+    return false;
+
+  const uint8* slot = GetSlot(sequence);
+  const SlotHeader* slot_header = reinterpret_cast<const SlotHeader*>(slot);
+  if (static_cast<uint32>(base::subtle::Acquire_Load(
+          &slot_header->sequence)) != sequence)
+    return false;
+
+  info->sequence = sequence;
+  info->format = static_cast<PixelFormat>(slot_header->format);
+  info->width = slot_header->width;
+  info->height = slot_header->height;
+  info->stride = slot_header->stride;
+  info->timestamp =
+      base::TimeTicks::FromInternalValue(slot_header->timestamp);
+  size_t size = std::min(static_cast<size_t>(slot_header->size),
+                         max_frame_bytes());
+  pixels->resize(size);
+  if (size)
+    memcpy(&(*pixels)[0], slot + kHeaderSize, size);
+
+  // The writer may have started on this slot while we were copying it.
+  base::subtle::MemoryBarrier();
+  return static_cast<uint32>(base::subtle::NoBarrier_Load(
+      &slot_header->sequence)) == sequence;
+}
+
+uint8* FrameRing::GetSlot(uint32 sequence) const {
+  uint8* slots = static_cast<uint8*>(memory_->memory()) + kHeaderSize;
+  return slots + (sequence % slot_count_) * slot_size_;
+}
+
+}  // namespace cameo
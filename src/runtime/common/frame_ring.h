@@ -0,0 +1,98 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_RUNTIME_COMMON_FRAME_RING_H_
+#define CAMEO_SRC_RUNTIME_COMMON_FRAME_RING_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/shared_memory.h"
+#include "base/time.h"
+
+namespace cameo {
+
+// FrameRing is a ring of fixed-size frame slots in named shared memory. The
+// consumer, e.g. a video encoder, creates it and hands its name to Cameo,
+// which opens it and writes the rendered frames of a Runtime into it. Frames
+// are numbered from 1. A slot being overwritten is never returned to the
+// reader, and a reader that falls more than one ring behind simply misses
+// the frames in between.
+class FrameRing {
+ public:
+  enum PixelFormat {
+    // 32 bits per pixel, B, G, R, A in memory order, as Skia lays them out on
+    // little-endian Linux and Windows.
+    PIXEL_FORMAT_BGRA = 1,
+  };
+
+  struct FrameInfo {
+    FrameInfo();
+
+    uint32 sequence;
+    base::TimeTicks timestamp;
+    int width;
+    int height;
+    int stride;
+    PixelFormat format;
+  };
+
+  // Creates a new ring called |name| with |slot_count| slots able to hold
+  // frames of up to |max_frame_bytes| bytes. Returns NULL on failure.
+  static scoped_ptr<FrameRing> Create(const std::string& name,
+                                      size_t slot_count,
+                                      size_t max_frame_bytes);
+
+  // Opens the existing ring called |name| for writing. Returns NULL if it
+  // doesn't exist, isn't a frame ring or its header is invalid.
+  static scoped_ptr<FrameRing> Open(const std::string& name);
+
+  ~FrameRing();
+
+  const std::string& name() const { return name_; }
+  size_t slot_count() const { return slot_count_; }
+  size_t max_frame_bytes() const;
+
+  // Writer side. Copies a frame of |height| rows of |stride| bytes into the
+  // next slot and publishes it. Returns false, and counts the frame as
+  // dropped, if it doesn't fit in a slot.
+  bool WriteFrame(const void* pixels, int width, int height, int stride,
+                  PixelFormat format, base::TimeTicks timestamp);
+
+  // Reader side. The sequence number of the newest frame, 0 if none.
+  uint32 GetLatestSequence() const;
+  // Frames the writer had to drop because they were larger than a slot.
+  uint32 GetDroppedFrameCount() const;
+
+  // Copies frame |sequence| into |pixels|. Returns false if it has already
+  // been overwritten or is being overwritten.
+  bool ReadFrame(uint32 sequence, FrameInfo* info,
+                 std::vector<uint8>* pixels) const;
+
+ private:
+  FrameRing(const std::string& name,
+            scoped_ptr<base::SharedMemory> memory,
+            bool owns_memory,
+            size_t slot_count,
+            size_t slot_size);
+
+  uint8* GetSlot(uint32 sequence) const;
+
+  std::string name_;
+  scoped_ptr<base::SharedMemory> memory_;
+  // The creator of the ring removes its name once done with it.
+  bool owns_memory_;
+  // The layout of the ring, kept out of the shared memory.
+  size_t slot_count_;
+  // Size of a slot including its header.
+  size_t slot_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameRing);
+};
+
+}  // namespace cameo
+
+#endif  // CAMEO_SRC_RUNTIME_COMMON_FRAME_RING_H_
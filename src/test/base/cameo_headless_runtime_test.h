@@ -0,0 +1,23 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAMEO_SRC_TEST_BASE_CAMEO_HEADLESS_RUNTIME_TEST_H_
+#define CAMEO_SRC_TEST_BASE_CAMEO_HEADLESS_RUNTIME_TEST_H_
+
+#include "base/command_line.h"
+#include "base/compiler_specific.h"
+#include "cameo/src/runtime/common/cameo_switches.h"
+#include "cameo/src/test/base/in_process_browser_test.h"
+
+// Base class for tests whose Runtimes have headless windows, see
+// NativeAppWindowHeadless, e.g. so that they can be minimised without a
+// window manager.
+class CameoHeadlessRuntimeTest : public InProcessBrowserTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    command_line->AppendSwitch(switches::kHeadless);
+  }
+};
+
+#endif  // CAMEO_SRC_TEST_BASE_CAMEO_HEADLESS_RUNTIME_TEST_H_
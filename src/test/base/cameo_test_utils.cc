@@ -4,16 +4,21 @@
 
 #include "cameo/src/test/base/cameo_test_utils.h"
 
+#include <stdio.h>
+
 #include "base/command_line.h"
 #include "base/environment.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
 #include "base/path_service.h"
 #include "base/run_loop.h"
+#include "base/stringprintf.h"
 #include "base/strings/string_number_conversions.h"
 #include "cameo/src/runtime/browser/runtime.h"
 #include "cameo/src/runtime/common/cameo_paths.h"
 #include "cameo/src/runtime/common/cameo_switches.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/navigation_controller.h"
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/notification_source.h"
@@ -23,14 +28,43 @@
 #include "content/public/test/test_navigation_observer.h"
 #include "content/public/test/test_utils.h"
 #include "net/base/net_util.h"
+#include "net/url_request/url_fetcher.h"
+#include "net/url_request/url_fetcher_delegate.h"
+#include "net/url_request/url_request_context_getter.h"
+#include "testing/gtest/include/gtest/gtest.h"
 #include "ui/gl/gl_switches.h"
 
+using content::BrowserThread;
 using content::NavigationController;
 using content::TestNavigationObserver;
 using content::WebContents;
 
 namespace cameo_test_utils {
 
+namespace {
+
+void PostQuitToUIThread(const base::Closure& quit) {
+  BrowserThread::PostTask(BrowserThread::UI, FROM_HERE, quit);
+}
+
+// Quits a run loop once a fetch completes.
+class FetchWaiter : public net::URLFetcherDelegate {
+ public:
+  explicit FetchWaiter(const base::Closure& quit) : quit_(quit) {}
+
+  // net::URLFetcherDelegate implementation.
+  virtual void OnURLFetchComplete(const net::URLFetcher* source) OVERRIDE {
+    quit_.Run();
+  }
+
+ private:
+  base::Closure quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(FetchWaiter);
+};
+
+}  // namespace
+
 void PrepareBrowserCommandLineForTests(CommandLine* command_line) {
   // Enable info level logging by default so that we can see when bad
   // stuff happens, but honor the flags specified from the command line.
@@ -78,4 +112,55 @@ void NavigateToURL(cameo::Runtime* runtime, const GURL& url) {
       content::GetQuitTaskForRunLoop(&run_loop));
 }
 
+void RunMessageLoopFor(base::TimeDelta duration) {
+  base::RunLoop run_loop;
+  MessageLoop::current()->PostDelayedTask(FROM_HERE, run_loop.QuitClosure(),
+                                          duration);
+  run_loop.Run();
+}
+
+void RunOnIOThreadAndWait(
+    const base::Callback<void(const base::Closure&)>& task) {
+  base::RunLoop run_loop;
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(task, base::Bind(&PostQuitToUIThread,
+                                  run_loop.QuitClosure())));
+  run_loop.Run();
+}
+
+std::string FetchURL(net::URLRequestContextGetter* getter, const GURL& url) {
+  std::string body;
+  EXPECT_EQ(200, FetchURLWithHeaders(getter, url, std::string(), &body))
+      << url.spec();
+  return body;
+}
+
+int FetchURLWithHeaders(net::URLRequestContextGetter* getter,
+                        const GURL& url,
+                        const std::string& extra_headers,
+                        std::string* body) {
+  base::RunLoop run_loop;
+  FetchWaiter waiter(run_loop.QuitClosure());
+  scoped_ptr<net::URLFetcher> fetcher(
+      net::URLFetcher::Create(url, net::URLFetcher::GET, &waiter));
+  fetcher->SetRequestContext(getter);
+  if (!extra_headers.empty())
+    fetcher->SetExtraRequestHeaders(extra_headers);
+  fetcher->Start();
+  run_loop.Run();
+  fetcher->GetResponseAsString(body);
+  return fetcher->GetResponseCode();
+}
+
+void PrintPerfResult(const std::string& measurement,
+                     const std::string& trace,
+                     double value,
+                     const std::string& units) {
+  printf("%s", base::StringPrintf("*RESULT %s: %s= %f %s\n",
+                                  measurement.c_str(), trace.c_str(),
+                                  value, units.c_str()).c_str());
+  fflush(stdout);
+}
+
 }  // namespace cameo_test_utils
@@ -7,8 +7,10 @@
 
 #include <string>
 
+#include "base/callback_forward.h"
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
+#include "base/time.h"
 #include "googleurl/src/gurl.h"
 
 namespace cameo {
@@ -17,6 +19,10 @@ class Runtime;
 
 class CommandLine;
 
+namespace net {
+class URLRequestContextGetter;
+}
+
 // A set of utilities for test code that launches separate processes.
 namespace cameo_test_utils {
 
@@ -36,6 +42,34 @@ GURL GetTestURL(const base::FilePath& dir, const base::FilePath& file);
 // navigation completes.
 void NavigateToURL(cameo::Runtime* runtime, const GURL& url);
 
+// Runs the message loop of the current thread for |duration|, e.g. to let a
+// page animate while a benchmark samples it.
+void RunMessageLoopFor(base::TimeDelta duration);
+
+// Runs |task| on the IO thread and blocks the UI thread until |task| runs
+// the closure it is given, from any thread.
+void RunOnIOThreadAndWait(
+    const base::Callback<void(const base::Closure&)>& task);
+
+// Fetches |url| with a GET through |getter|, blocking the UI thread until it
+// completes. Expects a 200 response, and returns its body.
+std::string FetchURL(net::URLRequestContextGetter* getter, const GURL& url);
+
+// Like FetchURL(), with |extra_headers| added to the request, e.g.
+// "Range: bytes=0-99". Returns the response code, and sets |body| to the
+// response body.
+int FetchURLWithHeaders(net::URLRequestContextGetter* getter,
+                        const GURL& url,
+                        const std::string& extra_headers,
+                        std::string* body);
+
+// Prints a benchmark result in the format understood by the Chromium perf
+// dashboard, e.g. "*RESULT launch_time: cold= 1234.5 ms".
+void PrintPerfResult(const std::string& measurement,
+                     const std::string& trace,
+                     double value,
+                     const std::string& units);
+
 }  // namespace cameo_test_utils
 
 #endif  // CAMEO_SRC_TEST_BASE_CAMEO_TEST_UTILS_H_
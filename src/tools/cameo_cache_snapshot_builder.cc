@@ -0,0 +1,48 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Builds the HTTP cache snapshot of a session recorded with
+//   cameo --record-network=<archive> <app>
+// which the first launch of the app then starts from with
+//   cameo --http-cache-snapshot=<snapshot> <app>
+// Only the last cacheable response to every GET is kept.
+
+#include <stdio.h>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "cameo/src/runtime/browser/http_cache_snapshot.h"
+
+namespace {
+
+void PrintUsage() {
+  fprintf(stderr,
+          "Usage: cameo_cache_snapshot_builder NETWORK_ARCHIVE SNAPSHOT\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  CommandLine::Init(argc, argv);
+  const CommandLine::StringVector& args =
+      CommandLine::ForCurrentProcess()->GetArgs();
+  if (args.size() != 2) {
+    PrintUsage();
+    return 1;
+  }
+
+  base::FilePath archive_path(args[0]);
+  base::FilePath snapshot_path(args[1]);
+  int count = cameo::HttpCacheSnapshot::Build(archive_path, snapshot_path);
+  if (count < 0) {
+    fprintf(stderr, "Failed to build %s\n",
+            snapshot_path.AsUTF8Unsafe().c_str());
+    return 1;
+  }
+  printf("Kept %d responses in %s\n", count,
+         snapshot_path.AsUTF8Unsafe().c_str());
+  return 0;
+}
@@ -0,0 +1,166 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A reference consumer of the frames Cameo streams with --frame-capture-ring.
+// It creates the ring, waits for Cameo to be started with
+//   cameo --frame-capture-ring=<ring> [--frame-capture-max-fps=<fps>] <url>
+// and writes every frame it gets as a PNG or raw BGRA file, along with an
+// index of sequence numbers, timestamps and sizes in frames.txt.
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/file_util.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/string_number_conversions.h"
+#include "base/stringprintf.h"
+#include "base/threading/platform_thread.h"
+#include "base/time.h"
+#include "cameo/src/runtime/common/frame_ring.h"
+#include "ui/gfx/codec/png_codec.h"
+#include "ui/gfx/size.h"
+
+namespace {
+
+const char kRing[] = "ring";
+const char kSlots[] = "slots";
+const char kMaxFrameBytes[] = "max-frame-bytes";
+const char kOutputDir[] = "output-dir";
+const char kFormat[] = "format";
+const char kFrames[] = "frames";
+
+const char kDefaultRing[] = "cameo-frames";
+const int kDefaultSlots = 4;
+// A 1920x1080 BGRA frame.
+const int kDefaultMaxFrameBytes = 1920 * 1080 * 4;
+const int kPollIntervalInMilliseconds = 2;
+
+void PrintUsage() {
+  fprintf(stderr,
+          "Usage: cameo_frame_consumer [--ring=NAME] [--slots=N]\n"
+          "           [--max-frame-bytes=N] [--output-dir=DIR]\n"
+          "           [--format=png|raw] [--frames=N]\n");
+}
+
+int GetIntSwitch(const CommandLine& command_line, const char* name,
+                 int default_value) {
+  int value = default_value;
+  if (command_line.HasSwitch(name))
+    base::StringToInt(command_line.GetSwitchValueASCII(name), &value);
+  return value;
+}
+
+bool WriteFrame(const base::FilePath& output_dir, bool png,
+                const cameo::FrameRing::FrameInfo& info,
+                const std::vector<uint8>& pixels) {
+  std::string name = base::StringPrintf("frame_%08u", info.sequence);
+  std::vector<unsigned char> data;
+  if (png) {
+    if (!gfx::PNGCodec::Encode(&pixels[0], gfx::PNGCodec::FORMAT_BGRA,
+                               gfx::Size(info.width, info.height),
+                               info.stride, false,
+                               std::vector<gfx::PNGCodec::Comment>(),
+                               &data))
+      return false;
+    name += ".png";
+  } else {
+    data.assign(pixels.begin(), pixels.end());
+    name += ".bgra";
+  }
+
+  int size = static_cast<int>(data.size());
+  return file_util::WriteFile(output_dir.AppendASCII(name),
+                              reinterpret_cast<const char*>(&data[0]),
+                              size) == size;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+
+  std::string format = command_line.HasSwitch(kFormat) ?
+      command_line.GetSwitchValueASCII(kFormat) : "png";
+  if (format != "png" && format != "raw") {
+    PrintUsage();
+    return 1;
+  }
+  bool png = format == "png";
+
+  std::string ring_name = command_line.HasSwitch(kRing) ?
+      command_line.GetSwitchValueASCII(kRing) : kDefaultRing;
+  base::FilePath output_dir = command_line.HasSwitch(kOutputDir) ?
+      command_line.GetSwitchValuePath(kOutputDir) :
+      base::FilePath(FILE_PATH_LITERAL("."));
+  int max_frames = GetIntSwitch(command_line, kFrames, 0);
+  int slots = GetIntSwitch(command_line, kSlots, kDefaultSlots);
+  int max_frame_bytes =
+      GetIntSwitch(command_line, kMaxFrameBytes, kDefaultMaxFrameBytes);
+  if (slots <= 0 || max_frame_bytes <= 0) {
+    PrintUsage();
+    return 1;
+  }
+
+  if (!file_util::CreateDirectory(output_dir)) {
+    fprintf(stderr, "Failed to create %s\n", output_dir.value().c_str());
+    return 1;
+  }
+  FILE* index = file_util::OpenFile(output_dir.AppendASCII("frames.txt"), "w");
+  if (!index)
+    return 1;
+
+  scoped_ptr<cameo::FrameRing> ring =
+      cameo::FrameRing::Create(ring_name, slots, max_frame_bytes);
+  if (!ring)
+    return 1;
+  printf("Waiting for frames on ring %s\n", ring_name.c_str());
+  fflush(stdout);
+
+  uint32 last_sequence = 0;
+  int written = 0;
+  int missed = 0;
+  cameo::FrameRing::FrameInfo info;
+  std::vector<uint8> pixels;
+  while (max_frames == 0 || written < max_frames) {
+    uint32 sequence = ring->GetLatestSequence();
+    if (sequence == last_sequence) {
+      base::PlatformThread::Sleep(
+          base::TimeDelta::FromMilliseconds(kPollIntervalInMilliseconds));
+      continue;
+    }
+
+    // Read the frames in order. The ones older than the ring size have
+    // already been overwritten.
+    uint32 next = last_sequence + 1;
+    if (sequence - last_sequence > static_cast<uint32>(slots)) {
+      missed += sequence - last_sequence - slots;
+      next = sequence - slots + 1;
+    }
+    for (; next != sequence + 1; ++next) {
+      if (!ring->ReadFrame(next, &info, &pixels) ||
+          !WriteFrame(output_dir, png, info, pixels)) {
+        ++missed;
+        continue;
+      }
+      fprintf(index, "%u %lld %d %d %d\n", info.sequence,
+              static_cast<long long>(info.timestamp.ToInternalValue()),
+              info.width, info.height, info.stride);
+      if (++written == max_frames)
+        break;
+    }
+    last_sequence = sequence;
+  }
+
+  file_util::CloseFile(index);
+  printf("Wrote %d frames, missed %d, %u too big for the ring\n",
+         written, missed, ring->GetDroppedFrameCount());
+  return 0;
+}
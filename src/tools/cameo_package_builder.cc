@@ -0,0 +1,60 @@
+// Copyright (c) 2013 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Packs the resources of an app into an app package, which Cameo serves
+// under app://package/ when started with
+//   cameo <package>.capk
+// The MIME type of every resource is worked out here, once, rather than by
+// Cameo on every request.
+
+#include <stdio.h>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "cameo/src/runtime/common/app_package.h"
+#include "cameo/src/runtime/common/cameo_constants.h"
+
+namespace {
+
+void PrintUsage() {
+  fprintf(stderr, "Usage: cameo_package_builder SOURCE_DIR PACKAGE.capk\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  CommandLine::Init(argc, argv);
+  const CommandLine::StringVector& args =
+      CommandLine::ForCurrentProcess()->GetArgs();
+  if (args.size() != 2) {
+    PrintUsage();
+    return 1;
+  }
+
+  base::FilePath source_dir(args[0]);
+  base::FilePath package_path(args[1]);
+  if (!package_path.MatchesExtension(cameo::kAppPackageExtension)) {
+    PrintUsage();
+    return 1;
+  }
+
+  if (!cameo::AppPackage::Build(source_dir, package_path)) {
+    fprintf(stderr, "Failed to build %s\n",
+            package_path.AsUTF8Unsafe().c_str());
+    return 1;
+  }
+
+  // Check the package the way Cameo will read it.
+  scoped_refptr<cameo::AppPackage> package =
+      cameo::AppPackage::Open(package_path);
+  if (!package)
+    return 1;
+  printf("Packed %d resources into %s\n",
+         static_cast<int>(package->resource_count()),
+         package_path.AsUTF8Unsafe().c_str());
+  return 0;
+}